@@ -4,28 +4,44 @@
 
 src\ASF\sam0\drivers\sercom\sercom.c
 
+src\Benchmark\kBench.c
+
+src\Benchmark\kLatency.c
+
+src\Benchmark\kLine.c
+
+src\Benchmark\kTop.c
+
+src\Benchmark\kTrace.c
+
 src\SerialConsole\circular_buffer.c
 
 src\SerialConsole\CLI.c
 
+src\SerialConsole\dLog.c
+
 src\ASF\sam0\drivers\sercom\usart\usart.c
 
 src\ASF\sam0\drivers\sercom\usart\usart_interrupt.c
 
 src\ASF\sam0\drivers\sercom\sercom_interrupt.c
 
+src\ASF\thirdparty\freertos\freertos-10.0.0\Source\channel.c
+
 src\ASF\thirdparty\freertos\freertos-10.0.0\Source\croutine.c
 
 src\ASF\thirdparty\freertos\freertos-10.0.0\Source\event_groups.c
 
 src\ASF\thirdparty\freertos\freertos-10.0.0\Source\portable\GCC\ARM_CM0\port.c
 
-src\ASF\thirdparty\freertos\freertos-10.0.0\Source\portable\MemMang\heap_1.c
+src\ASF\thirdparty\freertos\freertos-10.0.0\Source\portable\MemMang\heap_tlsf.c
 
 src\SerialConsole\dUART.c
 
 src\ASF\thirdparty\freertos\freertos-10.0.0\Source\list.c
 
+src\ASF\thirdparty\freertos\freertos-10.0.0\Source\mempool.c
+
 src\ASF\thirdparty\freertos\freertos-10.0.0\Source\queue.c
 
 src\ASF\thirdparty\freertos\freertos-10.0.0\Source\stream_buffer.c
@@ -0,0 +1,116 @@
+/**************************************************************************//**
+* @file      FreeRTOSConfig.h
+* @brief     FreeRTOS configuration of the host simulator build
+* @author    Adi
+* @date      2024-1-7
+
+******************************************************************************/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* For documentation for all the configuration symbols, go to:
+ * http://www.freertos.org/a00110.html.
+ */
+
+/* Host (Linux) simulator build, see sim/Makefile. Mirrors
+ * src/config/FreeRTOSConfig.h so the firmware behaves the same, apart from
+ * what the POSIX port needs: a larger heap, as stack words and pointers
+ * are 64-bit, and an assert that stops the simulation with a message.
+ */
+
+#include <stdint.h>
+void assert_triggered(const char *file, uint32_t line);
+void kLatency_Record(const void *caller, uint32_t duration);
+void kTop_ConfigureTimer(void);
+uint32_t kTop_GetCounter(void);
+
+#define configUSE_PREEMPTION 1
+#define configUSE_IDLE_HOOK 1
+#define configUSE_TICK_HOOK 0
+#define configUSE_TICKLESS_IDLE 1  // Sleep through idle periods, see vPortSuppressTicksAndSleep
+#ifndef configUSE_DELAYED_TASK_WHEEL
+#define configUSE_DELAYED_TASK_WHEEL 0  // Delayed tasks hashed on their wake time, see tasks.c
+#endif
+#define configPRIO_BITS 2
+#define configCPU_CLOCK_HZ (48000000UL)
+#define configTICK_RATE_HZ ((portTickType)1000)
+#define configMAX_PRIORITIES (5)
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1  // Ready priorities kept in a bit map, see portmacro.h
+#endif
+#define configMINIMAL_STACK_SIZE ((unsigned short)100)
+/* configTOTAL_HEAP_SIZE is not used when heap_3.c is used. */
+#ifndef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE ((size_t)(512 * 1024))  // Room for the sleepers of the timeout benchmark
+#endif
+#define configMAX_TASK_NAME_LEN (8)
+#define configUSE_TRACE_FACILITY 1
+#define configUSE_16_BIT_TICKS 0
+#define configIDLE_SHOULD_YIELD 1
+#define configUSE_MUTEXES 1
+#define configQUEUE_REGISTRY_SIZE 0
+#define configCHECK_FOR_STACK_OVERFLOW 1
+#define configUSE_RECURSIVE_MUTEXES 1
+#define configUSE_MALLOC_FAILED_HOOK 1
+#define configUSE_COUNTING_SEMAPHORES 1
+#define configUSE_QUEUE_SETS 1
+#ifndef configUSE_QUEUE_LOANS
+#define configUSE_QUEUE_LOANS 0  // Zero-copy send and receive of large queue items, see queue.h
+#endif
+#define configUSE_CONCURRENT_STREAM_BUFFERS 1  // Stream and message buffers with several writers and readers, see stream_buffer.h
+#define configGENERATE_RUN_TIME_STATS 1  // Per task CPU time for the top command, see kTop.c
+#ifndef configUSE_CRITICAL_SECTION_STATS
+#define configUSE_CRITICAL_SECTION_STATS 0  // Time every critical section per call site, see kLatency.c
+#endif
+#ifndef configUSE_TRACE_RECORDER
+#define configUSE_TRACE_RECORDER 0  // Stream kernel events to the PC, see kTrace.c
+#endif
+#define configENABLE_BACKWARD_COMPATIBILITY 1
+#define configUSE_DAEMON_TASK_STARTUP_HOOK 1  // Ported from FreeRToS 9.0.0
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES 0
+#define configMAX_CO_ROUTINE_PRIORITIES (2)
+
+/* Software timer definitions. */
+#define configUSE_TIMERS 1
+#define configTIMER_TASK_PRIORITY (2)
+#define configTIMER_QUEUE_LENGTH 5
+#define configTIMER_TASK_STACK_DEPTH (128)
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet 1
+#define INCLUDE_uxTaskPriorityGet 1
+#define INCLUDE_vTaskDelete 1
+#define INCLUDE_vTaskSuspend 1
+#define INCLUDE_xResumeFromISR 1
+#define INCLUDE_vTaskDelayUntil 1
+#define INCLUDE_vTaskDelay 1
+#define INCLUDE_xTaskGetSchedulerState 1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_xTaskGetIdleTaskHandle 0
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle 0
+#define INCLUDE_pcTaskGetTaskName 0
+#define INCLUDE_eTaskGetState 0
+
+/* Report the failed assertion and abort, so a debugger or a CI run stops
+right there instead of spinning. */
+#define configASSERT(x)                          \
+    if ((x) == 0) {                              \
+        assert_triggered(__FILE__, __LINE__);    \
+    }
+
+#define configRECORD_CRITICAL_SECTION(caller, duration) kLatency_Record(caller, duration)
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() kTop_ConfigureTimer()
+#define portGET_RUN_TIME_COUNTER_VALUE() kTop_GetCounter()
+
+#define configCOMMAND_INT_MAX_OUTPUT_SIZE 32
+
+/* Trace hook macros of the recorder, they need the definitions above. */
+#if (configUSE_TRACE_RECORDER == 1)
+#include "Benchmark/kTrace.h"
+#endif
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,135 @@
+/**************************************************************************//**
+* @file      asf.h
+* @brief     Host stand-in for the ASF API header
+* @details   Declares the subset of the Atmel Software Framework used by
+*            src/, implemented by sim/asf_sim.c on top of the POSIX port.
+*            EDBG_CDC_MODULE is the process' stdin/stdout, the USART
+*            interrupt is a simulated interrupt (SIGIO), LED pins only
+*            keep their level.
+* @author    Adi
+* @date      2024-1-7
+
+******************************************************************************/
+#ifndef ASF_H_
+#define ASF_H_
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <event_groups.h>
+#include <message_buffer.h>
+#include <queue.h>
+#include <semphr.h>
+#include <stream_buffer.h>
+#include <task.h>
+#include <timers.h>
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+/* status_codes.h */
+enum status_code {
+	STATUS_OK               = 0x00,
+	STATUS_BUSY             = 0x05,
+	STATUS_ERR_INVALID_ARG  = 0x17,
+	STATUS_ERR_DENIED       = 0x1C,
+};
+
+/* interrupt.h */
+typedef UBaseType_t irqflags_t;
+
+/* board.h, only the pins and SERCOM used by src/ */
+typedef struct sim_sercom Sercom;
+#define LED_0_PIN						0
+#define EDBG_CDC_MODULE					((Sercom *)NULL)
+#define EDBG_CDC_SERCOM_MUX_SETTING		0
+#define EDBG_CDC_SERCOM_PINMUX_PAD0		0
+#define EDBG_CDC_SERCOM_PINMUX_PAD1		0
+#define EDBG_CDC_SERCOM_PINMUX_PAD2		0
+#define EDBG_CDC_SERCOM_PINMUX_PAD3		0
+
+/* usart.h, usart_interrupt.h */
+enum usart_callback {
+	USART_CALLBACK_BUFFER_TRANSMITTED,
+	USART_CALLBACK_BUFFER_RECEIVED,
+	USART_CALLBACK_ERROR,
+	USART_CALLBACK_START_RECEIVED,
+	USART_CALLBACK_N,
+};
+
+enum usart_transceiver_type {
+	USART_TRANSCEIVER_RX,
+	USART_TRANSCEIVER_TX,
+};
+
+struct usart_module;
+typedef void (*usart_callback_t)(struct usart_module *const module);
+
+struct usart_config {
+	uint32_t baudrate;
+	uint32_t mux_setting;
+	uint32_t pinmux_pad0;
+	uint32_t pinmux_pad1;
+	uint32_t pinmux_pad2;
+	uint32_t pinmux_pad3;
+	bool start_frame_detection_enable;
+};
+
+struct usart_module {
+	Sercom *hw;
+	usart_callback_t callback[USART_CALLBACK_N];
+	volatile uint8_t *rx_buffer_ptr;
+	volatile uint8_t *tx_buffer_ptr;
+	volatile uint16_t remaining_rx_buffer_length;
+	volatile uint16_t remaining_tx_buffer_length;
+	uint8_t callback_reg_mask;
+	uint8_t callback_enable_mask;
+	volatile enum status_code rx_status;
+	volatile enum status_code tx_status;
+	bool start_frame_detection_enabled;
+	volatile bool rx_start_pending;
+};
+
+/* Simulator only, transmit activity of the console SERCOM */
+typedef struct {
+	uint32_t writeJobs;  ///< usart_write_buffer_job calls that started a job
+	uint32_t txInterrupts;  ///< Simulated interrupts that completed a write job
+	uint32_t txBytes;
+} sim_SercomStats;
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+void system_init(void);
+
+static inline irqflags_t cpu_irq_save(void)
+{
+	return portSET_INTERRUPT_MASK_FROM_ISR();
+}
+
+static inline void cpu_irq_restore(irqflags_t flags)
+{
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(flags);
+}
+
+void port_pin_set_output_level(const uint8_t gpio_pin, const bool level);
+bool port_pin_get_output_level(const uint8_t gpio_pin);
+
+void usart_get_config_defaults(struct usart_config *const config);
+enum status_code usart_init(struct usart_module *const module, Sercom *const hw, const struct usart_config *const config);
+void usart_enable(const struct usart_module *const module);
+void usart_disable(const struct usart_module *const module);
+void usart_register_callback(struct usart_module *const module, usart_callback_t callback_func, enum usart_callback callback_type);
+void usart_enable_callback(struct usart_module *const module, enum usart_callback callback_type);
+enum status_code usart_write_buffer_job(struct usart_module *const module, uint8_t *tx_data, uint16_t length);
+enum status_code usart_read_buffer_job(struct usart_module *const module, uint8_t *rx_data, uint16_t length);
+void usart_abort_job(struct usart_module *const module, enum usart_transceiver_type transceiver_type);
+
+void sim_GetSercomStats(sim_SercomStats *stats);
+
+#endif /* ASF_H_ */
@@ -0,0 +1,331 @@
+/**************************************************************************//**
+* @file      asf_sim.c
+* @brief     Host implementation of the ASF drivers used by the firmware
+* @details   The console SERCOM is modelled on stdin/stdout. Jobs behave
+*            like the ASF callback driver: they return at once and their
+*            completion callbacks run later, from the simulated SERCOM
+*            interrupt, in the context of whichever task is running.
+*            Write jobs and the interrupts that complete them are counted,
+*            see sim_GetSercomStats.
+* @author    Adi
+* @date      2024-1-7
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <asf.h>
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define SIM_SERCOM_SIGNAL	SIGIO	// Simulated SERCOM interrupt, also raised by the kernel when stdin is readable
+#define SIM_LED_COUNT		1
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+static struct usart_module *sercomModule;  ///< The only SERCOM, EDBG_CDC_MODULE
+static bool sercomEnabled;
+static sim_SercomStats sercomStats;  ///< Transmit activity since usart_init
+static bool ledLevel[SIM_LED_COUNT];
+
+static int savedFlags = -1;  ///< stdin file status flags to restore on exit
+static struct termios savedTermios;  ///< Terminal settings to restore on exit
+static bool termiosChanged;
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void sim_ConfigureStdin(void);
+static void sim_RestoreStdin(void);
+static void sim_SercomInterrupt(void);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static void sim_ConfigureStdin(void)
+* @brief	Makes stdin behave like the RX line of a UART
+* @details 	A terminal is switched to character mode without local echo
+*			and without CR to LF translation, so the console sees exactly
+*			what the board would get from a terminal emulator. stdin
+*			raises SIM_SERCOM_SIGNAL whenever input arrives, which is the
+*			receive interrupt. It stays blocking, a terminal shares it
+*			with stdout and the shell.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Input piped from a file must end lines with '\r'
+*****************************************************************************/
+static void sim_ConfigureStdin(void)
+{
+    struct termios raw;
+
+    if (isatty(STDIN_FILENO) && (tcgetattr(STDIN_FILENO, &savedTermios) == 0)) {
+        raw = savedTermios;
+        raw.c_lflag &= ~(tcflag_t)(ICANON | ECHO);
+        raw.c_iflag &= ~(tcflag_t)(ICRNL | INLCR);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        termiosChanged = (tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0);
+    }
+
+    fcntl(STDIN_FILENO, F_SETOWN, getpid());
+    savedFlags = fcntl(STDIN_FILENO, F_GETFL);
+    if (savedFlags != -1) {
+        fcntl(STDIN_FILENO, F_SETFL, savedFlags | O_ASYNC);
+    }
+    atexit(sim_RestoreStdin);
+}
+
+/**************************************************************************//**
+* @fn		static void sim_RestoreStdin(void)
+* @brief	Gives the terminal back in the state it was found
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Registered with atexit
+*****************************************************************************/
+static void sim_RestoreStdin(void)
+{
+    if (savedFlags != -1) {
+        fcntl(STDIN_FILENO, F_SETFL, savedFlags);
+    }
+    if (termiosChanged) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void sim_SercomInterrupt(void)
+* @brief	Simulated SERCOM interrupt handler
+* @details 	Completes a pending write job by writing it to stdout, and
+*			fills a pending read job with whatever stdin has available.
+*			A job's callback runs once it has been fully transferred,
+*			exactly like the ASF callback driver. Unlike the hardware,
+*			which interrupts per character, available input is read in
+*			one go, so remaining_rx_buffer_length moves in steps.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Runs with interrupts masked, see vPortSetInterruptHandler
+*****************************************************************************/
+static void sim_SercomInterrupt(void)
+{
+    struct usart_module *const module = sercomModule;
+    ssize_t count;
+    int available;
+
+    if ((module == NULL) || !sercomEnabled) {
+        return;
+    }
+
+    if (module->remaining_tx_buffer_length > 0) {
+        sercomStats.txInterrupts++;
+        sercomStats.txBytes += module->remaining_tx_buffer_length;
+        while (module->remaining_tx_buffer_length > 0) {
+            count = write(STDOUT_FILENO, (const void *)module->tx_buffer_ptr, module->remaining_tx_buffer_length);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;  // stdout is gone, the data is lost as on a disconnected line
+            }
+            module->tx_buffer_ptr += count;
+            module->remaining_tx_buffer_length -= (uint16_t)count;
+        }
+        module->remaining_tx_buffer_length = 0;
+        module->tx_status = STATUS_OK;
+        if (module->callback_enable_mask & (1 << USART_CALLBACK_BUFFER_TRANSMITTED)) {
+            module->callback[USART_CALLBACK_BUFFER_TRANSMITTED](module);
+        }
+    }
+
+    while (module->remaining_rx_buffer_length > 0) {
+        // Only take what has arrived, the next SIGIO reports more input
+        if ((ioctl(STDIN_FILENO, FIONREAD, &available) != 0) || (available <= 0)) {
+            break;
+        }
+        if (module->rx_start_pending) {
+            // The start condition of the job's first character, as RXS
+            module->rx_start_pending = false;
+            if (module->callback_enable_mask & (1 << USART_CALLBACK_START_RECEIVED)) {
+                module->callback[USART_CALLBACK_START_RECEIVED](module);
+            }
+        }
+        if (available > module->remaining_rx_buffer_length) {
+            available = module->remaining_rx_buffer_length;
+        }
+        count = read(STDIN_FILENO, (void *)module->rx_buffer_ptr, (size_t)available);
+        if (count <= 0) {
+            break;
+        }
+        module->rx_buffer_ptr += count;
+        module->remaining_rx_buffer_length -= (uint16_t)count;
+        if (module->remaining_rx_buffer_length == 0) {
+            module->rx_status = STATUS_OK;
+            if (module->callback_enable_mask & (1 << USART_CALLBACK_BUFFER_RECEIVED)) {
+                // May arm the next job, which is served by the loop
+                module->callback[USART_CALLBACK_BUFFER_RECEIVED](module);
+            }
+        }
+    }
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+#ifndef KTEST
+/**************************************************************************//**
+* @fn		void assert_triggered(const char *file, uint32_t line)
+* @brief	configASSERT failure handler
+* @param[in]	file - Source file of the failed assertion
+*				line - Line of the failed assertion
+* @return		Does not return
+* @note         ktest.c has its own for the tests that link this file
+*****************************************************************************/
+void assert_triggered(const char *file, uint32_t line)
+{
+    fprintf(stderr, "\nconfigASSERT failed at %s:%u\n", file, (unsigned int)line);
+    sim_RestoreStdin();
+    abort();
+}
+#endif
+
+/**************************************************************************//**
+* @fn		void sim_GetSercomStats(sim_SercomStats *stats)
+* @brief	Transmit activity of the console SERCOM since usart_init
+* @details 	Each write job completes in one simulated interrupt, where the
+*			hardware without DMA takes one per character, so txInterrupts
+*			counts what the driver pays per job: an interrupt entry and a
+*			BUFFER_TRANSMITTED callback.
+* @param[out]	stats - Copy of the counters
+* @return		N/A
+* @note         Simulator only, for the host tests
+*****************************************************************************/
+void sim_GetSercomStats(sim_SercomStats *stats)
+{
+    UBaseType_t uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+    *stats = sercomStats;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void system_init(void)
+{
+    // Output must reach the terminal as soon as a write job runs
+    setvbuf(stdout, NULL, _IONBF, 0);
+}
+
+void port_pin_set_output_level(const uint8_t gpio_pin, const bool level)
+{
+    if (gpio_pin < SIM_LED_COUNT) {
+        ledLevel[gpio_pin] = level;
+    }
+}
+
+bool port_pin_get_output_level(const uint8_t gpio_pin)
+{
+    return (gpio_pin < SIM_LED_COUNT) ? ledLevel[gpio_pin] : false;
+}
+
+void usart_get_config_defaults(struct usart_config *const config)
+{
+    memset(config, 0, sizeof(*config));
+    config->baudrate = 9600;
+}
+
+enum status_code usart_init(struct usart_module *const module, Sercom *const hw, const struct usart_config *const config)
+{
+    if (sercomModule != NULL) {
+        return STATUS_ERR_DENIED;
+    }
+
+    memset(module, 0, sizeof(*module));
+    module->hw = hw;
+    module->start_frame_detection_enabled = config->start_frame_detection_enable;
+    sercomModule = module;
+
+    sim_ConfigureStdin();
+    vPortSetInterruptHandler(SIM_SERCOM_SIGNAL, sim_SercomInterrupt);
+    return STATUS_OK;
+}
+
+void usart_enable(const struct usart_module *const module)
+{
+    (void)module;
+    sercomEnabled = true;
+    vPortGenerateSimulatedInterrupt(SIM_SERCOM_SIGNAL);  // Input may already be waiting
+}
+
+void usart_disable(const struct usart_module *const module)
+{
+    (void)module;
+    sercomEnabled = false;
+}
+
+void usart_register_callback(struct usart_module *const module, usart_callback_t callback_func, enum usart_callback callback_type)
+{
+    module->callback[callback_type] = callback_func;
+    module->callback_reg_mask |= (uint8_t)(1 << callback_type);
+}
+
+void usart_enable_callback(struct usart_module *const module, enum usart_callback callback_type)
+{
+    module->callback_enable_mask |= (uint8_t)(1 << callback_type);
+}
+
+enum status_code usart_write_buffer_job(struct usart_module *const module, uint8_t *tx_data, uint16_t length)
+{
+    if (length == 0) {
+        return STATUS_ERR_INVALID_ARG;
+    }
+    if (module->remaining_tx_buffer_length > 0) {
+        return STATUS_BUSY;
+    }
+
+    sercomStats.writeJobs++;
+    module->tx_buffer_ptr = tx_data;
+    module->remaining_tx_buffer_length = length;
+    module->tx_status = STATUS_BUSY;
+    vPortGenerateSimulatedInterrupt(SIM_SERCOM_SIGNAL);
+    return STATUS_OK;
+}
+
+enum status_code usart_read_buffer_job(struct usart_module *const module, uint8_t *rx_data, uint16_t length)
+{
+    if (length == 0) {
+        return STATUS_ERR_INVALID_ARG;
+    }
+    if (module->remaining_rx_buffer_length > 0) {
+        return STATUS_BUSY;
+    }
+
+    module->rx_buffer_ptr = rx_data;
+    module->remaining_rx_buffer_length = length;
+    module->rx_status = STATUS_BUSY;
+    module->rx_start_pending = module->start_frame_detection_enabled;
+    // stdin only signals new input, poll for what arrived while no job was armed
+    vPortGenerateSimulatedInterrupt(SIM_SERCOM_SIGNAL);
+    return STATUS_OK;
+}
+
+void usart_abort_job(struct usart_module *const module, enum usart_transceiver_type transceiver_type)
+{
+    if (transceiver_type == USART_TRANSCEIVER_RX) {
+        module->remaining_rx_buffer_length = 0;
+    } else {
+        module->remaining_tx_buffer_length = 0;
+    }
+}
@@ -0,0 +1,224 @@
+/**************************************************************************//**
+* @file      cbuf_bench.c
+* @brief     Host throughput benchmark of the circular buffer
+* @details   Pushes the same bytes through a buffer the size of the
+*            console's with each way of moving data: byte by byte with
+*            put2/get, in blocks with put_range/get_range, and in place
+*            with reserve/commit and peek/consume. Each chunk is written
+*            and then read back, for chunk sizes from one byte to the RX
+*            job size of dUART.c, after a pass that checks every byte comes
+*            back. Prints CSV lines:
+*            cbuf,<variant>,<method>,<chunk>,<ns per byte>,<bytes per cycle>
+*            The variant is pow2 for the power-of-two buffer, which the
+*            console's interrupt path uses, and modulo for the generic one,
+*            so the two builds of "make cbufbench" can be compared line by
+*            line. Byte by byte is what a per-character interrupt costs.
+*            Cycles are those of the time stamp counter on x86, the bytes
+*            per cycle column is 0 elsewhere. Exits with 1 if a byte came
+*            back wrong. See "make cbufbench" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "SerialConsole/circular_buffer.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define BENCH_SIZE			512			// As RX_BUFFER_SIZE and TX_BUFFER_SIZE of dUART.c
+#define BENCH_BYTES			(32UL << 20)	// Bytes through the buffer per method and chunk
+#define BENCH_CHECK_BYTES	(BENCH_SIZE * 64UL)	// Bytes checked first, many wraps
+#define BENCH_CHUNK_MAX		64
+#define BENCH_VARIANT		(CIRCULAR_BUF_POW2 ? "pow2" : "modulo")
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+/// Moves one chunk in and out of the buffer, returns false if it came back wrong
+typedef bool (*bench_Method)(const uint8_t *data, uint8_t *copy, size_t length);
+
+static uint8_t buffer[BENCH_SIZE];
+static circular_buf_static_t storage;
+static cbuf_handle_t cbuf;
+
+static const size_t chunkSizes[] = { 1, 4, 16, BENCH_CHUNK_MAX };  ///< Up to RX_CHUNK_SIZE of dUART.c
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static uint64_t bench_Cycles(void);
+static uint64_t bench_Nanoseconds(void);
+static bool bench_Byte(const uint8_t *data, uint8_t *copy, size_t length);
+static bool bench_Range(const uint8_t *data, uint8_t *copy, size_t length);
+static bool bench_Span(const uint8_t *data, uint8_t *copy, size_t length);
+static bool bench_Run(const char *name, bench_Method method, size_t chunk);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+static uint64_t bench_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static uint64_t bench_Nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+/**************************************************************************//**
+* @fn		static bool bench_Byte(const uint8_t *data, uint8_t *copy, size_t length)
+* @brief	One call per byte, as the console did before the block API
+*****************************************************************************/
+static bool bench_Byte(const uint8_t *data, uint8_t *copy, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        if (circular_buf_put2(cbuf, data[i]) != 0) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (circular_buf_get(cbuf, &copy[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**************************************************************************//**
+* @fn		static bool bench_Range(const uint8_t *data, uint8_t *copy, size_t length)
+* @brief	One block copy each way, as dUART_WriteString sends
+*****************************************************************************/
+static bool bench_Range(const uint8_t *data, uint8_t *copy, size_t length)
+{
+    return (circular_buf_put_range(cbuf, data, length) == 0) && (circular_buf_get_range(cbuf, copy, length) == length);
+}
+
+/**************************************************************************//**
+* @fn		static bool bench_Span(const uint8_t *data, uint8_t *copy, size_t length)
+* @brief	Copies in place, as the USART jobs of dUART.c fill and drain
+* @details 	A chunk that crosses the end of the array takes two spans.
+*****************************************************************************/
+static bool bench_Span(const uint8_t *data, uint8_t *copy, size_t length)
+{
+    size_t done = 0;
+    uint8_t *span;
+
+    while (done < length) {
+        size_t part = circular_buf_reserve(cbuf, &span);
+
+        if (part == 0) {
+            return false;
+        }
+        if (part > (length - done)) {
+            part = length - done;
+        }
+        memcpy(span, &data[done], part);
+        circular_buf_commit(cbuf, part);
+        done += part;
+    }
+    for (done = 0; done < length; ) {
+        size_t part = circular_buf_peek(cbuf, &span);
+
+        if (part == 0) {
+            return false;
+        }
+        if (part > (length - done)) {
+            part = length - done;
+        }
+        memcpy(&copy[done], span, part);
+        circular_buf_consume(cbuf, part);
+        done += part;
+    }
+    return true;
+}
+
+/**************************************************************************//**
+* @fn		static bool bench_Run(const char *name, bench_Method method, size_t chunk)
+* @brief	Times BENCH_BYTES through the buffer and prints the result line
+* @details 	A first pass of BENCH_CHECK_BYTES compares every chunk read back
+*			with what was written, varying the data. The timed pass then
+*			moves the same chunk over and over, with only the method's
+*			calls in the loop. The buffer is reset before each pass, so
+*			every method wraps the array at the same points.
+* @return		false if a chunk came back wrong
+*****************************************************************************/
+static bool bench_Run(const char *name, bench_Method method, size_t chunk)
+{
+    uint8_t data[BENCH_CHUNK_MAX];
+    uint8_t copy[BENCH_CHUNK_MAX];
+    uint64_t cycles, nanoseconds;
+    unsigned long bytes;
+    bool passed = true;
+
+    circular_buf_reset(cbuf);
+    for (bytes = 0; bytes < BENCH_CHECK_BYTES; bytes += chunk) {
+        for (size_t i = 0; i < chunk; i++) {
+            data[i] = (uint8_t)(bytes + i);
+        }
+        if (!method(data, copy, chunk) || (memcmp(data, copy, chunk) != 0)) {
+            printf("FAIL cbuf_bench: %s lost or changed a chunk of %u bytes\n", name, (unsigned int)chunk);
+            return false;
+        }
+    }
+
+    circular_buf_reset(cbuf);
+    nanoseconds = bench_Nanoseconds();
+    cycles = bench_Cycles();
+    for (bytes = 0; bytes < BENCH_BYTES; bytes += chunk) {
+        passed &= method(data, copy, chunk);
+    }
+    cycles = bench_Cycles() - cycles;
+    nanoseconds = bench_Nanoseconds() - nanoseconds;
+    if (!passed) {
+        printf("FAIL cbuf_bench: %s lost a chunk of %u bytes\n", name, (unsigned int)chunk);
+        return false;
+    }
+
+    printf("cbuf,%s,%s,%u,%.2f,%.3f\n", BENCH_VARIANT, name, (unsigned int)chunk, (double)nanoseconds / bytes,
+           (cycles != 0) ? ((double)bytes / cycles) : 0.0);
+    return true;
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    bool passed = true;
+
+    cbuf = circular_buf_init_static(buffer, sizeof(buffer), &storage);
+    if (cbuf == NULL) {
+        printf("FAIL cbuf_bench: init\n");
+        return 1;
+    }
+
+    printf("# cbuf_bench, %u byte buffer, %lu bytes per line\n", (unsigned int)BENCH_SIZE, BENCH_BYTES);
+    printf("# primitive,variant,method,chunk,ns_per_byte,bytes_per_cycle\n");
+    for (uint8_t i = 0; i < (sizeof(chunkSizes) / sizeof(chunkSizes[0])); i++) {
+        passed = passed && bench_Run("byte", bench_Byte, chunkSizes[i]);
+        passed = passed && bench_Run("range", bench_Range, chunkSizes[i]);
+        passed = passed && bench_Run("span", bench_Span, chunkSizes[i]);
+    }
+    return passed ? 0 : 1;
+}
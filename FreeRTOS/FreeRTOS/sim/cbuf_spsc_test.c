@@ -0,0 +1,200 @@
+/**************************************************************************//**
+* @file      cbuf_spsc_test.c
+* @brief     Host stress test of the lock-free circular buffer mode
+* @details   One producer thread and one consumer thread share a small
+*            CIRCULAR_BUF_SPSC buffer without any lock, like a SERCOM
+*            callback and a task on the target. The producer writes a
+*            stream of 32-bit sequence numbers with put2, put_range and
+*            reserve/commit in turn, the consumer reads it back with get,
+*            get_range and peek/consume in turn and checks that every
+*            number arrives once and in order. Exits with 1 on the first
+*            mismatch. A side that cannot make progress yields, so the
+*            test also runs on a single CPU. See "make test" in the
+*            Makefile, build it with SANITIZE=thread to have the accesses
+*            checked as well.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SerialConsole/circular_buffer.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define SPSC_SIZE			64			// Small, so the indices wrap constantly
+#define SPSC_NUMBERS		4000000UL	// Sequence numbers sent, 16 MB through the buffer
+#define SPSC_RECORD			sizeof(uint32_t)
+
+#if !CIRCULAR_BUF_SPSC
+#error cbuf_spsc_test needs CIRCULAR_BUF_SPSC
+#endif
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+static uint8_t buffer[SPSC_SIZE];
+static circular_buf_static_t storage;
+static cbuf_handle_t cbuf;
+static bool failed;  ///< Set by the consumer on a mismatch
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void * spsc_Producer(void *parameter);
+static void * spsc_Consumer(void *parameter);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static void * spsc_Producer(void *parameter)
+* @brief	Writes SPSC_NUMBERS sequence numbers, spinning while full
+* @details 	The write method changes with each number. put2 and
+*			reserve/commit can store part of a number and finish it on a
+*			later try, so the consumer sees records split at any byte.
+*****************************************************************************/
+static void * spsc_Producer(void *parameter)
+{
+    (void)parameter;
+
+    for (uint32_t sequence = 0; sequence < SPSC_NUMBERS; sequence++) {
+        uint8_t record[SPSC_RECORD];
+        size_t written = 0;
+
+        memcpy(record, &sequence, sizeof(record));
+        switch (sequence % 3) {
+        case 0:
+            while (written < sizeof(record)) {
+                if (circular_buf_put2(cbuf, record[written]) == 0) {
+                    written++;
+                } else {
+                    sched_yield();
+                }
+            }
+            break;
+        case 1:
+            while (circular_buf_put_range(cbuf, record, sizeof(record)) != 0) {
+                sched_yield();
+            }
+            break;
+        default:
+            while (written < sizeof(record)) {
+                uint8_t *span;
+                size_t length = circular_buf_reserve(cbuf, &span);
+
+                if (length > (sizeof(record) - written)) {
+                    length = sizeof(record) - written;
+                }
+                if (length == 0) {
+                    sched_yield();
+                }
+                memcpy(span, &record[written], length);
+                circular_buf_commit(cbuf, length);
+                written += length;
+            }
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**************************************************************************//**
+* @fn		static void * spsc_Consumer(void *parameter)
+* @brief	Reads the numbers back and checks their order
+* @details 	Sets failed and stops at the first mismatch.
+*****************************************************************************/
+static void * spsc_Consumer(void *parameter)
+{
+    uint32_t expected = 0;
+
+    (void)parameter;
+
+    while (expected < SPSC_NUMBERS) {
+        uint8_t record[SPSC_RECORD];
+        size_t got = 0;
+        uint32_t value;
+
+        while (got < sizeof(record)) {
+            size_t before = got;
+
+            switch ((expected + got) % 3) {
+            case 0:
+                if (circular_buf_get(cbuf, &record[got]) == 0) {
+                    got++;
+                }
+                break;
+            case 1:
+                got += circular_buf_get_range(cbuf, &record[got], sizeof(record) - got);
+                break;
+            default: {
+                uint8_t *span;
+                size_t length = circular_buf_peek(cbuf, &span);
+
+                if (length > (sizeof(record) - got)) {
+                    length = sizeof(record) - got;
+                }
+                memcpy(&record[got], span, length);
+                circular_buf_consume(cbuf, length);
+                got += length;
+                break;
+            }
+            }
+            if (got == before) {
+                sched_yield();
+            }
+        }
+
+        memcpy(&value, record, sizeof(value));
+        if (value != expected) {
+            printf("FAIL cbuf_spsc_test: got %u, expected %u\n", (unsigned int)value, (unsigned int)expected);
+            failed = true;
+            return NULL;
+        }
+        expected++;
+    }
+
+    if (!circular_buf_empty(cbuf)) {
+        printf("FAIL cbuf_spsc_test: %u bytes left over\n", (unsigned int)circular_buf_size(cbuf));
+        failed = true;
+    }
+    return NULL;
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    pthread_t producer;
+    pthread_t consumer;
+
+    cbuf = circular_buf_init_static(buffer, sizeof(buffer), &storage);
+    if (cbuf == NULL) {
+        printf("FAIL cbuf_spsc_test: init\n");
+        return 1;
+    }
+
+    pthread_create(&consumer, NULL, spsc_Consumer, NULL);
+    pthread_create(&producer, NULL, spsc_Producer, NULL);
+    pthread_join(consumer, NULL);
+    if (failed) {
+        // The producer may be waiting for room that will never come
+        return 1;
+    }
+    pthread_join(producer, NULL);
+
+    printf("cbuf_spsc_test: %lu numbers through %u bytes, in order\n", SPSC_NUMBERS, (unsigned int)SPSC_SIZE);
+    return 0;
+}
@@ -0,0 +1,352 @@
+/**************************************************************************//**
+* @file      cbuf_test.c
+* @brief     Host unit test of the circular buffer
+* @details   Exercises src/SerialConsole/circular_buffer.c on its own,
+*            without the scheduler: the size check at init, byte put/get
+*            through many wraps with guard bytes around the array, block
+*            copies, reserve/commit and peek/consume starting at every
+*            offset of the array. Prints one line per failed check and a
+*            summary, exits with 1 if any check failed.
+*            Built for the configured variant and for the generic one, see
+*            "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SerialConsole/circular_buffer.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define TEST_SIZE			16		// Buffer under test, a power of two
+#define TEST_GUARD			8		// Bytes checked on each side of the array
+#define TEST_GUARD_BYTE		0xA5
+#define TEST_ROUNDS			1000	// Put/get rounds, many times the size
+
+#define CHECK(condition)	test_Check((condition), #condition, __LINE__)
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+static uint8_t memory[TEST_GUARD + TEST_SIZE + TEST_GUARD];  ///< Array under test with its guards
+static uint8_t * const buffer = &memory[TEST_GUARD];
+static circular_buf_static_t storage;
+static uint32_t checkCount;
+static uint32_t failCount;
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void test_Check(bool passed, const char *condition, int line);
+static cbuf_handle_t test_Open(size_t offset);
+static void test_CheckGuards(void);
+static void test_Init(void);
+static void test_PutGet(void);
+static void test_Range(void);
+static void test_ReserveCommit(void);
+static void test_PeekConsume(void);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static void test_Check(bool passed, const char *condition, int line)
+* @brief	Counts a check and reports it if it failed
+*****************************************************************************/
+static void test_Check(bool passed, const char *condition, int line)
+{
+    checkCount++;
+    if (!passed) {
+        failCount++;
+        printf("FAIL cbuf_test.c:%d: %s\n", line, condition);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static cbuf_handle_t test_Open(size_t offset)
+* @brief	Creates an empty buffer whose head and tail are at offset
+* @details 	Bytes are put and got until both indices reach offset, so
+*			what follows starts offset bytes into the array.
+* @return		Handle of the buffer
+*****************************************************************************/
+static cbuf_handle_t test_Open(size_t offset)
+{
+    cbuf_handle_t cbuf;
+    uint8_t data;
+
+    memset(memory, TEST_GUARD_BYTE, sizeof(memory));
+    cbuf = circular_buf_init_static(buffer, TEST_SIZE, &storage);
+    for (size_t i = 0; i < offset; i++) {
+        circular_buf_put2(cbuf, 0);
+        circular_buf_get(cbuf, &data);
+    }
+    return cbuf;
+}
+
+/**************************************************************************//**
+* @fn		static void test_CheckGuards(void)
+* @brief	Checks that nothing was written outside the array
+*****************************************************************************/
+static void test_CheckGuards(void)
+{
+    bool intact = true;
+
+    for (size_t i = 0; i < TEST_GUARD; i++) {
+        intact = intact && (memory[i] == TEST_GUARD_BYTE) && (memory[TEST_GUARD + TEST_SIZE + i] == TEST_GUARD_BYTE);
+    }
+    CHECK(intact);
+}
+
+/**************************************************************************//**
+* @fn		static void test_Init(void)
+* @brief	Sizes accepted by init, capacity and the initial state
+*****************************************************************************/
+static void test_Init(void)
+{
+    cbuf_handle_t cbuf;
+
+    CHECK(circular_buf_init_static(buffer, 0, &storage) == NULL);
+#if CIRCULAR_BUF_POW2
+    // The mask only works for powers of two
+    CHECK(circular_buf_init_static(buffer, 3, &storage) == NULL);
+    CHECK(circular_buf_init_static(buffer, 12, &storage) == NULL);
+    CHECK(circular_buf_init_static(buffer, TEST_SIZE + 1, &storage) == NULL);
+    CHECK(circular_buf_init(buffer, 12) == NULL);
+#else
+    CHECK(circular_buf_init_static(buffer, 12, &storage) != NULL);
+#endif
+
+    for (size_t size = 1; size <= TEST_SIZE; size *= 2) {
+        cbuf = circular_buf_init_static(buffer, size, &storage);
+        CHECK(cbuf != NULL);
+        CHECK(circular_buf_capacity(cbuf) == size);
+        CHECK(circular_buf_empty(cbuf));
+        CHECK(!circular_buf_full(cbuf));
+        CHECK(circular_buf_size(cbuf) == 0);
+        CHECK(circular_buf_space(cbuf) == size);
+    }
+
+    cbuf = circular_buf_init(buffer, TEST_SIZE);
+    CHECK(cbuf != NULL);
+    CHECK(circular_buf_capacity(cbuf) == TEST_SIZE);
+    circular_buf_free(cbuf);
+}
+
+/**************************************************************************//**
+* @fn		static void test_PutGet(void)
+* @brief	Byte FIFO order, full and empty through many wraps
+* @details 	A smaller buffer than the array is used too, so a mask or
+*			limit that ignored the size given to init would write past it.
+*****************************************************************************/
+static void test_PutGet(void)
+{
+    for (size_t size = TEST_SIZE / 2; size <= TEST_SIZE; size *= 2) {
+        cbuf_handle_t cbuf;
+        uint8_t next = 0;
+        uint8_t expected = 0;
+        uint8_t data;
+        bool ordered = true;
+
+        memset(memory, TEST_GUARD_BYTE, sizeof(memory));
+        cbuf = circular_buf_init_static(buffer, size, &storage);
+
+        for (uint32_t round = 0; round < TEST_ROUNDS; round++) {
+            // Fill a varying amount, up to full, then drain part of it
+            size_t fill = (round % size) + 1;
+
+            while ((fill > 0) && !circular_buf_full(cbuf)) {
+                ordered = ordered && (circular_buf_put2(cbuf, next++) == 0);
+                fill--;
+            }
+            if (circular_buf_full(cbuf)) {
+                ordered = ordered && (circular_buf_size(cbuf) == size);
+                ordered = ordered && (circular_buf_put2(cbuf, 0xFF) == -1);
+            }
+            for (size_t drain = (round % 3) + 1; drain > 0; drain--) {
+                if (circular_buf_get(cbuf, &data) == 0) {
+                    ordered = ordered && (data == expected++);
+                }
+            }
+        }
+        while (circular_buf_get(cbuf, &data) == 0) {
+            ordered = ordered && (data == expected++);
+        }
+
+        CHECK(ordered);
+        CHECK(expected == next);
+        CHECK(circular_buf_empty(cbuf));
+        CHECK(circular_buf_get(cbuf, &data) == -1);
+        // The smaller buffer must not touch the rest of the array either
+        CHECK((size == TEST_SIZE) || (buffer[size] == TEST_GUARD_BYTE));
+        test_CheckGuards();
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_Range(void)
+* @brief	Block copies across the end of the array
+*****************************************************************************/
+static void test_Range(void)
+{
+    uint8_t in[TEST_SIZE + 1];
+    uint8_t out[TEST_SIZE + 4];
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t)(0x40 + i);
+    }
+
+    for (size_t offset = 0; offset < TEST_SIZE; offset++) {
+        cbuf_handle_t cbuf = test_Open(offset);
+
+        // Too long: rejected whole, nothing stored
+        CHECK(circular_buf_put_range(cbuf, in, TEST_SIZE + 1) == -1);
+        CHECK(circular_buf_empty(cbuf));
+
+        // Exactly full, wrapping unless offset is 0
+        CHECK(circular_buf_put_range(cbuf, in, TEST_SIZE) == 0);
+        CHECK(circular_buf_full(cbuf));
+        CHECK(circular_buf_put_range(cbuf, in, 1) == -1);
+
+        // Read back in two parts, then ask for more than is left
+        memset(out, 0, sizeof(out));
+        CHECK(circular_buf_get_range(cbuf, out, 5) == 5);
+        CHECK(circular_buf_get_range(cbuf, &out[5], sizeof(out) - 5) == (TEST_SIZE - 5));
+        CHECK(memcmp(out, in, TEST_SIZE) == 0);
+        CHECK(circular_buf_empty(cbuf));
+        CHECK(circular_buf_get_range(cbuf, out, sizeof(out)) == 0);
+
+        // Zero length is a no-op
+        CHECK(circular_buf_put_range(cbuf, in, 0) == 0);
+        CHECK(circular_buf_empty(cbuf));
+        test_CheckGuards();
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_ReserveCommit(void)
+* @brief	Reserved spans stop at the end of the array and at the tail
+*****************************************************************************/
+static void test_ReserveCommit(void)
+{
+    for (size_t offset = 0; offset < TEST_SIZE; offset++) {
+        cbuf_handle_t cbuf = test_Open(offset);
+        uint8_t *span;
+        size_t length;
+        size_t total = 0;
+        uint8_t data;
+        bool ordered = true;
+
+        // First span runs from offset to the end of the array
+        length = circular_buf_reserve(cbuf, &span);
+        CHECK(span == &buffer[offset]);
+        CHECK(length == (TEST_SIZE - offset));
+
+        // Nothing is visible until committed, and committing 0 does nothing
+        span[0] = 0;
+        circular_buf_commit(cbuf, 0);
+        CHECK(circular_buf_empty(cbuf));
+
+        // Fill the whole buffer span by span, committing part of each
+        while ((length = circular_buf_reserve(cbuf, &span)) > 0) {
+            size_t part = (length > 3) ? (length - 3) : length;
+
+            CHECK(span >= buffer);
+            CHECK((span + length) <= (buffer + TEST_SIZE));
+            for (size_t i = 0; i < part; i++) {
+                span[i] = (uint8_t)(total + i);
+            }
+            circular_buf_commit(cbuf, part);
+            total += part;
+            CHECK(circular_buf_size(cbuf) == total);
+        }
+        CHECK(total == TEST_SIZE);
+        CHECK(circular_buf_full(cbuf));
+
+        for (size_t i = 0; i < TEST_SIZE; i++) {
+            ordered = ordered && (circular_buf_get(cbuf, &data) == 0) && (data == (uint8_t)i);
+        }
+        CHECK(ordered);
+
+        // The free space now wraps: the span stops at the end of the array
+        length = circular_buf_reserve(cbuf, &span);
+        CHECK(span == &buffer[offset]);
+        CHECK(length == (TEST_SIZE - offset));
+        test_CheckGuards();
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_PeekConsume(void)
+* @brief	Peeked spans stop at the end of the array and at the head
+*****************************************************************************/
+static void test_PeekConsume(void)
+{
+    uint8_t in[TEST_SIZE];
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t)(0x80 + i);
+    }
+
+    for (size_t offset = 0; offset < TEST_SIZE; offset++) {
+        for (size_t count = 1; count <= TEST_SIZE; count++) {
+            cbuf_handle_t cbuf = test_Open(offset);
+            uint8_t *span;
+            size_t length;
+            size_t seen = 0;
+            size_t expected = ((offset + count) > TEST_SIZE) ? (TEST_SIZE - offset) : count;
+            bool ordered = true;
+
+            CHECK(circular_buf_peek(cbuf, &span) == 0);
+            circular_buf_put_range(cbuf, in, count);
+
+            // Peeking does not consume, the same span comes back
+            length = circular_buf_peek(cbuf, &span);
+            CHECK(span == &buffer[offset]);
+            CHECK(length == expected);
+            CHECK(circular_buf_peek(cbuf, &span) == length);
+            CHECK(circular_buf_size(cbuf) == count);
+
+            // Consume one byte at a time from the first span, then the rest
+            circular_buf_consume(cbuf, 0);
+            CHECK(circular_buf_size(cbuf) == count);
+            while ((length = circular_buf_peek(cbuf, &span)) > 0) {
+                size_t part = (length > 1) ? 1 : length;
+
+                ordered = ordered && (span >= buffer) && ((span + length) <= (buffer + TEST_SIZE));
+                ordered = ordered && (memcmp(span, &in[seen], length) == 0);
+                circular_buf_consume(cbuf, part);
+                seen += part;
+            }
+            CHECK(ordered);
+            CHECK(seen == count);
+            CHECK(circular_buf_empty(cbuf));
+        }
+    }
+    test_CheckGuards();
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    test_Init();
+    test_PutGet();
+    test_Range();
+    test_ReserveCommit();
+    test_PeekConsume();
+
+    printf("cbuf_test (%s): %u checks, %u failed\n", CIRCULAR_BUF_POW2 ? "power of two" : "generic",
+           (unsigned int)checkCount, (unsigned int)failCount);
+    return (failCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+/**************************************************************************//**
+* @file      channel_test.c
+* @brief     Host test of the ISR-to-task channel
+* @details   First the basics, from a task with interrupts masked as from
+*            an interrupt: items come out in the order they went in, a full
+*            channel drops the item, an empty one times out, and a send
+*            that wakes a receiver above the running task asks for a
+*            switch. Then the race the channel's notification rule has to
+*            win: a host thread raises a simulated interrupt at random
+*            moments, the handler sends bursts of numbered items, and the
+*            test task receives them with random pauses, so sends land
+*            before, during and after each of its checks of the ring. Every
+*            item must come out once and in order, dropped ones only when
+*            the channel was full, and a receive must never wait out its
+*            timeout, which is what a lost notification looks like while
+*            the interrupt keeps sending. See "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+#include "ktest.h"
+#include "channel.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define CH_LENGTH			4		// Small, so the race sees the channel full as well
+#define CH_WAIT				3		// Ticks of the timed out receive
+#define CH_SIGNAL			SIGUSR1	// Simulated interrupt of the sender
+#define CH_ITEMS			60000UL	// Sends the interrupt attempts in the race
+#define CH_BURST_MAX		4		// Items per interrupt, 1 to this
+#define CH_STALL			50		// Ticks a receive may wait, far more than the interrupt's period
+#define CH_RAISE_MAX_US		20		// Longest pause between two interrupts
+#define CH_TIMEOUT			20000	// Ticks, the race takes a few seconds
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+static ChannelHandle_t channel;
+static volatile uint32_t received;  ///< Item of the receiver in the basic test
+static volatile bool receiverDone;
+
+static uint32_t isrNext;  ///< Number of the next item the interrupt sends
+static volatile uint32_t isrDropped;  ///< Sends that found the channel full
+static volatile bool isrFinished;  ///< All CH_ITEMS sends made, stops the raising thread
+static uint32_t isrRandom = 0x2024011EUL;  ///< xorshift32, interrupt side
+static uint32_t taskRandom = 0x13579BDFUL;  ///< xorshift32, receiver side
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static uint32_t ch_Random(uint32_t *state);
+static void ch_Receiver(void *parameter);
+static void ch_TestOrder(void);
+static void ch_TestWakesReceiver(void);
+static void ch_Interrupt(void);
+static void *ch_Raise(void *parameter);
+static void ch_TestRace(void);
+static void ch_Test(void *parameter);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+static uint32_t ch_Random(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/**************************************************************************//**
+* @fn		static void ch_Receiver(void *parameter)
+* @brief	Receives one item, waiting as long as it takes
+*****************************************************************************/
+static void ch_Receiver(void *parameter)
+{
+    uint32_t item;
+
+    (void)parameter;
+    if (xChannelReceive(channel, &item, portMAX_DELAY) == pdPASS) {
+        received = item;
+    }
+    receiverDone = true;
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void ch_TestOrder(void)
+* @brief	Items come out in order, a full channel drops, an empty one waits
+*****************************************************************************/
+static void ch_TestOrder(void)
+{
+    UBaseType_t mask;
+    uint32_t item;
+    TickType_t start;
+
+    // Twice round the ring, so the indexes wrap
+    for (uint32_t round = 0; round < 2; round++) {
+        mask = portSET_INTERRUPT_MASK_FROM_ISR();
+        for (uint32_t i = 0; i < CH_LENGTH; i++) {
+            item = (round * 10U) + i;
+            CHECK(xChannelSendFromISR(channel, &item, NULL) == pdPASS);
+        }
+        item = 99;
+        CHECK(xChannelSendFromISR(channel, &item, NULL) == errQUEUE_FULL);
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        CHECK(uxChannelMessagesWaiting(channel) == CH_LENGTH);
+
+        for (uint32_t i = 0; i < CH_LENGTH; i++) {
+            CHECK((xChannelReceive(channel, &item, 0) == pdPASS) && (item == ((round * 10U) + i)));
+        }
+        CHECK(xChannelReceive(channel, &item, 0) == errQUEUE_EMPTY);
+    }
+
+    start = xTaskGetTickCount();
+    CHECK(xChannelReceive(channel, &item, CH_WAIT) == errQUEUE_EMPTY);
+    CHECK((xTaskGetTickCount() - start) >= CH_WAIT);
+}
+
+/**************************************************************************//**
+* @fn		static void ch_TestWakesReceiver(void)
+* @brief	A send to a blocked receiver above the running task asks for a switch
+*****************************************************************************/
+static void ch_TestWakesReceiver(void)
+{
+    BaseType_t woken = pdFALSE;
+    UBaseType_t mask;
+    uint32_t item = 42;
+
+    receiverDone = false;
+    CHECK(xTaskCreate(ch_Receiver, "Recv", configMINIMAL_STACK_SIZE, NULL, KTEST_PRIORITY + 1, NULL) == pdPASS);
+    CHECK(!receiverDone);
+
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    CHECK(xChannelSendFromISR(channel, &item, &woken) == pdPASS);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    CHECK(woken == pdTRUE);
+    taskYIELD();
+    CHECK(receiverDone && (received == 42));
+    CHECK(uxChannelMessagesWaiting(channel) == 0);
+}
+
+/**************************************************************************//**
+* @fn		static void ch_Interrupt(void)
+* @brief	Simulated interrupt of the race, sends a burst of numbered items
+*****************************************************************************/
+static void ch_Interrupt(void)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t burst = 1 + (ch_Random(&isrRandom) % CH_BURST_MAX);
+
+    for (; (burst > 0) && (isrNext < CH_ITEMS); burst--) {
+        if (xChannelSendFromISR(channel, &isrNext, &woken) != pdPASS) {
+            isrDropped++;
+        }
+        isrNext++;
+    }
+    if (isrNext == CH_ITEMS) {
+        isrFinished = true;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**************************************************************************//**
+* @fn		static void *ch_Raise(void *parameter)
+* @brief	Host thread that raises the interrupt until every item is sent
+* @note         Created with the simulated interrupts blocked, which it keeps,
+*				so the handler only ever runs in the running task
+*****************************************************************************/
+static void *ch_Raise(void *parameter)
+{
+    uint32_t random = 0x2468ACE1UL;
+
+    (void)parameter;
+    while (!isrFinished) {
+        struct timespec pause = { 0, (long)(ch_Random(&random) % (CH_RAISE_MAX_US + 1)) * 1000L };
+
+        vPortGenerateSimulatedInterrupt(CH_SIGNAL);
+        nanosleep(&pause, NULL);
+    }
+    return NULL;
+}
+
+/**************************************************************************//**
+* @fn		static void ch_TestRace(void)
+* @brief	Items sent at random moments all come out, in order, without a stall
+* @details 	The receiver sometimes spins for a while, so sends find it
+*			busy with an earlier item, and sometimes sleeps a tick, so
+*			the channel fills and drops.
+*****************************************************************************/
+static void ch_TestRace(void)
+{
+    pthread_t raiser;
+    uint32_t count = 0;
+    uint32_t stalls = 0;
+    uint32_t disorders = 0;
+    int64_t last = -1;
+
+    vPortSetInterruptHandler(CH_SIGNAL, ch_Interrupt);
+    taskENTER_CRITICAL();
+    if (pthread_create(&raiser, NULL, ch_Raise, NULL) != 0) {
+        taskEXIT_CRITICAL();
+        CHECK(!"raising thread created");
+        return;
+    }
+    taskEXIT_CRITICAL();
+
+    while ((count + isrDropped) < CH_ITEMS) {
+        uint32_t item;
+        uint32_t pause = ch_Random(&taskRandom);
+        TickType_t start = xTaskGetTickCount();
+        BaseType_t result = xChannelReceive(channel, &item, CH_STALL);
+
+        // With the interrupt this frequent, only a lost notification lets a
+        // receive wait its whole timeout: the receive then finds the items
+        // left since, so the wait is what shows it
+        if ((xTaskGetTickCount() - start) >= CH_STALL) {
+            stalls++;
+            break;
+        }
+        if (result != pdPASS) {
+            continue;
+        }
+        if ((int64_t)item <= last) {
+            disorders++;
+        }
+        last = item;
+        count++;
+
+        if ((pause % 64) == 0) {
+            vTaskDelay(1);
+        } else {
+            for (volatile uint32_t spin = pause % 256; spin > 0; spin--) {
+            }
+        }
+    }
+    isrFinished = true;
+    pthread_join(raiser, NULL);
+
+    CHECK(stalls == 0);
+    CHECK(disorders == 0);
+    CHECK((count + isrDropped) == CH_ITEMS);
+    CHECK(uxChannelMessagesWaiting(channel) == 0);
+    printf("channel_test: %lu items raced, %u received, %u dropped on a full channel\n", CH_ITEMS,
+           (unsigned int)count, (unsigned int)isrDropped);
+}
+
+static void ch_Test(void *parameter)
+{
+    (void)parameter;
+
+    channel = xChannelCreate(CH_LENGTH, sizeof(uint32_t));
+    CHECK(channel != NULL);
+    if (channel != NULL) {
+        ch_TestOrder();
+        ch_TestWakesReceiver();
+        ch_TestRace();
+    }
+    ktest_End();
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    return ktest_Run("channel_test", ch_Test, CH_TIMEOUT);
+}
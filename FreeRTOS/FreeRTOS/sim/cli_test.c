@@ -0,0 +1,412 @@
+/**************************************************************************//**
+* @file      cli_test.c
+* @brief     Host unit test of the CLI parser
+* @details   Runs src/SerialConsole/CLI.c on its own, without the scheduler,
+*            from a table of input lines with the expected result, console
+*            output and handler argument. The console, the LED queue and the
+*            commands' back ends are stubs that record what they are given.
+*            Built with DEBUG, so the command table order is asserted too.
+*            Then random lines, made of pieces of commands, numbers,
+*            separators and any other byte, with or without a terminator,
+*            must each give a result and output the parser can give, and
+*            valid commands are timed through the parser. Each random line
+*            is copied to a heap block of exactly its length, so "make
+*            SANITIZE=address test" also catches a read past it. Prints one
+*            line per failed case and a summary, exits with 1 if any case
+*            failed. See "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <asf.h>
+#include "SerialConsole/CLI.h"
+#include "SerialConsole/dLog.h"
+#include "Benchmark/kLatency.h"
+#include "Benchmark/kTop.h"
+#include "Benchmark/kTrace.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define TEST_LINE_SIZE		32	// Input buffer, larger than MAX_INPUT_LENGTH_CLI
+#define TEST_OUTPUT_SIZE	256
+#define TEST_NONE			INT32_MIN	// No handler argument expected
+#define TEST_FUZZ_LINES		200000UL
+#define TEST_FUZZ_SEED		0x2024011EUL	// Fixed, so a failing line comes back on the next run
+#define TEST_TIMED_LINES	1000000UL
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+/// One input line and what it must do
+typedef struct {
+    const char *line;
+    int32_t result;
+    const char *output;  ///< Expected start of the console output
+    int32_t argument;  ///< Value the back end must receive, or TEST_NONE
+} test_Case;
+
+static const test_Case cases[] = {
+    // Commands and separators
+    { "led 100",				0,	"Valid command\r\n",				100 },
+    { "  led\t 42  ",			0,	"Valid command\r\n",				42 },
+    { "led +7",					0,	"Valid command\r\n",				7 },
+    { "top 0",					0,	"Valid command\r\n",				0 },
+    { "trace 15",				0,	"Valid command\r\n",				15 },
+    { "crit",					0,	"Valid command\r\n",				TEST_NONE },
+    { "help",					0,	"Valid command\r\ncrit\r\n",		TEST_NONE },
+
+    // Unknown commands, which the binary search must not find
+    { "",						-1,	"",									TEST_NONE },
+    { "   ",					-1,	"",									TEST_NONE },
+    { "foo",					-1,	"Invalid command\r\n",				TEST_NONE },
+    { "LED 100",				-1,	"Invalid command\r\n",				TEST_NONE },
+    { "le 100",					-1,	"Invalid command\r\n",				TEST_NONE },
+    { "leds 100",				-1,	"Invalid command\r\n",				TEST_NONE },
+    { "a",						-1,	"Invalid command\r\n",				TEST_NONE },
+    { "zzz",					-1,	"Invalid command\r\n",				TEST_NONE },
+
+    // Bad integers
+    { "led abc",				-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "led 12x",				-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "led -",					-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "led +",					-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "led 1.5",				-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "led 2147483648",			-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "led 99999999999",		-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "top -2147483649",		-1,	"Usage: top ",						TEST_NONE },
+    { "led 2147483647",			0,	"Valid command\r\n",				INT32_MAX },
+
+    // Integers that parse but the handler refuses
+    { "led 0",					-1,	"Valid command\r\nDelay must",		TEST_NONE },
+    { "led -2147483648",		-1,	"Valid command\r\nDelay must",		TEST_NONE },
+    { "top -1",					-1,	"Valid command\r\nPeriod must",		TEST_NONE },
+    { "trace 16",				-1,	"Valid command\r\nMask must",		TEST_NONE },
+
+    // Missing and extra arguments
+    { "led",					-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "led 1 2",				-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "led 1 x",				-1,	"Usage: led <blink delay ms>\r\n",	TEST_NONE },
+    { "help me",				-1,	"Usage: help\r\n",					TEST_NONE },
+    { "crit 1",					-1,	"Usage: crit\r\n",					TEST_NONE },
+    { "top 1 2 3 4 5 6 7 8",	-1,	"Usage: top ",						TEST_NONE },
+};
+
+/// What random lines are made of, besides single random bytes
+static const char * const fuzzPieces[] = {
+    "led", "top", "trace", "crit", "help", "l", "t", " ", "  ", "\t", "0", "1", "15", "-", "+",
+    "2147483647", "2147483648", "-2147483648", "99999999999",
+};
+
+/// Valid lines, timed through the parser
+static const char * const timedLines[] = { "led 100", "top 0", "trace 15", "crit" };
+
+static char output[TEST_OUTPUT_SIZE];  ///< Console output of the current case
+static size_t outputLength;
+static int32_t received;  ///< Argument given to the back end, TEST_NONE if none
+static uint32_t lineCount;
+static uint32_t failCount;
+static uint32_t fuzzState = TEST_FUZZ_SEED;  ///< xorshift32
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static int32_t test_Run(const char *line, int32_t length);
+static void test_RunCase(const test_Case *c);
+static void test_Unterminated(void);
+static void test_Command(const char *name, const char *spec);
+static void test_EveryCommand(void);
+static uint32_t test_Random(void);
+static size_t test_RandomLine(char *line, size_t size);
+static void test_Fuzz(void);
+static void test_Throughput(void);
+void assert_triggered(const char *file, uint32_t line);
+
+/******************************************************************************
+* Stubs
+******************************************************************************/
+void dUART_WriteString(const char *string)
+{
+    size_t length = strlen(string);
+
+    if (length > (sizeof(output) - 1 - outputLength)) {
+        length = sizeof(output) - 1 - outputLength;
+    }
+    memcpy(&output[outputLength], string, length);
+    outputLength += length;
+    output[outputLength] = '\0';
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void * const pvItemToQueue, TickType_t xTicksToWait, const BaseType_t xCopyPosition)
+{
+    int delay;
+
+    (void)xQueue;
+    (void)xTicksToWait;
+    (void)xCopyPosition;
+    memcpy(&delay, pvItemToQueue, sizeof(delay));
+    received = delay;
+    return pdTRUE;
+}
+
+void dLog_Write(dLog_Id id, int32_t arg0, int32_t arg1)
+{
+    (void)id;
+    (void)arg0;
+    (void)arg1;
+}
+
+int32_t kLatency_Dump(void)
+{
+    return 0;
+}
+
+int32_t kTop_SetPeriod(uint32_t periodMs)
+{
+    received = (int32_t)periodMs;
+    return 0;
+}
+
+int32_t kTrace_Start(uint8_t mask)
+{
+    received = mask;
+    return 0;
+}
+
+void assert_triggered(const char *file, uint32_t line)
+{
+    printf("FAIL cli_test: configASSERT at %s:%u\n", file, (unsigned int)line);
+    exit(1);
+}
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static int32_t test_Run(const char *line, int32_t length)
+* @brief	Runs one line through CLI_ExtractCmd, from a writable copy
+* @details 	The copy is filled with 'x' past the line, so a parser that
+*			read past length would find no terminator there.
+* @return		Result of CLI_ExtractCmd
+*****************************************************************************/
+static int32_t test_Run(const char *line, int32_t length)
+{
+    char buffer[TEST_LINE_SIZE];
+
+    memset(buffer, 'x', sizeof(buffer));
+    memcpy(buffer, line, strlen(line) + 1);
+    outputLength = 0;
+    output[0] = '\0';
+    received = TEST_NONE;
+    lineCount++;
+    return CLI_ExtractCmd(buffer, length);
+}
+
+/**************************************************************************//**
+* @fn		static void test_RunCase(const test_Case *c)
+* @brief	Runs a table entry and reports what differs
+*****************************************************************************/
+static void test_RunCase(const test_Case *c)
+{
+    int32_t result = test_Run(c->line, TEST_LINE_SIZE);
+
+    if ((result != c->result) || (strncmp(output, c->output, strlen(c->output)) != 0) ||
+        ((c->output[0] == '\0') && (outputLength != 0)) || (received != c->argument)) {
+        failCount++;
+        printf("FAIL cli_test: \"%s\" returned %d, argument %d, output \"%s\"\n",
+               c->line, (int)result, (int)received, output);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_Unterminated(void)
+* @brief	A line that fills the buffer without a terminator is refused
+*			instead of being read past its end
+*****************************************************************************/
+static void test_Unterminated(void)
+{
+    if ((test_Run("led 5", 5) != -1) || (received != TEST_NONE)) {
+        failCount++;
+        printf("FAIL cli_test: unterminated \"led 5\" was accepted\n");
+    }
+    if ((test_Run("led 5", 6) != 0) || (received != 5)) {
+        failCount++;
+        printf("FAIL cli_test: \"led 5\" with its terminator was refused\n");
+    }
+    if ((test_Run("led 5", 0) != -1) || (CLI_ExtractCmd(NULL, TEST_LINE_SIZE) != -1)) {
+        failCount++;
+        printf("FAIL cli_test: NULL or empty input was accepted\n");
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_Command(const char *name, const char *spec)
+* @brief	Runs a command with "0" for each integer and "w" for each word
+*****************************************************************************/
+static void test_Command(const char *name, const char *spec)
+{
+    char line[TEST_LINE_SIZE];
+    size_t length = strlen(name);
+
+    memcpy(line, name, length + 1);
+    for (; *spec != '\0'; spec++) {
+        strcat(line, (*spec == CLI_ARG_INT) ? " 0" : " w");
+    }
+    test_Run(line, TEST_LINE_SIZE);
+    if (strncmp(output, "Valid command\r\n", 15) != 0) {
+        failCount++;
+        printf("FAIL cli_test: \"%s\" from CLI_COMMANDS was not found, output \"%s\"\n", line, output);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_EveryCommand(void)
+* @brief	Every entry of CLI_COMMANDS is found with a valid argument list
+* @details 	Catches an entry the binary search misses, in builds without
+*			the DEBUG order check as well.
+*****************************************************************************/
+static void test_EveryCommand(void)
+{
+#define TEST_COMMAND(name, spec, handler, usage)	test_Command(name, spec);
+    CLI_COMMANDS(TEST_COMMAND)
+#undef TEST_COMMAND
+}
+
+static uint32_t test_Random(void)
+{
+    fuzzState ^= fuzzState << 13;
+    fuzzState ^= fuzzState >> 17;
+    fuzzState ^= fuzzState << 5;
+    return fuzzState;
+}
+
+/**************************************************************************//**
+* @fn		static size_t test_RandomLine(char *line, size_t size)
+* @brief	Fills line with random pieces and bytes, terminator included or not
+* @return		Bytes written, at most size, the length to give the parser
+*****************************************************************************/
+static size_t test_RandomLine(char *line, size_t size)
+{
+    size_t length = 0;
+    size_t target = test_Random() % (size + 1);
+
+    while (length < target) {
+        uint32_t choice = test_Random() % 4;
+
+        if (choice == 0) {
+            line[length++] = (char)test_Random();  // Anything, a NUL included
+        } else {
+            const char *piece = fuzzPieces[test_Random() % (sizeof(fuzzPieces) / sizeof(fuzzPieces[0]))];
+
+            while ((*piece != '\0') && (length < target)) {
+                line[length++] = *piece++;
+            }
+        }
+    }
+    // Usually terminated, as dUART_Task does, sometimes cut at the end of the buffer
+    if ((length < size) && ((test_Random() % 8) != 0)) {
+        line[length++] = '\0';
+    }
+    return length;
+}
+
+/**************************************************************************//**
+* @fn		static void test_Fuzz(void)
+* @brief	Random lines get a result and output the parser can give
+* @details 	Whatever the line, the result is 0 or -1, a back end is only
+*			reached with "Valid command" printed first, and any output is
+*			one of the parser's messages.
+*****************************************************************************/
+static void test_Fuzz(void)
+{
+    char line[TEST_LINE_SIZE];
+    uint32_t failed = 0;
+
+    for (unsigned long i = 0; i < TEST_FUZZ_LINES; i++) {
+        size_t length = test_RandomLine(line, sizeof(line));
+        char *copy = (length > 0) ? malloc(length) : NULL;
+        int32_t result;
+        bool valid;
+
+        if (length > 0) {
+            if (copy == NULL) {
+                printf("FAIL cli_test: out of memory\n");
+                exit(1);
+            }
+            memcpy(copy, line, length);
+        }
+        outputLength = 0;
+        output[0] = '\0';
+        received = TEST_NONE;
+        result = CLI_ExtractCmd(copy, (int32_t)length);
+        valid = (strncmp(output, "Valid command\r\n", 15) == 0);
+        free(copy);
+
+        if (((result != 0) && (result != -1)) || ((result == 0) && !valid) || ((received != TEST_NONE) && !valid) ||
+            ((outputLength != 0) && !valid && (strcmp(output, "Invalid command\r\n") != 0) &&
+             (strncmp(output, "Usage: ", 7) != 0))) {
+            if (failed++ < 10) {
+                printf("FAIL cli_test: random line %lu of %u bytes returned %d, output \"%s\"\n",
+                       i, (unsigned int)length, (int)result, output);
+            }
+        }
+    }
+    failCount += failed;
+    printf("cli_test: %lu random lines from seed 0x%08lX, %u failed\n", TEST_FUZZ_LINES,
+           (unsigned long)TEST_FUZZ_SEED, (unsigned int)failed);
+}
+
+/**************************************************************************//**
+* @fn		static void test_Throughput(void)
+* @brief	Prints how many valid commands per second the parser handles
+* @details 	Each line is copied to a buffer first, as the parser
+*			tokenizes in place. The back ends are the stubs of this file.
+*****************************************************************************/
+static void test_Throughput(void)
+{
+    char buffer[TEST_LINE_SIZE];
+    struct timespec start, end;
+    double seconds;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long i = 0; i < TEST_TIMED_LINES; i++) {
+        const char *line = timedLines[i % (sizeof(timedLines) / sizeof(timedLines[0]))];
+
+        strcpy(buffer, line);
+        outputLength = 0;
+        if (CLI_ExtractCmd(buffer, sizeof(buffer)) != 0) {
+            failCount++;
+            printf("FAIL cli_test: timed \"%s\" failed\n", line);
+            return;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) / 1e9);
+    printf("cli_test: %.0f commands per second\n", TEST_TIMED_LINES / seconds);
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    LEDQueue = (QueueHandle_t)&failCount;  // Any non-NULL handle, the queue is a stub
+
+    for (size_t i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+        test_RunCase(&cases[i]);
+    }
+    test_Unterminated();
+    test_EveryCommand();
+    printf("cli_test: %u lines, %u failed\n", (unsigned int)lineCount, (unsigned int)failCount);
+
+    test_Fuzz();
+    test_Throughput();
+    return (failCount == 0) ? 0 : 1;
+}
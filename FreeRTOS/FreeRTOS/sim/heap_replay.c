@@ -0,0 +1,347 @@
+/**************************************************************************//**
+* @file      heap_replay.c
+* @brief     Host fragmentation benchmark of the FreeRTOS heap
+* @details   Replays an allocation trace against the heap implementation
+*            linked by the firmware, on its own, without the scheduler, and
+*            prints CSV lines:
+*            heap,<metric>,<value>,<unit>
+*            A trace has one operation per line, "a <id> <bytes>" allocates
+*            and "f <id>" frees what allocation <id> returned, # starts a
+*            comment. Without a trace file a built-in workload is replayed:
+*            tasks (TCB and stack), queues, timers and buffers created and
+*            deleted at random, sized as on the SAMD21, at about 70% heap
+*            occupancy. "heap_replay -w" writes that workload as a trace.
+*
+*            Allocations that fail although the free bytes would be enough
+*            are counted as fragmented, they are what a better allocator
+*            avoids. See "make heapbench" in the Makefile.
+* @author    Adi
+* @date      2024-1-13
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define REPLAY_MAX_IDS			4096	// Allocations of a trace live at the same time, ids are below this
+#define REPLAY_MAX_OPS			1000000
+#define REPLAY_WORKLOAD_OPS		200000	// Operations of the built-in workload
+#define REPLAY_OCCUPANCY		70		// Built-in workload target, % of the heap allocated
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+/// One operation of a trace
+typedef struct {
+    uint32_t id;
+    uint32_t size;  ///< 0 frees id
+} replay_Op;
+
+static replay_Op ops[REPLAY_MAX_OPS];
+static uint32_t opCount;
+static void *live[REPLAY_MAX_IDS];  ///< What each id got from pvPortMalloc, NULL if it failed or was freed
+static uint32_t liveSize[REPLAY_MAX_IDS];
+static uint32_t seed = 12345;
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static uint32_t replay_Random(uint32_t range);
+static void replay_Add(uint32_t id, uint32_t size);
+static void replay_Generate(void);
+static int replay_Load(const char *path);
+static void replay_Write(void);
+static void replay_Run(void);
+void vApplicationMallocFailedHook(void);
+void assert_triggered(const char *file, uint32_t line);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static uint32_t replay_Random(uint32_t range)
+* @brief	Deterministic pseudo random number, so every run replays the
+*			same workload
+* @return		0 to range - 1
+*****************************************************************************/
+static uint32_t replay_Random(uint32_t range)
+{
+    seed = (seed * 1103515245UL) + 12345UL;
+    return (seed >> 16) % range;
+}
+
+/**************************************************************************//**
+* @fn		static void replay_Add(uint32_t id, uint32_t size)
+* @brief	Appends an operation to the trace, size 0 frees id
+*****************************************************************************/
+static void replay_Add(uint32_t id, uint32_t size)
+{
+    if (opCount < REPLAY_MAX_OPS) {
+        ops[opCount].id = id;
+        ops[opCount].size = size;
+        opCount++;
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void replay_Generate(void)
+* @brief	Builds the built-in workload
+* @details 	Objects are created while the heap is below REPLAY_OCCUPANCY
+*			and deleted at random otherwise. A task is two allocations, as
+*			in xTaskCreate, that are freed together. Sizes follow the
+*			target: 4 byte stack words and a TCB of about 90 bytes.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+*****************************************************************************/
+static void replay_Generate(void)
+{
+    static const uint32_t stackWords[] = { 100, 128, 130, 160, 200 };
+    uint32_t objectId[REPLAY_MAX_IDS];  // First id of each live object
+    uint8_t objectParts[REPLAY_MAX_IDS];  // Its allocations, 2 for a task
+    uint32_t objectCount = 0;
+    uint32_t used = 0, nextId = 0, budget = (configTOTAL_HEAP_SIZE * REPLAY_OCCUPANCY) / 100;
+    uint32_t i, part, pick;
+
+    for (i = 0; i < REPLAY_WORKLOAD_OPS; i++) {
+        if ((used < budget) && (replay_Random(100) < 60)) {
+            // Ids are recycled once every object is gone, so they stay below REPLAY_MAX_IDS
+            if (nextId >= (REPLAY_MAX_IDS - 2)) {
+                while (objectCount > 0) {
+                    objectCount--;
+                    for (part = 0; part < objectParts[objectCount]; part++) {
+                        replay_Add(objectId[objectCount] + part, 0);
+                    }
+                }
+                used = 0;
+                nextId = 0;
+            }
+
+            objectId[objectCount] = nextId;
+            objectParts[objectCount] = 1;
+            switch (replay_Random(4)) {
+            case 0:
+                liveSize[nextId] = stackWords[replay_Random(sizeof(stackWords) / sizeof(stackWords[0]))] * 4;
+                liveSize[nextId + 1] = 92;
+                objectParts[objectCount] = 2;
+                break;
+            case 1:
+                liveSize[nextId] = 80 + ((1 + replay_Random(16)) * 4);  // Queue_t and its storage, in one block
+                break;
+            case 2:
+                liveSize[nextId] = 44;  // Timer_t
+                break;
+            default:
+                liveSize[nextId] = 8 + replay_Random(256);
+                break;
+            }
+            for (part = 0; part < objectParts[objectCount]; part++) {
+                replay_Add(nextId, liveSize[nextId]);
+                used += liveSize[nextId];
+                nextId++;
+            }
+            objectCount++;
+        } else if (objectCount > 0) {
+            pick = replay_Random(objectCount);
+            for (part = 0; part < objectParts[pick]; part++) {
+                replay_Add(objectId[pick] + part, 0);
+                used -= liveSize[objectId[pick] + part];
+            }
+            objectCount--;
+            objectId[pick] = objectId[objectCount];
+            objectParts[pick] = objectParts[objectCount];
+        }
+    }
+    memset(liveSize, 0, sizeof(liveSize));
+}
+
+/**************************************************************************//**
+* @fn		static int replay_Load(const char *path)
+* @brief	Reads a trace file
+* @return		0, -1 if it cannot be read or has a bad line
+*****************************************************************************/
+static int replay_Load(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char line[128];
+    unsigned int id, size, number = 0;
+
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        number++;
+        if ((line[0] == '#') || (line[0] == '\n')) {
+            continue;
+        }
+        if ((sscanf(line, "a %u %u", &id, &size) == 2) && (id < REPLAY_MAX_IDS) && (size != 0)) {
+            replay_Add(id, size);
+        } else if ((sscanf(line, "f %u", &id) == 1) && (id < REPLAY_MAX_IDS)) {
+            replay_Add(id, 0);
+        } else {
+            fprintf(stderr, "%s:%u: expected \"a <id> <bytes>\" or \"f <id>\", ids below %u\n", path, number, REPLAY_MAX_IDS);
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+/**************************************************************************//**
+* @fn		static void replay_Write(void)
+* @brief	Prints the trace, to be edited and replayed
+*****************************************************************************/
+static void replay_Write(void)
+{
+    uint32_t i;
+
+    printf("# heap_replay built-in workload, %u byte heap\n", (unsigned int)configTOTAL_HEAP_SIZE);
+    for (i = 0; i < opCount; i++) {
+        if (ops[i].size != 0) {
+            printf("a %u %u\n", (unsigned int)ops[i].id, (unsigned int)ops[i].size);
+        } else {
+            printf("f %u\n", (unsigned int)ops[i].id);
+        }
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void replay_Run(void)
+* @brief	Replays the trace and prints the results
+* @details 	The heap statistics are read after each failed allocation,
+*			outside the timed calls. Freeing an id whose allocation failed
+*			is skipped, as the firmware would not have the object either.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+*****************************************************************************/
+static void replay_Run(void)
+{
+    struct timespec start, end;
+    uint64_t elapsed = 0;
+    uint32_t i, allocations = 0, frees = 0, failed = 0, fragmented = 0;
+    size_t usedNow = 0, usedPeak = 0;
+    HeapStats_t stats;
+
+    for (i = 0; i < opCount; i++) {
+        uint32_t id = ops[i].id;
+
+        if (ops[i].size != 0) {
+            if (live[id] != NULL) {
+                continue;  // Allocated twice without a free in between, keep the first
+            }
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            live[id] = pvPortMalloc(ops[i].size);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            allocations++;
+            if (live[id] == NULL) {
+                failed++;
+                if (xPortGetFreeHeapSize() >= ops[i].size) {
+                    fragmented++;
+                }
+            } else {
+                liveSize[id] = ops[i].size;
+                usedNow += ops[i].size;
+                if (usedNow > usedPeak) {
+                    usedPeak = usedNow;
+                }
+            }
+        } else {
+            if (live[id] == NULL) {
+                continue;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            vPortFree(live[id]);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            frees++;
+            live[id] = NULL;
+            usedNow -= liveSize[id];
+        }
+        elapsed += ((uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL) + (uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec;
+    }
+
+    vPortGetHeapStats(&stats);
+    printf("# metric,value,unit\n");
+    printf("heap,size,%u,bytes\n", (unsigned int)configTOTAL_HEAP_SIZE);
+    printf("heap,operations,%u,count\n", (unsigned int)(allocations + frees));
+    printf("heap,per_op,%.1f,ns\n", (allocations + frees) ? ((double)elapsed / (allocations + frees)) : 0.0);
+    printf("heap,allocations,%u,count\n", (unsigned int)allocations);
+    printf("heap,failed,%u,count\n", (unsigned int)failed);
+    printf("heap,failed_fragmented,%u,count\n", (unsigned int)fragmented);
+    printf("heap,peak_requested,%u,bytes\n", (unsigned int)usedPeak);
+    printf("heap,minimum_ever_free,%u,bytes\n", (unsigned int)stats.xMinimumEverFreeBytesRemaining);
+    printf("heap,free_at_end,%u,bytes\n", (unsigned int)stats.xAvailableHeapSpaceInBytes);
+    printf("heap,largest_free_at_end,%u,bytes\n", (unsigned int)stats.xSizeOfLargestFreeBlockInBytes);
+    printf("heap,free_blocks_at_end,%u,count\n", (unsigned int)stats.xNumberOfFreeBlocks);
+    printf("heap,fragmentation_at_end,%.1f,%%\n", stats.xAvailableHeapSpaceInBytes ?
+           (100.0 * (1.0 - ((double)stats.xSizeOfLargestFreeBlockInBytes / stats.xAvailableHeapSpaceInBytes))) : 0.0);
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		void vTaskSuspendAll(void)
+* @brief	Stands in for the kernel, the replay has a single thread
+*****************************************************************************/
+void vTaskSuspendAll(void)
+{
+}
+
+/**************************************************************************//**
+* @fn		BaseType_t xTaskResumeAll(void)
+* @brief	Stands in for the kernel, the replay has a single thread
+*****************************************************************************/
+BaseType_t xTaskResumeAll(void)
+{
+    return pdFALSE;
+}
+
+/**************************************************************************//**
+* @fn		void vApplicationMallocFailedHook(void)
+* @brief	Failed allocations are counted by replay_Run instead
+*****************************************************************************/
+void vApplicationMallocFailedHook(void)
+{
+}
+
+/**************************************************************************//**
+* @fn		void assert_triggered(const char *file, uint32_t line)
+* @brief	configASSERT failure handler, a corrupted heap or a bad free
+*****************************************************************************/
+void assert_triggered(const char *file, uint32_t line)
+{
+    fprintf(stderr, "configASSERT failed at %s:%u\n", file, (unsigned int)line);
+    abort();
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "-w") != 0)) {
+        if (replay_Load(argv[1]) != 0) {
+            return 1;
+        }
+    } else {
+        replay_Generate();
+    }
+
+    if ((argc > 1) && (strcmp(argv[1], "-w") == 0)) {
+        replay_Write();
+    } else {
+        replay_Run();
+    }
+    return 0;
+}
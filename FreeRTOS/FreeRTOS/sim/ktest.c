@@ -0,0 +1,159 @@
+/**************************************************************************//**
+* @file      ktest.c
+* @brief     Harness of the host tests that need the scheduler
+* @details   A test is a task: ktest_Run creates it with a watchdog task
+*            above it, starts the scheduler and returns once the test calls
+*            ktest_End or the watchdog fires. The test creates its helper
+*            tasks and checks what the kernel did with CHECK, which prints
+*            one line per failed check. The kernel hooks and the run time
+*            counter that the simulator configuration asks for are provided
+*            here, so a test links the kernel, this file and nothing of the
+*            firmware. See "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "ktest.h"
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+static const char *testName;
+static TickType_t testTimeout;
+static uint32_t checkCount;
+static uint32_t failCount;
+static bool timedOut;
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void ktest_Watchdog(void *parameter);
+
+// Kernel hooks, declared here as src/main.h has its own for the firmware
+void vApplicationIdleHook(void);
+void vApplicationDaemonTaskStartupHook(void);
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName);
+void vApplicationMallocFailedHook(void);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static void ktest_Watchdog(void *parameter)
+* @brief	Ends a test that has not finished within its timeout
+* @details 	A test that deadlocks would otherwise hang "make test".
+*****************************************************************************/
+static void ktest_Watchdog(void *parameter)
+{
+    (void)parameter;
+
+    vTaskDelay(testTimeout);
+    printf("FAIL %s: timed out after %u ticks\n", testName, (unsigned int)testTimeout);
+    timedOut = true;
+    vTaskEndScheduler();
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		void ktest_Check(bool passed, const char *condition, const char *file, int line)
+* @brief	Counts a check and reports it if it failed
+* @note         Use CHECK, which fills in the text and position
+*****************************************************************************/
+void ktest_Check(bool passed, const char *condition, const char *file, int line)
+{
+    checkCount++;
+    if (!passed) {
+        failCount++;
+        printf("FAIL %s:%d: %s\n", file, line, condition);
+    }
+}
+
+/**************************************************************************//**
+* @fn		int ktest_Run(const char *name, TaskFunction_t test, TickType_t timeout)
+* @brief	Runs a test task under the scheduler
+* @param[in]	name - Printed in the summary
+*				test - Task function of the test, must end with ktest_End
+*				timeout - Ticks the test may take
+* @return		Exit status for main, 1 if a check failed or time ran out
+* @note         Call once, from main
+*****************************************************************************/
+int ktest_Run(const char *name, TaskFunction_t test, TickType_t timeout)
+{
+    testName = name;
+    testTimeout = timeout;
+
+    if ((xTaskCreate(test, "Test", configMINIMAL_STACK_SIZE * 4, NULL, KTEST_PRIORITY, NULL) != pdPASS) ||
+        (xTaskCreate(ktest_Watchdog, "Watch", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, NULL) != pdPASS)) {
+        printf("FAIL %s: cannot create the test tasks\n", name);
+        return 1;
+    }
+    vTaskStartScheduler();
+
+    printf("%s: %u checks, %u failed\n", name, (unsigned int)checkCount, (unsigned int)failCount);
+    return ((failCount == 0) && !timedOut) ? 0 : 1;
+}
+
+/**************************************************************************//**
+* @fn		void ktest_End(void)
+* @brief	Ends the test and lets ktest_Run return
+* @return		Does not return
+* @note         Task context only
+*****************************************************************************/
+void ktest_End(void)
+{
+    vTaskEndScheduler();
+}
+
+/**************************************************************************//**
+* @fn		void assert_triggered(const char *file, uint32_t line)
+* @brief	configASSERT failure handler
+* @return		Does not return
+*****************************************************************************/
+void assert_triggered(const char *file, uint32_t line)
+{
+    printf("FAIL %s: configASSERT failed at %s:%u\n", testName, file, (unsigned int)line);
+    abort();
+}
+
+void kTop_ConfigureTimer(void)
+{
+}
+
+uint32_t kTop_GetCounter(void)
+{
+    return 0;
+}
+
+void kLatency_Record(const void *caller, uint32_t duration)
+{
+    (void)caller;
+    (void)duration;
+}
+
+void vApplicationIdleHook(void)
+{
+}
+
+void vApplicationDaemonTaskStartupHook(void)
+{
+}
+
+void vApplicationMallocFailedHook(void)
+{
+    CHECK(!"heap exhausted");
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+    (void)xTask;
+    printf("FAIL %s: stack overflow in %s\n", testName, pcTaskName);
+    abort();
+}
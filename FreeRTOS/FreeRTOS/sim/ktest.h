@@ -0,0 +1,32 @@
+/**************************************************************************//**
+* @file      ktest.h
+* @brief     Harness of the host tests that need the scheduler
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+#ifndef KTEST_H_
+#define KTEST_H_
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KTEST_PRIORITY		(tskIDLE_PRIORITY + 1)	///< Priority of the test task, helper tasks go above it to run at once
+
+#define CHECK(condition)	ktest_Check((condition), #condition, __FILE__, __LINE__)
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+void ktest_Check(bool passed, const char *condition, const char *file, int line);
+int ktest_Run(const char *name, TaskFunction_t test, TickType_t timeout);
+void ktest_End(void);
+
+#endif /* KTEST_H_ */
@@ -0,0 +1,315 @@
+/**************************************************************************//**
+* @file      queue_batch_test.c
+* @brief     Host test of the batch queue calls
+* @details   Checks xQueueSendMultiple, xQueueReceiveMultiple and their
+*            FromISR versions: a batch moves as many items as fit, in
+*            order, waits only while none can move, unblocks one waiting
+*            task per item moved and posts one queue set entry per item.
+*            Helper tasks run above the test task, so each runs as soon as
+*            it is unblocked. The FromISR calls are made with interrupts
+*            masked, as from an interrupt. See "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include "ktest.h"
+#include "queue.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define BATCH_LENGTH		8
+#define BATCH_WAITERS		3
+#define BATCH_WAIT			3		// Ticks of the timed out calls
+#define BATCH_TIMEOUT		1000	// Ticks, the test takes a few
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+/// What a helper task does and what it got
+typedef struct {
+    uint32_t value[BATCH_LENGTH];  ///< Sent, or received
+    UBaseType_t count;  ///< Items to move
+    BaseType_t result;
+    bool done;
+} batch_Waiter;
+
+static QueueHandle_t queue;
+static batch_Waiter waiters[BATCH_WAITERS];
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void batch_Fill(uint32_t *items, uint32_t first, UBaseType_t count);
+static bool batch_InOrder(const uint32_t *items, uint32_t first, UBaseType_t count);
+static void batch_Sender(void *parameter);
+static void batch_Receiver(void *parameter);
+static void batch_Start(TaskFunction_t job, uint8_t count, UBaseType_t items);
+static void batch_TestPartial(void);
+static void batch_TestTimeout(void);
+static void batch_TestWakesReceivers(void);
+static void batch_TestWakesSenders(void);
+static void batch_TestFromISR(void);
+static void batch_TestQueueSet(void);
+static void batch_Test(void *parameter);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+static void batch_Fill(uint32_t *items, uint32_t first, UBaseType_t count)
+{
+    for (UBaseType_t i = 0; i < count; i++) {
+        items[i] = first + i;
+    }
+}
+
+static bool batch_InOrder(const uint32_t *items, uint32_t first, UBaseType_t count)
+{
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (items[i] != (first + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**************************************************************************//**
+* @fn		static void batch_Sender(void *parameter)
+* @brief	Sends its items in one batch, waiting as long as it takes
+*****************************************************************************/
+static void batch_Sender(void *parameter)
+{
+    batch_Waiter *waiter = (batch_Waiter *)parameter;
+
+    waiter->result = xQueueSendMultiple(queue, waiter->value, waiter->count, portMAX_DELAY);
+    waiter->done = true;
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void batch_Receiver(void *parameter)
+* @brief	Receives up to its count of items, waiting as long as it takes
+*****************************************************************************/
+static void batch_Receiver(void *parameter)
+{
+    batch_Waiter *waiter = (batch_Waiter *)parameter;
+
+    waiter->result = xQueueReceiveMultiple(queue, waiter->value, waiter->count, portMAX_DELAY);
+    waiter->done = true;
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void batch_Start(TaskFunction_t job, uint8_t count, UBaseType_t items)
+* @brief	Creates count helper tasks running job, each blocks at once
+* @details 	Helper i moves items items, sending 100 * (i + 1) onwards.
+*****************************************************************************/
+static void batch_Start(TaskFunction_t job, uint8_t count, UBaseType_t items)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        batch_Fill(waiters[i].value, 100U * (i + 1U), items);
+        waiters[i].count = items;
+        waiters[i].result = -1;
+        waiters[i].done = false;
+        CHECK(xTaskCreate(job, "Waiter", configMINIMAL_STACK_SIZE, &waiters[i], KTEST_PRIORITY + 1, NULL) == pdPASS);
+        CHECK(!waiters[i].done);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void batch_TestPartial(void)
+* @brief	A batch moves what fits, in order, and no more
+*****************************************************************************/
+static void batch_TestPartial(void)
+{
+    uint32_t items[2 * BATCH_LENGTH];
+
+    batch_Fill(items, 0, 2 * BATCH_LENGTH);
+    CHECK(xQueueSendMultiple(queue, items, 5, 0) == 5);
+    CHECK(xQueueSendMultiple(queue, &items[5], 5, 0) == (BATCH_LENGTH - 5));
+    CHECK(xQueueSendMultiple(queue, items, 1, 0) == 0);
+    CHECK(xQueueSendMultiple(queue, items, 0, 0) == 0);
+    CHECK(uxQueueMessagesWaiting(queue) == BATCH_LENGTH);
+
+    batch_Fill(items, 0, 2 * BATCH_LENGTH);
+    CHECK(xQueueReceiveMultiple(queue, items, 3, 0) == 3);
+    CHECK(xQueueReceiveMultiple(queue, &items[3], 2 * BATCH_LENGTH, 0) == (BATCH_LENGTH - 3));
+    CHECK(batch_InOrder(items, 0, BATCH_LENGTH));
+    CHECK(xQueueReceiveMultiple(queue, items, 1, 0) == 0);
+}
+
+/**************************************************************************//**
+* @fn		static void batch_TestTimeout(void)
+* @brief	A batch that cannot move an item waits its time, then moves none
+*****************************************************************************/
+static void batch_TestTimeout(void)
+{
+    uint32_t items[BATCH_LENGTH];
+    TickType_t start = xTaskGetTickCount();
+
+    CHECK(xQueueReceiveMultiple(queue, items, BATCH_LENGTH, BATCH_WAIT) == 0);
+    CHECK((xTaskGetTickCount() - start) >= BATCH_WAIT);
+
+    batch_Fill(items, 0, BATCH_LENGTH);
+    CHECK(xQueueSendMultiple(queue, items, BATCH_LENGTH, 0) == BATCH_LENGTH);
+    start = xTaskGetTickCount();
+    CHECK(xQueueSendMultiple(queue, items, 1, BATCH_WAIT) == 0);
+    CHECK((xTaskGetTickCount() - start) >= BATCH_WAIT);
+    CHECK(xQueueReceiveMultiple(queue, items, BATCH_LENGTH, 0) == BATCH_LENGTH);
+}
+
+/**************************************************************************//**
+* @fn		static void batch_TestWakesReceivers(void)
+* @brief	A batch send unblocks one waiting receiver per item
+* @details 	Three receivers of one item each, then one receiver of a
+*			whole batch, which takes everything sent in one call.
+*****************************************************************************/
+static void batch_TestWakesReceivers(void)
+{
+    uint32_t items[BATCH_LENGTH];
+
+    batch_Start(batch_Receiver, BATCH_WAITERS, 1);
+    batch_Fill(items, 1, BATCH_WAITERS);
+    CHECK(xQueueSendMultiple(queue, items, BATCH_WAITERS, 0) == BATCH_WAITERS);
+    for (uint8_t i = 0; i < BATCH_WAITERS; i++) {
+        CHECK(waiters[i].done && (waiters[i].result == 1) && (waiters[i].value[0] == (i + 1U)));
+    }
+    CHECK(uxQueueMessagesWaiting(queue) == 0);
+
+    batch_Start(batch_Receiver, 1, BATCH_LENGTH);
+    batch_Fill(items, 1, 5);
+    CHECK(xQueueSendMultiple(queue, items, 5, 0) == 5);
+    CHECK(waiters[0].done && (waiters[0].result == 5) && batch_InOrder(waiters[0].value, 1, 5));
+    CHECK(uxQueueMessagesWaiting(queue) == 0);
+}
+
+/**************************************************************************//**
+* @fn		static void batch_TestWakesSenders(void)
+* @brief	A batch receive unblocks one waiting sender per item
+* @details 	Three senders of one item each wait on a full queue, then one
+*			sender of four items, which posts the two that fit once two
+*			are received.
+*****************************************************************************/
+static void batch_TestWakesSenders(void)
+{
+    uint32_t items[BATCH_LENGTH];
+
+    batch_Fill(items, 0, BATCH_LENGTH);
+    CHECK(xQueueSendMultiple(queue, items, BATCH_LENGTH, 0) == BATCH_LENGTH);
+    batch_Start(batch_Sender, BATCH_WAITERS, 1);
+    CHECK(xQueueReceiveMultiple(queue, items, BATCH_WAITERS, 0) == BATCH_WAITERS);
+    CHECK(batch_InOrder(items, 0, BATCH_WAITERS));
+    for (uint8_t i = 0; i < BATCH_WAITERS; i++) {
+        CHECK(waiters[i].done && (waiters[i].result == 1));
+    }
+    CHECK(uxQueueMessagesWaiting(queue) == BATCH_LENGTH);
+
+    // The senders' items follow the rest of the first batch
+    CHECK(xQueueReceiveMultiple(queue, items, BATCH_LENGTH - BATCH_WAITERS, 0) == (BATCH_LENGTH - BATCH_WAITERS));
+    CHECK(batch_InOrder(items, BATCH_WAITERS, BATCH_LENGTH - BATCH_WAITERS));
+    for (uint8_t i = 0; i < BATCH_WAITERS; i++) {
+        CHECK((xQueueReceiveMultiple(queue, items, 1, 0) == 1) && (items[0] == (100U * (i + 1U))));
+    }
+
+    batch_Fill(items, 0, BATCH_LENGTH);
+    CHECK(xQueueSendMultiple(queue, items, BATCH_LENGTH, 0) == BATCH_LENGTH);
+    batch_Start(batch_Sender, 1, 4);
+    CHECK(xQueueReceiveMultiple(queue, items, 2, 0) == 2);
+    CHECK(waiters[0].done && (waiters[0].result == 2));
+    CHECK(xQueueReceiveMultiple(queue, items, BATCH_LENGTH, 0) == BATCH_LENGTH);
+    CHECK(batch_InOrder(items, 2, BATCH_LENGTH - 2) && batch_InOrder(&items[BATCH_LENGTH - 2], 100, 2));
+}
+
+/**************************************************************************//**
+* @fn		static void batch_TestFromISR(void)
+* @brief	The FromISR batches move what fits and report a task to switch to
+*****************************************************************************/
+static void batch_TestFromISR(void)
+{
+    uint32_t items[2 * BATCH_LENGTH];
+    BaseType_t woken = pdFALSE;
+    UBaseType_t mask;
+
+    batch_Fill(items, 0, 2 * BATCH_LENGTH);
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    CHECK(xQueueSendMultipleFromISR(queue, items, 2 * BATCH_LENGTH, &woken) == BATCH_LENGTH);
+    CHECK(xQueueSendMultipleFromISR(queue, items, 1, &woken) == 0);
+    batch_Fill(items, 0, 2 * BATCH_LENGTH);
+    CHECK(xQueueReceiveMultipleFromISR(queue, items, 5, &woken) == 5);
+    CHECK(xQueueReceiveMultipleFromISR(queue, &items[5], 2 * BATCH_LENGTH, &woken) == (BATCH_LENGTH - 5));
+    CHECK(xQueueReceiveMultipleFromISR(queue, items, 1, &woken) == 0);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    CHECK(batch_InOrder(items, 0, BATCH_LENGTH));
+    CHECK(woken == pdFALSE);
+
+    // A receiver above the interrupted task must be switched to
+    batch_Start(batch_Receiver, 1, BATCH_LENGTH);
+    batch_Fill(items, 1, 2);
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    CHECK(xQueueSendMultipleFromISR(queue, items, 2, &woken) == 2);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    CHECK(woken == pdTRUE);
+    taskYIELD();
+    CHECK(waiters[0].done && (waiters[0].result == 2) && batch_InOrder(waiters[0].value, 1, 2));
+}
+
+/**************************************************************************//**
+* @fn		static void batch_TestQueueSet(void)
+* @brief	A batch sent to a member of a queue set posts one entry per item
+*****************************************************************************/
+static void batch_TestQueueSet(void)
+{
+    QueueSetHandle_t set = xQueueCreateSet(BATCH_LENGTH);
+    uint32_t items[BATCH_LENGTH];
+    BaseType_t woken = pdFALSE;
+    UBaseType_t mask;
+
+    CHECK(set != NULL);
+    if ((set == NULL) || (xQueueAddToSet(queue, set) != pdPASS)) {
+        CHECK(!"queue added to the set");
+        return;
+    }
+
+    batch_Fill(items, 0, BATCH_LENGTH);
+    CHECK(xQueueSendMultiple(queue, items, 3, 0) == 3);
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    CHECK(xQueueSendMultipleFromISR(queue, &items[3], 2, &woken) == 2);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    for (uint32_t i = 0; i < 5; i++) {
+        CHECK(xQueueSelectFromSet(set, 0) == queue);
+        CHECK((xQueueReceiveMultiple(queue, items, 1, 0) == 1) && (items[0] == i));
+    }
+    CHECK(xQueueSelectFromSet(set, 0) == NULL);
+
+    CHECK(xQueueRemoveFromSet(queue, set) == pdPASS);
+    vQueueDelete(set);
+}
+
+static void batch_Test(void *parameter)
+{
+    (void)parameter;
+
+    queue = xQueueCreate(BATCH_LENGTH, sizeof(uint32_t));
+    CHECK(queue != NULL);
+    if (queue != NULL) {
+        batch_TestPartial();
+        batch_TestTimeout();
+        batch_TestWakesReceivers();
+        batch_TestWakesSenders();
+        batch_TestFromISR();
+        batch_TestQueueSet();
+    }
+    ktest_End();
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    return ktest_Run("queue_batch_test", batch_Test, BATCH_TIMEOUT);
+}
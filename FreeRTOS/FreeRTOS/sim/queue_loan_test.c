@@ -0,0 +1,244 @@
+/**************************************************************************//**
+* @file      queue_loan_test.c
+* @brief     Host test of the wake-ups at the end of a queue loan
+* @details   While a slot is on loan, other tasks that send to or receive
+*            from the queue block even though the queue has room or items.
+*            Several of them wait behind one loan here, at a priority above
+*            the test task so that each runs as soon as it is unblocked, and
+*            the test checks that the commit or release lets every one go
+*            on that the queue can serve, not just the first. Built with
+*            configUSE_QUEUE_LOANS, see "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include "ktest.h"
+#include "queue.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define LOAN_LENGTH			4
+#define LOAN_WAITERS		3		// Tasks blocked behind one loan, LOAN_LENGTH - 1 so all fit
+#define LOAN_WORDS			8		// A large item, as loans are meant for
+#define LOAN_TIMEOUT		1000	// Ticks, the test takes a few
+
+#if (configUSE_QUEUE_LOANS != 1)
+#error queue_loan_test needs configUSE_QUEUE_LOANS
+#endif
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+typedef struct {
+    uint32_t word[LOAN_WORDS];
+} loan_Item;
+
+/// What a helper task does and what it got
+typedef struct {
+    uint32_t value;  ///< Sent, or received
+    bool done;
+} loan_Waiter;
+
+static QueueHandle_t queue;
+static loan_Waiter waiters[LOAN_WAITERS];
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void loan_Fill(loan_Item *item, uint32_t value);
+static void loan_Sender(void *parameter);
+static void loan_FrontSender(void *parameter);
+static void loan_Receiver(void *parameter);
+static void loan_StartWaiters(TaskFunction_t job);
+static uint8_t loan_CountDone(void);
+static void loan_TestCommitWakesSenders(void);
+static void loan_TestReleaseWakesReceivers(void);
+static void loan_TestReleaseWakesSenders(void);
+static void loan_Test(void *parameter);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+static void loan_Fill(loan_Item *item, uint32_t value)
+{
+    for (uint8_t i = 0; i < LOAN_WORDS; i++) {
+        item->word[i] = value;
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void loan_Sender(void *parameter)
+* @brief	Sends its value to the back of the queue, waiting as long as it takes
+*****************************************************************************/
+static void loan_Sender(void *parameter)
+{
+    loan_Waiter *waiter = (loan_Waiter *)parameter;
+    loan_Item item;
+
+    loan_Fill(&item, waiter->value);
+    (void)xQueueSendToBack(queue, &item, portMAX_DELAY);
+    waiter->done = true;
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void loan_FrontSender(void *parameter)
+* @brief	Sends its value to the front of the queue, which a receive loan blocks
+*****************************************************************************/
+static void loan_FrontSender(void *parameter)
+{
+    loan_Waiter *waiter = (loan_Waiter *)parameter;
+    loan_Item item;
+
+    loan_Fill(&item, waiter->value);
+    (void)xQueueSendToFront(queue, &item, portMAX_DELAY);
+    waiter->done = true;
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void loan_Receiver(void *parameter)
+* @brief	Receives one item, waiting as long as it takes
+*****************************************************************************/
+static void loan_Receiver(void *parameter)
+{
+    loan_Waiter *waiter = (loan_Waiter *)parameter;
+    loan_Item item;
+
+    (void)xQueueReceive(queue, &item, portMAX_DELAY);
+    waiter->value = item.word[LOAN_WORDS - 1];
+    waiter->done = true;
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void loan_StartWaiters(TaskFunction_t job)
+* @brief	Creates LOAN_WAITERS tasks running job, each blocks at once
+* @details 	Sender i sends 100 + i, so the order the items arrive in shows
+*			which sender went first.
+*****************************************************************************/
+static void loan_StartWaiters(TaskFunction_t job)
+{
+    for (uint8_t i = 0; i < LOAN_WAITERS; i++) {
+        waiters[i].value = 100U + i;
+        waiters[i].done = false;
+        CHECK(xTaskCreate(job, "Waiter", configMINIMAL_STACK_SIZE, &waiters[i], KTEST_PRIORITY + 1, NULL) == pdPASS);
+        CHECK(!waiters[i].done);
+    }
+}
+
+static uint8_t loan_CountDone(void)
+{
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < LOAN_WAITERS; i++) {
+        count += waiters[i].done ? 1 : 0;
+    }
+    return count;
+}
+
+/**************************************************************************//**
+* @fn		static void loan_TestCommitWakesSenders(void)
+* @brief	A commit lets every sender that waited for it go on
+*****************************************************************************/
+static void loan_TestCommitWakesSenders(void)
+{
+    loan_Item item;
+    loan_Item *slot = (loan_Item *)pvQueueLoanSend(queue, 0);
+
+    CHECK(slot != NULL);
+    loan_StartWaiters(loan_Sender);
+    CHECK(uxQueueMessagesWaiting(queue) == 0);
+
+    loan_Fill(slot, 1);
+    vQueueCommitSend(queue);
+    CHECK(loan_CountDone() == LOAN_WAITERS);
+    CHECK(uxQueueMessagesWaiting(queue) == LOAN_LENGTH);
+
+    // The loaned item first, then the senders in the order they blocked
+    CHECK((xQueueReceive(queue, &item, 0) == pdPASS) && (item.word[0] == 1));
+    for (uint8_t i = 0; i < LOAN_WAITERS; i++) {
+        CHECK((xQueueReceive(queue, &item, 0) == pdPASS) && (item.word[0] == 100U + i));
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void loan_TestReleaseWakesReceivers(void)
+* @brief	A release lets one waiting receiver go on per item left
+* @details 	Two items stay after the loaned one, so two of the three
+*			receivers get one and the third waits for the next send.
+*****************************************************************************/
+static void loan_TestReleaseWakesReceivers(void)
+{
+    loan_Item item;
+    const loan_Item *head;
+
+    for (uint32_t value = 1; value <= 3; value++) {
+        loan_Fill(&item, value);
+        CHECK(xQueueSendToBack(queue, &item, 0) == pdPASS);
+    }
+    head = (const loan_Item *)pvQueueLoanReceive(queue, 0);
+    CHECK((head != NULL) && (head->word[0] == 1));
+    loan_StartWaiters(loan_Receiver);
+
+    vQueueReleaseReceive(queue);
+    CHECK(loan_CountDone() == 2);
+    CHECK(waiters[0].done && (waiters[0].value == 2));
+    CHECK(waiters[1].done && (waiters[1].value == 3));
+    CHECK(!waiters[2].done);
+
+    loan_Fill(&item, 4);
+    CHECK(xQueueSendToBack(queue, &item, 0) == pdPASS);
+    CHECK(waiters[2].done && (waiters[2].value == 4));
+    CHECK(uxQueueMessagesWaiting(queue) == 0);
+}
+
+/**************************************************************************//**
+* @fn		static void loan_TestReleaseWakesSenders(void)
+* @brief	A release lets every sender to the front that waited for it go on
+*****************************************************************************/
+static void loan_TestReleaseWakesSenders(void)
+{
+    loan_Item item;
+
+    loan_Fill(&item, 1);
+    CHECK(xQueueSendToBack(queue, &item, 0) == pdPASS);
+    CHECK(pvQueueLoanReceive(queue, 0) != NULL);
+    loan_StartWaiters(loan_FrontSender);
+
+    vQueueReleaseReceive(queue);
+    CHECK(loan_CountDone() == LOAN_WAITERS);
+    CHECK(uxQueueMessagesWaiting(queue) == LOAN_WAITERS);
+
+    // Each sent to the front, so the last one to go is at the head
+    for (uint8_t i = LOAN_WAITERS; i > 0; i--) {
+        CHECK((xQueueReceive(queue, &item, 0) == pdPASS) && (item.word[0] == 100U + i - 1U));
+    }
+}
+
+static void loan_Test(void *parameter)
+{
+    (void)parameter;
+
+    queue = xQueueCreate(LOAN_LENGTH, sizeof(loan_Item));
+    CHECK(queue != NULL);
+    if (queue != NULL) {
+        loan_TestCommitWakesSenders();
+        loan_TestReleaseWakesReceivers();
+        loan_TestReleaseWakesSenders();
+    }
+    ktest_End();
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    return ktest_Run("queue_loan_test", loan_Test, LOAN_TIMEOUT);
+}
@@ -0,0 +1,210 @@
+/**************************************************************************//**
+* @file      rtc_tick_test.c
+* @brief     Host unit test of the RTC tick arithmetic of the Cortex-M0 port
+* @details   Checks the functions of portrtc.h, which the target's tick
+*            interrupt and tickless idle use, against 64-bit arithmetic:
+*            tick n must be at count (n * configRTC_CLOCK_HZ) /
+*            configTICK_RATE_HZ, modulo 2^32, whether the ticks come one
+*            at a time or are passed over in a sleep, and across the wrap
+*            of the counter. A sleep is capped at portMAX_SUPPRESSED_TICKS
+*            and may overrun its compare by as much again, plus
+*            portRTC_MIN_LEAD, the headroom the wake-up arithmetic must hold
+*            without overflow. Prints one line
+*            per failed check and a summary, exits with 1 if any check
+*            failed. Built for the default 32768 Hz RTC and an odd one, see
+*            "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "portable/GCC/ARM_CM0/portrtc.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define TEST_HZ				((uint64_t)configRTC_CLOCK_HZ)
+#define TEST_RATE			((uint64_t)configTICK_RATE_HZ)
+#define TEST_STEPS			200000UL	// Ticks counted one at a time, over 3 minutes at 1 kHz
+#define TEST_WRAP_TICK		((((1ULL << 32) * TEST_RATE) / TEST_HZ) - 1000ULL)  // A second before the counter wraps
+
+#define CHECK(condition)	test_Check((condition), #condition, __LINE__)
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+/// Ticks the tests start from: the first tick after reset, a later one, and one just before the wrap
+static const uint64_t startTicks[] = { 1, 12345, TEST_WRAP_TICK };
+
+static uint32_t checkCount;
+static uint32_t failCount;
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void test_Check(bool passed, const char *condition, int line);
+static uint64_t test_TickTime(uint64_t tick);
+static void test_NextTick(void);
+static void test_TickAfter(void);
+static void test_PassTicks(uint64_t tick, uint64_t now);
+static void test_Sleeps(void);
+static void test_Headroom(void);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static void test_Check(bool passed, const char *condition, int line)
+* @brief	Counts a check and reports it if it failed
+*****************************************************************************/
+static void test_Check(bool passed, const char *condition, int line)
+{
+    checkCount++;
+    if (!passed) {
+        failCount++;
+        printf("FAIL rtc_tick_test.c:%d: %s\n", line, condition);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static uint64_t test_TickTime(uint64_t tick)
+* @brief	Exact RTC count of a tick, without the wrap of the counter
+*****************************************************************************/
+static uint64_t test_TickTime(uint64_t tick)
+{
+    return (tick * TEST_HZ) / TEST_RATE;
+}
+
+/**************************************************************************//**
+* @fn		static void test_NextTick(void)
+* @brief	Ticks counted one at a time, as the tick interrupt does, never drift
+*****************************************************************************/
+static void test_NextTick(void)
+{
+    for (uint8_t i = 0; i < (sizeof(startTicks) / sizeof(startTicks[0])); i++) {
+        uint64_t tick = startTicks[i];
+        uint32_t count = (uint32_t)test_TickTime(tick);
+        uint32_t fraction = (uint32_t)((tick * TEST_HZ) % TEST_RATE);
+        uint32_t drifted = 0;
+
+        for (uint32_t step = 0; step < TEST_STEPS; step++) {
+            vPortRtcNextTick(&count, &fraction);
+            tick++;
+            if ((count != (uint32_t)test_TickTime(tick)) || (fraction != (uint32_t)((tick * TEST_HZ) % TEST_RATE))) {
+                drifted++;
+            }
+        }
+        CHECK(drifted == 0);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_TickAfter(void)
+* @brief	The sleep compare is the exact count of the tick it is set for
+*****************************************************************************/
+static void test_TickAfter(void)
+{
+    static const TickType_t idleTicks[] = { 1, 2, 3, 999, 1000, 1001, 54321, portMAX_SUPPRESSED_TICKS };
+
+    for (uint8_t i = 0; i < (sizeof(startTicks) / sizeof(startTicks[0])); i++) {
+        uint64_t tick = startTicks[i];
+        uint32_t count = (uint32_t)test_TickTime(tick);
+        uint32_t fraction = (uint32_t)((tick * TEST_HZ) % TEST_RATE);
+
+        for (uint8_t j = 0; j < (sizeof(idleTicks) / sizeof(idleTicks[0])); j++) {
+            // vPortSuppressTicksAndSleep wakes on the last tick of the sleep
+            TickType_t ticks = idleTicks[j] - 1;
+
+            CHECK(ulPortRtcTickAfter(count, fraction, ticks) == (uint32_t)test_TickTime(tick + ticks));
+        }
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_PassTicks(uint64_t tick, uint64_t now)
+* @brief	Checks ulPortRtcPassTicks for the next tick and a count, both exact
+* @param[in]	tick - Next tick
+*				now - Count on wake-up, at most a little before the next
+*				tick's
+*****************************************************************************/
+static void test_PassTicks(uint64_t tick, uint64_t now)
+{
+    uint32_t count = (uint32_t)test_TickTime(tick);
+    uint32_t fraction = (uint32_t)((tick * TEST_HZ) % TEST_RATE);
+    // The first tick after now is the first whose count is above it
+    uint64_t after = (((now + 1) * TEST_RATE) + TEST_HZ - 1) / TEST_HZ;
+    uint64_t passed = (after > tick) ? (after - tick) : 0;
+
+    CHECK(ulPortRtcPassTicks(&count, &fraction, (uint32_t)now) == passed);
+    CHECK(count == (uint32_t)test_TickTime(tick + passed));
+    CHECK(fraction == (uint32_t)(((tick + passed) * TEST_HZ) % TEST_RATE));
+}
+
+/**************************************************************************//**
+* @fn		static void test_Sleeps(void)
+* @brief	Sleeps of every length up to twice the cap count the ticks that passed
+* @details 	The wake-up count is taken around each tick of the sleep, so
+*			both the tick just passed and the one just ahead are tried.
+*			Also a wake-up before the next tick, as the minimum lead can
+*			give, which must pass none.
+*****************************************************************************/
+static void test_Sleeps(void)
+{
+    for (uint8_t i = 0; i < (sizeof(startTicks) / sizeof(startTicks[0])); i++) {
+        uint64_t tick = startTicks[i];
+
+        test_PassTicks(tick, test_TickTime(tick) - 1);
+        if (test_TickTime(tick) >= 100) {
+            test_PassTicks(tick, test_TickTime(tick) - 100);
+        }
+        for (uint64_t ticks = 0; ticks <= 2ULL * portMAX_SUPPRESSED_TICKS; ticks += (ticks < 2000) ? 1 : 997) {
+            uint64_t time = test_TickTime(tick + ticks);
+
+            test_PassTicks(tick, time - 1);
+            test_PassTicks(tick, time);
+            test_PassTicks(tick, time + 1);
+        }
+        // The longest sleep, overrun by as much again, with the lead vPortSuppressTicksAndSleep adds
+        test_PassTicks(tick, test_TickTime(tick + (2ULL * portMAX_SUPPRESSED_TICKS)) + portRTC_MIN_LEAD);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void test_Headroom(void)
+* @brief	The cap leaves room for a sleep to overrun its compare by as much again
+* @details 	ulPortRtcPassTicks multiplies the counts since the next tick
+*			by configTICK_RATE_HZ. Twice the longest sleep and the lead
+*			must fit in 32 bits, four times the sleep must not, or the cap
+*			wastes range.
+*****************************************************************************/
+static void test_Headroom(void)
+{
+    uint64_t counts = (test_TickTime(2ULL * portMAX_SUPPRESSED_TICKS) + portRTC_MIN_LEAD + 1) * TEST_RATE;
+
+    CHECK(counts <= UINT32_MAX);
+    CHECK(((test_TickTime(4ULL * portMAX_SUPPRESSED_TICKS) + 1) * TEST_RATE) > UINT32_MAX);
+    CHECK(((uint64_t)portMAX_SUPPRESSED_TICKS * TEST_HZ) <= UINT32_MAX);  // ulPortRtcTickAfter
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    test_NextTick();
+    test_TickAfter();
+    test_Sleeps();
+    test_Headroom();
+
+    printf("rtc_tick_test (%lu Hz RTC, %lu Hz tick, longest sleep %lu ticks): %u checks, %u failed\n",
+           (unsigned long)configRTC_CLOCK_HZ, (unsigned long)configTICK_RATE_HZ, (unsigned long)portMAX_SUPPRESSED_TICKS,
+           (unsigned int)checkCount, (unsigned int)failCount);
+    return (failCount == 0) ? 0 : 1;
+}
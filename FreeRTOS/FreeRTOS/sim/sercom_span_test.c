@@ -0,0 +1,206 @@
+/**************************************************************************//**
+* @file      sercom_span_test.c
+* @brief     Host test of the write jobs dUART.c gives the console SERCOM
+* @details   Runs the console driver on the simulated SERCOM of asf_sim.c,
+*            which counts write jobs and the interrupts that complete them.
+*            A message must go out as one contiguous span of cbufTx, so one
+*            job and one interrupt, or two where it wraps the end of the
+*            ring, and messages queued while a job runs must be chained
+*            into the next job together. Sending a character per job, as
+*            before spans, costs a job and an interrupt per byte. The text
+*            itself goes to /dev/null. Built with KTEST, so ktest.c handles
+*            configASSERT, see "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <asf.h>
+#include "ktest.h"
+#include "SerialConsole/CLI.h"
+#include "SerialConsole/dUART.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define SPAN_RING_SIZE		512		// TX_BUFFER_SIZE of dUART.c
+#define SPAN_LINE			100		// A long log line
+#define SPAN_BURST			5		// Messages written while a job runs
+#define SPAN_BURST_LENGTH	20
+#define SPAN_WAIT_TICKS		100		// For the simulated interrupts to drain cbufTx
+#define SPAN_TIMEOUT		1000	// Ticks, the test takes a few
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+static uint8_t message[SPAN_RING_SIZE];
+static int savedStdout = -1;  ///< stdout while the SERCOM writes to /dev/null
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void span_Mute(bool mute);
+static void span_Send(size_t length, sim_SercomStats *sent);
+static void span_TestLine(void);
+static void span_TestWrap(void);
+static void span_TestBurst(void);
+static void span_Test(void *parameter);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static void span_Mute(bool mute)
+* @brief	Sends the SERCOM's output to /dev/null, or back to stdout
+* @note         Checks must not fail while muted, their report would be lost
+*****************************************************************************/
+static void span_Mute(bool mute)
+{
+    fflush(stdout);
+    if (mute) {
+        int null = open("/dev/null", O_WRONLY);
+
+        savedStdout = dup(STDOUT_FILENO);
+        if (null >= 0) {
+            dup2(null, STDOUT_FILENO);
+            close(null);
+        }
+    } else if (savedStdout >= 0) {
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+        savedStdout = -1;
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void span_Send(size_t length, sim_SercomStats *sent)
+* @brief	Writes one message and waits until it has been transmitted
+* @param[in]	length - Bytes of message to write
+* @param[out]	sent - Write jobs, interrupts and bytes the message took
+*****************************************************************************/
+static void span_Send(size_t length, sim_SercomStats *sent)
+{
+    sim_SercomStats before;
+
+    sim_GetSercomStats(&before);
+    span_Mute(true);
+    dUART_WriteBuffer(message, length);
+    for (uint8_t i = 0; (i < SPAN_WAIT_TICKS) && !dUART_IsTxEmpty(); i++) {
+        vTaskDelay(1);
+    }
+    span_Mute(false);
+    sim_GetSercomStats(sent);
+    sent->writeJobs -= before.writeJobs;
+    sent->txInterrupts -= before.txInterrupts;
+    sent->txBytes -= before.txBytes;
+}
+
+/**************************************************************************//**
+* @fn		static void span_TestLine(void)
+* @brief	A line that fits before the end of the ring takes one job
+*****************************************************************************/
+static void span_TestLine(void)
+{
+    sim_SercomStats sent;
+
+    span_Send(SPAN_LINE, &sent);
+    CHECK(dUART_IsTxEmpty());
+    CHECK(sent.txBytes == SPAN_LINE);
+    CHECK(sent.writeJobs == 1);
+    CHECK(sent.txInterrupts == 1);
+}
+
+/**************************************************************************//**
+* @fn		static void span_TestWrap(void)
+* @brief	A line across the end of the ring takes two jobs, one per span
+* @details 	Follows span_TestLine, so the ring starts at SPAN_LINE and a
+*			message that ends SPAN_LINE / 2 before its end leaves the
+*			next line across it.
+*****************************************************************************/
+static void span_TestWrap(void)
+{
+    sim_SercomStats sent;
+    size_t fill = SPAN_RING_SIZE - SPAN_LINE - (SPAN_LINE / 2);
+
+    span_Send(fill, &sent);
+    CHECK((sent.txBytes == fill) && (sent.writeJobs == 1) && (sent.txInterrupts == 1));
+
+    span_Send(SPAN_LINE, &sent);
+    CHECK(dUART_IsTxEmpty());
+    CHECK(sent.txBytes == SPAN_LINE);
+    CHECK(sent.writeJobs == 2);
+    CHECK(sent.txInterrupts == 2);
+}
+
+/**************************************************************************//**
+* @fn		static void span_TestBurst(void)
+* @brief	Messages written while a job runs go out together in the next one
+* @details 	The critical section holds the SERCOM interrupt off, as a busy
+*			line does on the target: the first message starts a job and
+*			the others wait in cbufTx until its callback chains them.
+*****************************************************************************/
+static void span_TestBurst(void)
+{
+    sim_SercomStats before, sent;
+
+    sim_GetSercomStats(&before);
+    span_Mute(true);
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < SPAN_BURST; i++) {
+        dUART_WriteBuffer(&message[i * SPAN_BURST_LENGTH], SPAN_BURST_LENGTH);
+    }
+    taskEXIT_CRITICAL();
+    for (uint8_t i = 0; (i < SPAN_WAIT_TICKS) && !dUART_IsTxEmpty(); i++) {
+        vTaskDelay(1);
+    }
+    span_Mute(false);
+    sim_GetSercomStats(&sent);
+
+    CHECK(dUART_IsTxEmpty());
+    CHECK((sent.txBytes - before.txBytes) == (SPAN_BURST * SPAN_BURST_LENGTH));
+    CHECK((sent.writeJobs - before.writeJobs) == 2);
+    CHECK((sent.txInterrupts - before.txInterrupts) == 2);
+}
+
+static void span_Test(void *parameter)
+{
+    (void)parameter;
+
+    for (size_t i = 0; i < sizeof(message); i++) {
+        message[i] = (uint8_t)('a' + (i % 26));
+    }
+    dUART_Initialize();
+
+    span_TestLine();
+    span_TestWrap();
+    span_TestBurst();
+    CHECK(dUART_GetDroppedCount() == 0);
+
+    dUART_Deinitialize();
+    ktest_End();
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		int32_t CLI_ExtractCmd(char * cmd, int32_t length)
+* @brief	Stands in for the CLI, dUART_Task does not run here
+*****************************************************************************/
+int32_t CLI_ExtractCmd(char *cmd, int32_t length)
+{
+    (void)cmd;
+    (void)length;
+    return 0;
+}
+
+int main(void)
+{
+    return ktest_Run("sercom_span_test", span_Test, SPAN_TIMEOUT);
+}
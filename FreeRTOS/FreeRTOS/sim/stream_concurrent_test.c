@@ -0,0 +1,497 @@
+/**************************************************************************//**
+* @file      stream_concurrent_test.c
+* @brief     Host test of concurrent stream and message buffers
+* @details   Writer and reader tasks of one priority share a buffer while a
+*            host thread raises a simulated interrupt at random moments
+*            that switches to the next of them, so a task is preempted
+*            between reserving and committing as well as anywhere else.
+*            Through a message buffer, several writers send numbered
+*            messages of varying length to two readers: each message must
+*            arrive once, whole, unchanged and, per writer and reader, in
+*            order. Through a stream buffer, several writers send fixed
+*            records to one reader that takes random amounts: the stream
+*            must be the records back to back, none split or interleaved.
+*            A reader that gets nothing for SC_STALL stops the phase, as
+*            data lost from the buffer would leave every task waiting.
+*            Then a send that cannot fit times out without writing, a
+*            message too long for the reader stays in the buffer, and an
+*            idle buffer resets. See "make test" in the Makefile.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ktest.h"
+#include "message_buffer.h"
+#include "stream_buffer.h"
+
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define SC_WRITERS			4
+#define SC_READERS			2
+#define SC_MESSAGES			3000	// Per writer
+#define SC_PAYLOAD_MAX		40		// Message payloads are 0 to this many bytes
+#define SC_BUFFER_SIZE		256
+#define SC_RECORD_SIZE		16		// Stream records
+#define SC_READ_MAX			40		// Largest read of the stream reader
+#define SC_POLL				10		// Ticks between two looks of the test task at its helpers
+#define SC_STALL			100		// Ticks a reader may go without data, far more than a writer needs
+#define SC_WAIT				3		// Ticks of the timed out send
+#define SC_SIGNAL			SIGUSR1	// Simulated interrupt that switches task
+#define SC_RAISE_MAX_US		50		// Longest pause between two switches
+#define SC_TIMEOUT			5000	// Ticks, the test takes a fraction of one second
+
+#if (configUSE_CONCURRENT_STREAM_BUFFERS != 1)
+#error stream_concurrent_test needs configUSE_CONCURRENT_STREAM_BUFFERS
+#endif
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+/// Head of each message, the payload follows
+typedef struct {
+    uint16_t writer;
+    uint16_t length;  ///< Of the payload
+    uint32_t sequence;
+} sc_Header;
+
+static StreamBufferHandle_t buffer;  ///< Shared by the tasks of the running phase
+static volatile uint8_t tasksDone;  ///< Writers and readers that have finished
+static volatile bool switching;  ///< Keeps the raising thread going
+static volatile bool stalled;  ///< A receive waited out SC_STALL, the phase has stopped
+
+static uint8_t seen[SC_WRITERS][SC_MESSAGES];  ///< Times each message was received
+static volatile uint32_t messagesReceived;
+static volatile uint32_t corrupt;  ///< Messages or records that came out wrong
+static volatile uint32_t disorders;  ///< Messages or records out of order
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static uint32_t sc_Random(uint32_t *state);
+static uint8_t sc_Byte(uint32_t writer, uint32_t sequence, uint32_t index);
+static void sc_Switch(void);
+static void *sc_Raise(void *parameter);
+static bool sc_StartRaising(pthread_t *raiser);
+static void sc_StopRaising(pthread_t raiser);
+static void sc_MessageWriter(void *parameter);
+static void sc_MessageReader(void *parameter);
+static void sc_RecordWriter(void *parameter);
+static void sc_RecordReader(void *parameter);
+static void sc_Stalled(TickType_t since);
+static bool sc_WaitForTasks(uint8_t count);
+static bool sc_TestMessages(void);
+static bool sc_TestStream(void);
+static void sc_TestLimits(void);
+static void sc_Test(void *parameter);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+static uint32_t sc_Random(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/**************************************************************************//**
+* @fn		static uint8_t sc_Byte(uint32_t writer, uint32_t sequence, uint32_t index)
+* @brief	Content of byte index of a payload or record, so any byte shows who sent it
+*****************************************************************************/
+static uint8_t sc_Byte(uint32_t writer, uint32_t sequence, uint32_t index)
+{
+    return (uint8_t)((writer * 61U) + (sequence * 7U) + index);
+}
+
+/**************************************************************************//**
+* @fn		static void sc_Switch(void)
+* @brief	Simulated interrupt that switches to the next ready task
+*****************************************************************************/
+static void sc_Switch(void)
+{
+    portYIELD_FROM_ISR(pdTRUE);
+}
+
+/**************************************************************************//**
+* @fn		static void *sc_Raise(void *parameter)
+* @brief	Host thread that raises sc_Switch at random moments
+* @note         Created with the simulated interrupts blocked, which it keeps
+*****************************************************************************/
+static void *sc_Raise(void *parameter)
+{
+    uint32_t random = 0x2468ACE1UL;
+
+    (void)parameter;
+    while (switching) {
+        struct timespec pause = { 0, (long)(sc_Random(&random) % (SC_RAISE_MAX_US + 1)) * 1000L };
+
+        vPortGenerateSimulatedInterrupt(SC_SIGNAL);
+        nanosleep(&pause, NULL);
+    }
+    return NULL;
+}
+
+static bool sc_StartRaising(pthread_t *raiser)
+{
+    bool started;
+
+    switching = true;
+    taskENTER_CRITICAL();
+    started = (pthread_create(raiser, NULL, sc_Raise, NULL) == 0);
+    taskEXIT_CRITICAL();
+    CHECK(started);
+    return started;
+}
+
+static void sc_StopRaising(pthread_t raiser)
+{
+    switching = false;
+    pthread_join(raiser, NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void sc_MessageWriter(void *parameter)
+* @brief	Sends SC_MESSAGES numbered messages of varying length
+* @param[in]	parameter - Number of the writer
+*****************************************************************************/
+static void sc_MessageWriter(void *parameter)
+{
+    uint32_t writer = (uint32_t)(uintptr_t)parameter;
+    uint32_t random = 0x9E3779B9UL * (writer + 1U);
+    uint8_t message[sizeof(sc_Header) + SC_PAYLOAD_MAX];
+    sc_Header header;
+
+    header.writer = (uint16_t)writer;
+    for (uint32_t sequence = 0; sequence < SC_MESSAGES; sequence++) {
+        header.sequence = sequence;
+        header.length = (uint16_t)(sc_Random(&random) % (SC_PAYLOAD_MAX + 1));
+        memcpy(message, &header, sizeof(header));
+        for (uint32_t i = 0; i < header.length; i++) {
+            message[sizeof(header) + i] = sc_Byte(writer, sequence, i);
+        }
+        if (xMessageBufferSend(buffer, message, sizeof(header) + header.length, portMAX_DELAY) != (sizeof(header) + header.length)) {
+            corrupt++;
+        }
+    }
+    taskENTER_CRITICAL();
+    tasksDone++;
+    taskEXIT_CRITICAL();
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void sc_MessageReader(void *parameter)
+* @brief	Receives and checks messages until all of them have arrived
+*****************************************************************************/
+static void sc_MessageReader(void *parameter)
+{
+    int64_t last[SC_WRITERS];
+    uint8_t message[sizeof(sc_Header) + SC_PAYLOAD_MAX];
+    sc_Header header;
+    TickType_t since = xTaskGetTickCount();
+
+    (void)parameter;
+    for (uint8_t i = 0; i < SC_WRITERS; i++) {
+        last[i] = -1;
+    }
+    while (!stalled && (messagesReceived < (SC_WRITERS * SC_MESSAGES))) {
+        size_t length = xMessageBufferReceive(buffer, message, sizeof(message), SC_STALL);
+        bool whole = true;
+
+        if (length == 0) {
+            // Also where a bad length makes the next message too long for
+            // message, which returns at once and leaves it in the buffer
+            if (messagesReceived < (SC_WRITERS * SC_MESSAGES)) {
+                sc_Stalled(since);
+            }
+            continue;
+        }
+        since = xTaskGetTickCount();
+        memcpy(&header, message, sizeof(header));
+        if ((length < sizeof(header)) || (header.writer >= SC_WRITERS) || (header.sequence >= SC_MESSAGES) ||
+            (length != (sizeof(header) + header.length))) {
+            taskENTER_CRITICAL();
+            corrupt++;
+            messagesReceived++;
+            taskEXIT_CRITICAL();
+            continue;
+        }
+        for (uint32_t i = 0; i < header.length; i++) {
+            whole = whole && (message[sizeof(header) + i] == sc_Byte(header.writer, header.sequence, i));
+        }
+
+        taskENTER_CRITICAL();
+        corrupt += whole ? 0 : 1;
+        disorders += ((int64_t)header.sequence > last[header.writer]) ? 0 : 1;
+        seen[header.writer][header.sequence]++;
+        messagesReceived++;
+        taskEXIT_CRITICAL();
+        last[header.writer] = header.sequence;
+    }
+    taskENTER_CRITICAL();
+    tasksDone++;
+    taskEXIT_CRITICAL();
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void sc_RecordWriter(void *parameter)
+* @brief	Sends SC_MESSAGES records to the stream, one send each
+* @param[in]	parameter - Number of the writer
+*****************************************************************************/
+static void sc_RecordWriter(void *parameter)
+{
+    uint32_t writer = (uint32_t)(uintptr_t)parameter;
+    uint8_t record[SC_RECORD_SIZE];
+
+    for (uint32_t sequence = 0; sequence < SC_MESSAGES; sequence++) {
+        record[0] = (uint8_t)writer;
+        record[1] = (uint8_t)sequence;
+        record[2] = (uint8_t)(sequence >> 8);
+        for (uint32_t i = 3; i < SC_RECORD_SIZE; i++) {
+            record[i] = sc_Byte(writer, sequence, i);
+        }
+        if (xStreamBufferSend(buffer, record, sizeof(record), portMAX_DELAY) != sizeof(record)) {
+            corrupt++;
+        }
+    }
+    taskENTER_CRITICAL();
+    tasksDone++;
+    taskEXIT_CRITICAL();
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void sc_RecordReader(void *parameter)
+* @brief	Reads the stream in random amounts and cuts it back into records
+* @details 	Each writer's records must follow one another, so the next
+*			record of a writer is always the one after its last.
+*****************************************************************************/
+static void sc_RecordReader(void *parameter)
+{
+    uint32_t next[SC_WRITERS] = { 0 };
+    uint32_t random = 0x13579BDFUL;
+    uint8_t record[SC_RECORD_SIZE];
+    size_t filled = 0;
+    uint32_t records = 0;
+    TickType_t since = xTaskGetTickCount();
+
+    (void)parameter;
+    while (!stalled && (records < (SC_WRITERS * SC_MESSAGES))) {
+        uint8_t chunk[SC_READ_MAX];
+        size_t length = xStreamBufferReceive(buffer, chunk, 1 + (sc_Random(&random) % SC_READ_MAX), SC_STALL);
+
+        if (length == 0) {
+            sc_Stalled(since);
+        } else {
+            since = xTaskGetTickCount();
+        }
+
+        for (size_t i = 0; i < length; i++) {
+            record[filled++] = chunk[i];
+            if (filled == SC_RECORD_SIZE) {
+                uint32_t writer = record[0];
+                uint32_t sequence = record[1] | ((uint32_t)record[2] << 8);
+                bool whole = (writer < SC_WRITERS);
+
+                for (uint32_t j = 3; whole && (j < SC_RECORD_SIZE); j++) {
+                    whole = (record[j] == sc_Byte(writer, sequence, j));
+                }
+                if (!whole) {
+                    corrupt++;
+                } else {
+                    disorders += (sequence == next[writer]) ? 0 : 1;
+                    next[writer] = sequence + 1;
+                }
+                records++;
+                filled = 0;
+            }
+        }
+    }
+    taskENTER_CRITICAL();
+    tasksDone++;
+    taskEXIT_CRITICAL();
+    vTaskDelete(NULL);
+}
+
+/**************************************************************************//**
+* @fn		static void sc_Stalled(TickType_t since)
+* @brief	Stops the phase if a reader got nothing for SC_STALL
+* @details 	The writers only block while the buffer is full, so a reader
+*			that gets nothing for that long means data was lost or the
+*			indexes no longer move, and the tasks would wait for ever.
+* @param[in]	since - Tick of the reader's last data
+*****************************************************************************/
+static void sc_Stalled(TickType_t since)
+{
+    if ((xTaskGetTickCount() - since) >= SC_STALL) {
+        stalled = true;
+    }
+}
+
+/**************************************************************************//**
+* @fn		static bool sc_WaitForTasks(uint8_t count)
+* @brief	Waits for the writers and readers of a phase
+* @return		false if the phase stalled, its tasks are left blocked
+*****************************************************************************/
+static bool sc_WaitForTasks(uint8_t count)
+{
+    while ((tasksDone < count) && !stalled) {
+        vTaskDelay(SC_POLL);
+    }
+    CHECK(!stalled);
+    return !stalled;
+}
+
+/**************************************************************************//**
+* @fn		static void sc_TestMessages(void)
+* @brief	Writers and readers of a message buffer lose, split and mix nothing
+* @return		false if the phase stalled
+*****************************************************************************/
+static bool sc_TestMessages(void)
+{
+    pthread_t raiser;
+    bool passed;
+    uint32_t missing = 0;
+    uint32_t duplicates = 0;
+
+    buffer = xMessageBufferCreateConcurrent(SC_BUFFER_SIZE);
+    CHECK(buffer != NULL);
+    if ((buffer == NULL) || !sc_StartRaising(&raiser)) {
+        return false;
+    }
+
+    tasksDone = 0;
+    for (uintptr_t i = 0; i < SC_WRITERS; i++) {
+        CHECK(xTaskCreate(sc_MessageWriter, "Writer", configMINIMAL_STACK_SIZE * 2, (void *)i, KTEST_PRIORITY, NULL) == pdPASS);
+    }
+    for (uint8_t i = 0; i < SC_READERS; i++) {
+        CHECK(xTaskCreate(sc_MessageReader, "Reader", configMINIMAL_STACK_SIZE * 2, NULL, KTEST_PRIORITY, NULL) == pdPASS);
+    }
+    passed = sc_WaitForTasks(SC_WRITERS + SC_READERS);
+    sc_StopRaising(raiser);
+    if (!passed) {
+        return false;
+    }
+
+    for (uint8_t writer = 0; writer < SC_WRITERS; writer++) {
+        for (uint32_t sequence = 0; sequence < SC_MESSAGES; sequence++) {
+            missing += (seen[writer][sequence] == 0) ? 1 : 0;
+            duplicates += (seen[writer][sequence] > 1) ? 1 : 0;
+        }
+    }
+    CHECK(corrupt == 0);
+    CHECK(disorders == 0);
+    CHECK(missing == 0);
+    CHECK(duplicates == 0);
+    CHECK(xStreamBufferIsEmpty(buffer) == pdTRUE);
+    printf("stream_concurrent_test: %u messages from %u writers to %u readers, %u corrupt, %u out of order, %u missing\n",
+           (unsigned int)messagesReceived, (unsigned int)SC_WRITERS, (unsigned int)SC_READERS, (unsigned int)corrupt,
+           (unsigned int)disorders, (unsigned int)missing);
+    vMessageBufferDelete(buffer);
+    return true;
+}
+
+/**************************************************************************//**
+* @fn		static void sc_TestStream(void)
+* @brief	Records sent whole to a stream buffer come out whole and in order
+* @return		false if the phase stalled
+*****************************************************************************/
+static bool sc_TestStream(void)
+{
+    pthread_t raiser;
+    bool passed;
+
+    buffer = xStreamBufferCreateConcurrent(SC_BUFFER_SIZE, 1);
+    CHECK(buffer != NULL);
+    if ((buffer == NULL) || !sc_StartRaising(&raiser)) {
+        return false;
+    }
+
+    tasksDone = 0;
+    corrupt = 0;
+    disorders = 0;
+    for (uintptr_t i = 0; i < SC_WRITERS; i++) {
+        CHECK(xTaskCreate(sc_RecordWriter, "Writer", configMINIMAL_STACK_SIZE * 2, (void *)i, KTEST_PRIORITY, NULL) == pdPASS);
+    }
+    CHECK(xTaskCreate(sc_RecordReader, "Reader", configMINIMAL_STACK_SIZE * 2, NULL, KTEST_PRIORITY, NULL) == pdPASS);
+    passed = sc_WaitForTasks(SC_WRITERS + 1);
+    sc_StopRaising(raiser);
+    if (!passed) {
+        return false;
+    }
+
+    CHECK(corrupt == 0);
+    CHECK(disorders == 0);
+    CHECK(xStreamBufferIsEmpty(buffer) == pdTRUE);
+    vStreamBufferDelete(buffer);
+    return true;
+}
+
+/**************************************************************************//**
+* @fn		static void sc_TestLimits(void)
+* @brief	A send that does not fit, a message too long to receive, a reset
+*****************************************************************************/
+static void sc_TestLimits(void)
+{
+    uint8_t message[SC_BUFFER_SIZE];
+    TickType_t start;
+    size_t available;
+
+    buffer = xMessageBufferCreateConcurrent(64);
+    CHECK(buffer != NULL);
+    if (buffer == NULL) {
+        return;
+    }
+    memset(message, 0x5A, sizeof(message));
+
+    CHECK(xMessageBufferSend(buffer, message, 40, 0) == 40);
+    available = xStreamBufferBytesAvailable(buffer);
+    start = xTaskGetTickCount();
+    CHECK(xMessageBufferSend(buffer, message, 40, SC_WAIT) == 0);
+    CHECK((xTaskGetTickCount() - start) >= SC_WAIT);
+    CHECK(xStreamBufferBytesAvailable(buffer) == available);
+    CHECK(xMessageBufferSend(buffer, message, 64, 0) == 0);  // Never fits, returns at once
+
+    CHECK(xMessageBufferReceive(buffer, message, 10, 0) == 0);
+    CHECK(xStreamBufferBytesAvailable(buffer) == available);
+    CHECK(xMessageBufferReceive(buffer, message, sizeof(message), 0) == 40);
+
+    CHECK(xMessageBufferSend(buffer, message, 20, 0) == 20);
+    CHECK(xMessageBufferReset(buffer) == pdPASS);
+    CHECK(xMessageBufferIsEmpty(buffer) == pdTRUE);
+    CHECK(xMessageBufferReceive(buffer, message, sizeof(message), 0) == 0);
+    vMessageBufferDelete(buffer);
+}
+
+static void sc_Test(void *parameter)
+{
+    (void)parameter;
+
+    vPortSetInterruptHandler(SC_SIGNAL, sc_Switch);
+    // A stalled phase leaves its tasks blocked on the buffer, so stop there
+    if (sc_TestMessages() && sc_TestStream()) {
+        sc_TestLimits();
+    }
+    ktest_End();
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+int main(void)
+{
+    return ktest_Run("stream_concurrent_test", sc_Test, SC_TIMEOUT);
+}
@@ -0,0 +1,269 @@
+/*
+ * FreeRTOS Kernel V10.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "channel.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Channels are created from the heap, and wake their receiver with a task
+notification. */
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_TASK_NOTIFICATIONS == 1 ) )
+
+/* The sender only stores uxHead and the receiver only stores uxTail.  An item
+is written before uxHead is released and read before uxTail is released, so
+each side sees complete items only.  Both sides run on the same core and the
+sender is an interrupt, so it always sees the receiver stopped between two
+statements. */
+#define chLOAD_ACQUIRE( x )			__atomic_load_n( &( x ), __ATOMIC_ACQUIRE )
+#define chSTORE_RELEASE( x, v )		__atomic_store_n( &( x ), ( v ), __ATOMIC_RELEASE )
+
+/*-----------------------------------------------------------*/
+
+/* Structure that holds state information on the channel.  The storage area
+follows it in the same allocation. */
+typedef struct xCHANNEL /*lint !e9058 Style convention uses tag. */
+{
+	volatile UBaseType_t uxHead;			/* Items ever sent, never wrapped. */
+	volatile UBaseType_t uxTail;			/* Items ever received, never wrapped. */
+	TaskHandle_t volatile xReceiver;		/* The task to notify, NULL until it first receives. */
+	uint8_t *pucStorage;
+	UBaseType_t uxLength;					/* A power of two. */
+	UBaseType_t uxItemSize;
+} Channel_t;
+
+/*
+ * Copies item number uxIndex, not yet wrapped, to or from the storage area.
+ */
+static void prvCopyToChannel( Channel_t * const pxChannel, UBaseType_t uxIndex, const void *pvItem ) PRIVILEGED_FUNCTION;
+static void prvCopyFromChannel( Channel_t * const pxChannel, UBaseType_t uxIndex, void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+ChannelHandle_t xChannelCreate( UBaseType_t uxLength, UBaseType_t uxItemSize )
+{
+Channel_t *pxChannel;
+
+	configASSERT( uxLength > ( UBaseType_t ) 0 );
+	configASSERT( ( uxLength & ( uxLength - ( UBaseType_t ) 1 ) ) == ( UBaseType_t ) 0 );
+	configASSERT( uxItemSize > ( UBaseType_t ) 0 );
+
+	/* The structure and the storage area are allocated in a single call, the
+	structure at the start. */
+	pxChannel = ( Channel_t * ) pvPortMalloc( sizeof( Channel_t ) + ( ( size_t ) uxLength * ( size_t ) uxItemSize ) ); /*lint !e9087 !e9079 Safe cast as allocated memory is aligned. */
+
+	if( pxChannel != NULL )
+	{
+		pxChannel->uxHead = ( UBaseType_t ) 0;
+		pxChannel->uxTail = ( UBaseType_t ) 0;
+		pxChannel->xReceiver = NULL;
+		pxChannel->pucStorage = ( ( uint8_t * ) pxChannel ) + sizeof( Channel_t );
+		pxChannel->uxLength = uxLength;
+		pxChannel->uxItemSize = uxItemSize;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return ( ChannelHandle_t ) pxChannel;
+}
+/*-----------------------------------------------------------*/
+
+void vChannelDelete( ChannelHandle_t xChannel )
+{
+Channel_t * const pxChannel = ( Channel_t * ) xChannel; /*lint !e9087 !e9079 Safe cast as ChannelHandle_t is opaque Channel_t. */
+
+	configASSERT( pxChannel );
+
+	vPortFree( pxChannel );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyToChannel( Channel_t * const pxChannel, UBaseType_t uxIndex, const void *pvItem )
+{
+uint8_t * const pucSlot = pxChannel->pucStorage + ( ( uxIndex & ( pxChannel->uxLength - ( UBaseType_t ) 1 ) ) * pxChannel->uxItemSize );
+
+	/* Byte channels are the common case, characters from a UART. */
+	if( pxChannel->uxItemSize == ( UBaseType_t ) 1 )
+	{
+		*pucSlot = *( ( const uint8_t * ) pvItem );
+	}
+	else
+	{
+		( void ) memcpy( ( void * ) pucSlot, pvItem, ( size_t ) pxChannel->uxItemSize );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyFromChannel( Channel_t * const pxChannel, UBaseType_t uxIndex, void *pvBuffer )
+{
+const uint8_t * const pucSlot = pxChannel->pucStorage + ( ( uxIndex & ( pxChannel->uxLength - ( UBaseType_t ) 1 ) ) * pxChannel->uxItemSize );
+
+	if( pxChannel->uxItemSize == ( UBaseType_t ) 1 )
+	{
+		*( ( uint8_t * ) pvBuffer ) = *pucSlot;
+	}
+	else
+	{
+		( void ) memcpy( pvBuffer, ( const void * ) pucSlot, ( size_t ) pxChannel->uxItemSize );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xChannelSendFromISR( ChannelHandle_t xChannel, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken )
+{
+Channel_t * const pxChannel = ( Channel_t * ) xChannel; /*lint !e9087 !e9079 Safe cast as ChannelHandle_t is opaque Channel_t. */
+UBaseType_t uxHead;
+TaskHandle_t xReceiver;
+BaseType_t xReturn;
+
+	configASSERT( pxChannel );
+	configASSERT( pvItemToQueue );
+
+	/* Only this function writes uxHead. */
+	uxHead = pxChannel->uxHead;
+
+	if( ( uxHead - chLOAD_ACQUIRE( pxChannel->uxTail ) ) < pxChannel->uxLength )
+	{
+		prvCopyToChannel( pxChannel, uxHead, pvItemToQueue );
+		chSTORE_RELEASE( pxChannel->uxHead, uxHead + ( UBaseType_t ) 1 );
+
+		/* The receiver is only notified when it had received every item
+		before this one.  It is then blocked, about to block, or about to
+		find this item; in each case the notification cannot be missed, and
+		at worst costs it one spurious wake up.  Otherwise it has not yet
+		received an earlier item and will find this one before it blocks. */
+		if( chLOAD_ACQUIRE( pxChannel->uxTail ) == uxHead )
+		{
+			xReceiver = pxChannel->xReceiver;
+
+			if( xReceiver != NULL )
+			{
+				vTaskNotifyGiveFromISR( xReceiver, pxHigherPriorityTaskWoken );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = errQUEUE_FULL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xChannelReceive( ChannelHandle_t xChannel, void *pvBuffer, TickType_t xTicksToWait )
+{
+Channel_t * const pxChannel = ( Channel_t * ) xChannel; /*lint !e9087 !e9079 Safe cast as ChannelHandle_t is opaque Channel_t. */
+UBaseType_t uxTail;
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+
+	configASSERT( pxChannel );
+	configASSERT( pvBuffer );
+
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	/* Registered before the channel is first found empty, so any send from
+	then on that leaves a single item notifies this task. */
+	pxChannel->xReceiver = xTaskGetCurrentTaskHandle();
+
+	/* Only this function writes uxTail. */
+	uxTail = pxChannel->uxTail;
+
+	for( ;; )
+	{
+		if( chLOAD_ACQUIRE( pxChannel->uxHead ) != uxTail )
+		{
+			prvCopyFromChannel( pxChannel, uxTail, pvBuffer );
+			chSTORE_RELEASE( pxChannel->uxTail, uxTail + ( UBaseType_t ) 1 );
+			return pdPASS;
+		}
+		else if( xTicksToWait == ( TickType_t ) 0 )
+		{
+			return errQUEUE_EMPTY;
+		}
+		else if( xEntryTimeSet == pdFALSE )
+		{
+			vTaskSetTimeOutState( &xTimeOut );
+			xEntryTimeSet = pdTRUE;
+		}
+		else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+		{
+			return errQUEUE_EMPTY;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Returns at once if a send notified the task since it last waited,
+		possibly for an item it has already received.  The channel is
+		checked again either way. */
+		( void ) ulTaskNotifyTake( pdTRUE, xTicksToWait );
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxChannelMessagesWaiting( ChannelHandle_t xChannel )
+{
+Channel_t * const pxChannel = ( Channel_t * ) xChannel; /*lint !e9087 !e9079 Safe cast as ChannelHandle_t is opaque Channel_t. */
+
+	configASSERT( pxChannel );
+
+	return pxChannel->uxHead - pxChannel->uxTail;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_TASK_NOTIFICATIONS == 1 ) */
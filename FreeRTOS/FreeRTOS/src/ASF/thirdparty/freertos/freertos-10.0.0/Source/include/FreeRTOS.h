@@ -739,6 +739,44 @@ extern "C" {
 	#define configUSE_TICKLESS_IDLE 0
 #endif
 
+#ifndef configUSE_DELAYED_TASK_WHEEL
+	#define configUSE_DELAYED_TASK_WHEEL 0
+#endif
+
+#ifndef configDELAYED_TASK_WHEEL_SIZE
+	#define configDELAYED_TASK_WHEEL_SIZE 32
+#endif
+
+#if( ( configDELAYED_TASK_WHEEL_SIZE & ( configDELAYED_TASK_WHEEL_SIZE - 1 ) ) != 0 )
+	#error configDELAYED_TASK_WHEEL_SIZE must be a power of 2
+#endif
+
+#ifndef configUSE_CRITICAL_SECTION_STATS
+	#define configUSE_CRITICAL_SECTION_STATS 0
+#endif
+
+#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+	#ifndef configRECORD_CRITICAL_SECTION
+		#error configRECORD_CRITICAL_SECTION( pvCaller, ulDuration ) must be defined when configUSE_CRITICAL_SECTION_STATS is 1.  It is called with interrupts still masked at the end of every outermost critical section.
+	#endif
+#endif
+
+#ifndef configUSE_TRACE_RECORDER
+	#define configUSE_TRACE_RECORDER 0
+#endif
+
+#ifndef configUSE_QUEUE_LOANS
+	#define configUSE_QUEUE_LOANS 0
+#endif
+
+#ifndef configUSE_CONCURRENT_STREAM_BUFFERS
+	#define configUSE_CONCURRENT_STREAM_BUFFERS 0
+#endif
+
+#if( ( configUSE_TRACE_RECORDER == 1 ) && ( configUSE_TRACE_FACILITY != 1 ) )
+	#error configUSE_TRACE_FACILITY must be 1 when configUSE_TRACE_RECORDER is 1.  The recorder numbers tasks and queues through uxTaskNumber and uxQueueNumber.
+#endif
+
 #ifndef configPRE_SUPPRESS_TICKS_AND_SLEEP_PROCESSING
 	#define configPRE_SUPPRESS_TICKS_AND_SLEEP_PROCESSING( x )
 #endif
@@ -1054,10 +1092,16 @@ typedef struct xSTATIC_QUEUE
 		UBaseType_t uxDummy2;
 	} u;
 
+	void *pvDummy10;
+
 	StaticList_t xDummy3[ 2 ];
 	UBaseType_t uxDummy4[ 3 ];
 	uint8_t ucDummy5[ 2 ];
 
+	#if( configUSE_QUEUE_LOANS == 1 )
+		uint8_t ucDummy11;
+	#endif
+
 	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 		uint8_t ucDummy6;
 	#endif
@@ -1156,6 +1200,11 @@ typedef struct xSTATIC_STREAM_BUFFER
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t uxDummy4;
 	#endif
+	#if ( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+		size_t uxDummy5[ 2 ];
+		StaticList_t xDummy6[ 2 ];
+		UBaseType_t uxDummy7[ 2 ];
+	#endif
 } StaticStreamBuffer_t;
 
 /* Message buffers are built on stream buffers. */
@@ -0,0 +1,164 @@
+/*
+ * FreeRTOS Kernel V10.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Channels carry fixed size items from exactly one interrupt to exactly one
+ * task, for example received characters from a UART handler to the task that
+ * parses them.  Sending never masks interrupts, never locks the channel and
+ * never walks an event list: the item is copied into a ring and the write
+ * index advanced.  Only a send that makes the channel non-empty notifies the
+ * receiving task, with a direct to task notification, so a burst of items
+ * costs a single notification.
+ *
+ * The receiving task must not use its task notification for anything else
+ * while it receives from a channel, see xChannelReceive().  Neither more than
+ * one sender nor more than one receiver is supported, use a queue for those.
+ */
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include channel.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/**
+ * Type by which channels are referenced.  For example, a call to
+ * xChannelCreate() returns a ChannelHandle_t variable that can then be used as
+ * a parameter to xChannelSendFromISR(), xChannelReceive(), etc.
+ */
+typedef void * ChannelHandle_t;
+
+/**
+ * channel.h
+ *
+<pre>
+ChannelHandle_t xChannelCreate( UBaseType_t uxLength, UBaseType_t uxItemSize );
+</pre>
+ *
+ * Creates a channel that holds up to uxLength items of uxItemSize bytes.  The
+ * channel structure and its storage are allocated with a single call to
+ * pvPortMalloc().
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION and configUSE_TASK_NOTIFICATIONS must be
+ * set to 1 in FreeRTOSConfig.h for xChannelCreate() to be available.
+ *
+ * @param uxLength The number of items the channel can hold.  Must be a power
+ * of two, so that the indexes wrap with a mask instead of a division.
+ *
+ * @param uxItemSize The size of each item, in bytes.
+ *
+ * @return The handle of the new channel, or NULL if there was not enough heap.
+ */
+ChannelHandle_t xChannelCreate( UBaseType_t uxLength, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * channel.h
+ *
+<pre>
+void vChannelDelete( ChannelHandle_t xChannel );
+</pre>
+ *
+ * Returns the memory of a channel to the heap.  The interrupt must no longer
+ * send to it and the task must no longer be waiting on it.
+ */
+void vChannelDelete( ChannelHandle_t xChannel ) PRIVILEGED_FUNCTION;
+
+/**
+ * channel.h
+ *
+<pre>
+BaseType_t xChannelSendFromISR( ChannelHandle_t xChannel, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Copies an item into a channel.  Must only be called from the one interrupt
+ * that sends to the channel, or from code that interrupt cannot preempt.  It
+ * never waits, if the channel is full the item is dropped.
+ *
+ * @param xChannel The channel to send to.
+ *
+ * @param pvItemToQueue The item, uxItemSize bytes are copied from it.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the send woke the
+ * receiving task and it has a priority higher than the running task, in which
+ * case a context switch should be requested before the interrupt exits.  May
+ * be NULL.
+ *
+ * @return pdPASS if the item was copied, errQUEUE_FULL if the channel was
+ * full.
+ */
+BaseType_t xChannelSendFromISR( ChannelHandle_t xChannel, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * channel.h
+ *
+<pre>
+BaseType_t xChannelReceive( ChannelHandle_t xChannel, void *pvBuffer, TickType_t xTicksToWait );
+</pre>
+ *
+ * Copies the oldest item out of a channel, waiting up to xTicksToWait ticks
+ * for the interrupt to send one if the channel is empty.  Must only be called
+ * from the one task that receives from the channel.
+ *
+ * The task waits on its own task notification.  A notification given to it by
+ * anything other than the channel is consumed as a spurious wake up, and the
+ * channel may leave the notification value of the task non-zero.
+ *
+ * @param xChannel The channel to receive from.
+ *
+ * @param pvBuffer Buffer of at least uxItemSize bytes the item is copied to.
+ *
+ * @param xTicksToWait The maximum time to wait for an item, 0 to return at
+ * once, portMAX_DELAY to wait forever if INCLUDE_vTaskSuspend is 1.
+ *
+ * @return pdPASS if an item was received, errQUEUE_EMPTY if none arrived in
+ * time.
+ */
+BaseType_t xChannelReceive( ChannelHandle_t xChannel, void *pvBuffer, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * channel.h
+ *
+<pre>
+UBaseType_t uxChannelMessagesWaiting( ChannelHandle_t xChannel );
+</pre>
+ *
+ * @return The number of items in the channel.  Can be called by the sender or
+ * the receiver, the value is only a snapshot if the other side is running.
+ */
+UBaseType_t uxChannelMessagesWaiting( ChannelHandle_t xChannel ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( CHANNEL_H ) */
@@ -0,0 +1,203 @@
+/*
+ * FreeRTOS Kernel V10.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Memory pools hand out blocks of one fixed size from a region allocated when
+ * the pool is created.  Allocating and freeing a block take the same short
+ * time whatever the number of blocks, never touch the heap, and can be done
+ * from interrupts.  A task can also wait for a block to be freed.
+ *
+ * A typical use is passing large messages through a queue by pointer: the
+ * sender allocates a block, fills it and sends its address, the receiver uses
+ * the block in place and frees it.  Only the pointer is copied into and out
+ * of the queue, instead of the whole message.
+ */
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include mempool.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/**
+ * Type by which memory pools are referenced.  For example, a call to
+ * xMemPoolCreate() returns a MemPoolHandle_t variable that can then be used as
+ * a parameter to pvMemPoolAlloc(), vMemPoolFree(), etc.
+ */
+typedef void * MemPoolHandle_t;
+
+/**
+ * mempool.h
+ *
+<pre>
+MemPoolHandle_t xMemPoolCreate( size_t xBlockSize, UBaseType_t uxBlockCount );
+</pre>
+ *
+ * Creates a pool of uxBlockCount blocks of at least xBlockSize bytes each.
+ * The pool structure and the blocks are allocated with a single call to
+ * pvPortMalloc(), the semaphore that counts the free blocks with another.
+ * Block sizes are rounded up to portBYTE_ALIGNMENT, so every block is aligned
+ * for any type.
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION and configUSE_COUNTING_SEMAPHORES must be
+ * set to 1 in FreeRTOSConfig.h for xMemPoolCreate() to be available.
+ *
+ * @param xBlockSize The number of bytes each block must hold.
+ *
+ * @param uxBlockCount The number of blocks in the pool.
+ *
+ * @return The handle of the new pool, or NULL if there was not enough heap.
+ */
+MemPoolHandle_t xMemPoolCreate( size_t xBlockSize, UBaseType_t uxBlockCount ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ *
+<pre>
+void vMemPoolDelete( MemPoolHandle_t xMemPool );
+</pre>
+ *
+ * Returns the memory of a pool to the heap.  Blocks still allocated from the
+ * pool must not be used any more, and no task may be waiting for a block.
+ */
+void vMemPoolDelete( MemPoolHandle_t xMemPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ *
+<pre>
+void *pvMemPoolAlloc( MemPoolHandle_t xMemPool, TickType_t xTicksToWait );
+</pre>
+ *
+ * Takes a block from a pool, waiting up to xTicksToWait ticks for another task
+ * or an interrupt to free one if they are all allocated.  The content of the
+ * block is undefined.
+ *
+ * @param xMemPool The pool to allocate from.
+ *
+ * @param xTicksToWait The maximum time to wait for a free block, 0 to return
+ * at once, portMAX_DELAY to wait forever if INCLUDE_vTaskSuspend is 1.
+ *
+ * @return The block, or NULL if no block was freed in time.
+ */
+void *pvMemPoolAlloc( MemPoolHandle_t xMemPool, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ *
+<pre>
+void *pvMemPoolAllocFromISR( MemPoolHandle_t xMemPool );
+</pre>
+ *
+ * A version of pvMemPoolAlloc() that can be called from an interrupt service
+ * routine.  It never waits.
+ *
+ * @return The block, or NULL if every block is allocated.
+ */
+void *pvMemPoolAllocFromISR( MemPoolHandle_t xMemPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ *
+<pre>
+void vMemPoolFree( MemPoolHandle_t xMemPool, void *pvBlock );
+</pre>
+ *
+ * Returns a block to the pool it was allocated from, and wakes the highest
+ * priority task waiting for a block, if any.  Any task can free a block, not
+ * only the one that allocated it.  configASSERT() catches a pointer that is not
+ * a block of the pool.  A free while every block of the pool is already free
+ * is a double free, it asserts and leaves the pool unchanged.
+ *
+ * @param xMemPool The pool pvBlock was allocated from.
+ *
+ * @param pvBlock A block returned by pvMemPoolAlloc() or
+ * pvMemPoolAllocFromISR() and not freed since.
+ */
+void vMemPoolFree( MemPoolHandle_t xMemPool, void *pvBlock ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ *
+<pre>
+void vMemPoolFreeFromISR( MemPoolHandle_t xMemPool, void *pvBlock, BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * A version of vMemPoolFree() that can be called from an interrupt service
+ * routine.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if freeing the block woke a
+ * task of a priority higher than the running task, in which case a context
+ * switch should be requested before the interrupt exits.  May be NULL.
+ */
+void vMemPoolFreeFromISR( MemPoolHandle_t xMemPool, void *pvBlock, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ *
+<pre>
+UBaseType_t uxMemPoolGetFreeCount( MemPoolHandle_t xMemPool );
+</pre>
+ *
+ * @return The number of blocks that can be allocated without waiting.
+ */
+UBaseType_t uxMemPoolGetFreeCount( MemPoolHandle_t xMemPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ *
+<pre>
+UBaseType_t uxMemPoolGetMinimumEverFreeCount( MemPoolHandle_t xMemPool );
+</pre>
+ *
+ * @return The lowest number of free blocks the pool has had since it was
+ * created, to size uxBlockCount.
+ */
+UBaseType_t uxMemPoolGetMinimumEverFreeCount( MemPoolHandle_t xMemPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * mempool.h
+ *
+<pre>
+size_t xMemPoolGetBlockSize( MemPoolHandle_t xMemPool );
+</pre>
+ *
+ * @return The size of the blocks of the pool, xBlockSize once rounded up.
+ */
+size_t xMemPoolGetBlockSize( MemPoolHandle_t xMemPool ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( MEMPOOL_H ) */
@@ -48,7 +48,9 @@
  * block time to 0.  Likewise, if there are to be multiple different readers
  * then the application writer must place each call to a reading API function
  * (such as xMessageBufferRead()) inside a critical section and set the receive
- * timeout to 0.
+ * timeout to 0.  Alternatively, a message buffer created with
+ * xMessageBufferCreateConcurrent() can be written and read by any number of
+ * tasks.
  *
  * Message buffers hold variable length messages.  To enable that, when a
  * message is written to the message buffer an additional sizeof( size_t ) bytes
@@ -204,6 +206,35 @@ MessageBufferHandle_t xMessageBuffer;
  */
 #define xMessageBufferCreateStatic( xBufferSizeBytes, pucMessageBufferStorageArea, pxStaticMessageBuffer ) ( MessageBufferHandle_t ) xStreamBufferGenericCreateStatic( xBufferSizeBytes, 0, pdTRUE, pucMessageBufferStorageArea, pxStaticMessageBuffer )
 
+/**
+ * message_buffer.h
+ *
+<pre>
+MessageBufferHandle_t xMessageBufferCreateConcurrent( size_t xBufferSizeBytes );
+</pre>
+ *
+ * Creates a message buffer, like xMessageBufferCreate(), that any number of
+ * tasks can write to and read from at the same time without a mutex, for
+ * example a log that several tasks write lines to.  Each message is written
+ * and read whole, see xStreamBufferCreateConcurrent() for how.  The FromISR
+ * functions must not be used with a concurrent message buffer.
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION and configUSE_CONCURRENT_STREAM_BUFFERS
+ * must be set to 1 in FreeRTOSConfig.h for xMessageBufferCreateConcurrent()
+ * to be available.
+ *
+ * @param xBufferSizeBytes The total number of bytes (not messages) the message
+ * buffer will be able to hold at any one time, each message taking an
+ * additional sizeof( size_t ) bytes as with xMessageBufferCreate().
+ *
+ * @return The handle of the new message buffer, or NULL if there was not
+ * enough heap.
+ *
+ * \defgroup xMessageBufferCreateConcurrent xMessageBufferCreateConcurrent
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferCreateConcurrent( xBufferSizeBytes ) ( MessageBufferHandle_t ) xStreamBufferGenericCreateConcurrent( xBufferSizeBytes, ( size_t ) 0, pdTRUE )
+
 /**
  * message_buffer.h
  *
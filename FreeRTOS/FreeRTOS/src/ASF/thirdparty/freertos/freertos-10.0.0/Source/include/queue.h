@@ -505,7 +505,10 @@ typedef void * QueueSetMemberHandle_t;
  * @return xQueueOverwrite() is a macro that calls xQueueGenericSend(), and
  * therefore has the same return values as xQueueSendToFront().  However, pdPASS
  * is the only value that can be returned because xQueueOverwrite() will write
- * to the queue even when the queue is already full.
+ * to the queue even when the queue is already full.  A queue that is
+ * overwritten must therefore not be used with pvQueueLoanSend() or
+ * pvQueueLoanReceive(), configASSERT() fails on an overwrite while a slot is on
+ * loan.
  *
  * Example usage:
    <pre>
@@ -1089,7 +1092,8 @@ void vQueueDelete( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
  * xQueueGenericSendFromISR(), and therefore has the same return values as
  * xQueueSendToFrontFromISR().  However, pdPASS is the only value that can be
  * returned because xQueueOverwriteFromISR() will write to the queue even when
- * the queue is already full.
+ * the queue is already full.  As for xQueueOverwrite(), the queue must not be
+ * used with the loan functions.
  *
  * Example usage:
    <pre>
@@ -1383,6 +1387,179 @@ BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherP
  */
 BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue, void * const pvBuffer, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueSendMultiple(
+								QueueHandle_t xQueue,
+								const void *pvItemsToQueue,
+								UBaseType_t uxItemCount,
+								TickType_t xTicksToWait
+							);
+ * </pre>
+ *
+ * Posts consecutive items to the back of a queue in one critical section.
+ * Waits up to xTicksToWait for the queue to have room for at least one item,
+ * then posts as many of the items as fit, and unblocks one waiting task for
+ * each item posted.  A burst of items costs one critical section, one wait
+ * list check and at most one context switch, instead of one of each per item.
+ *
+ * The items are packed back to back, uxItemCount times the item size of the
+ * queue.  This function must not be used on semaphores or mutexes.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItemsToQueue A pointer to the first item to be placed on the queue.
+ *
+ * @param uxItemCount The number of items at pvItemsToQueue.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for room on the queue, should it be full.
+ *
+ * @return The number of items posted, from 0 if the queue stayed full for
+ * xTicksToWait to uxItemCount.  Call again with the rest to post them all.
+ *
+ * \defgroup xQueueSendMultiple xQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItemsToQueue, const UBaseType_t uxItemCount, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueReceiveMultiple(
+								QueueHandle_t xQueue,
+								void *pvBuffer,
+								UBaseType_t uxItemCount,
+								TickType_t xTicksToWait
+							);
+ * </pre>
+ *
+ * Receives up to uxItemCount items from a queue in one critical section.
+ * Waits up to xTicksToWait for at least one item, then copies out as many as
+ * the queue holds, up to uxItemCount, and unblocks one task waiting to send
+ * for each item removed.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to the buffer into which the items are copied back
+ * to back, it must hold uxItemCount items.
+ *
+ * @param uxItemCount The most items to receive.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item to receive should the queue be empty.
+ *
+ * @return The number of items received, 0 if the queue stayed empty for
+ * xTicksToWait.
+ *
+ * \defgroup xQueueReceiveMultiple xQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxItemCount, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Versions of xQueueSendMultiple() and xQueueReceiveMultiple() that can be
+ * called from an interrupt service routine.  They never block, and set
+ * *pxHigherPriorityTaskWoken to pdTRUE if a task they unblocked has a priority
+ * above the task that was interrupted, in which case a context switch should
+ * be requested before the interrupt exits.
+ *
+ * All the items are copied with interrupts masked, so the time interrupts stay
+ * masked grows with uxItemCount times the item size.  Keep batches to what the
+ * interrupt latency of the application can take.  While a task holds the queue
+ * locked, xQueueSendMultipleFromISR() sends a member of a queue set at most 127
+ * items, the most the lock can record.
+ */
+BaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItemsToQueue, const UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ void *pvQueueLoanSend( QueueHandle_t xQueue, TickType_t xTicksToWait );
+ void vQueueCommitSend( QueueHandle_t xQueue );
+ * </pre>
+ *
+ * Sends an item to the back of a queue without copying it.  pvQueueLoanSend()
+ * waits up to xTicksToWait for a free slot, as xQueueSendToBack() would, and
+ * returns the slot itself.  The caller writes the item there, then
+ * vQueueCommitSend() queues it and unblocks a waiting receiver, with the same
+ * priority rules as xQueueSendToBack().  For large items this saves the copy
+ * into the queue, and a matching pvQueueLoanReceive() saves the copy out.
+ *
+ * Only one send slot of a queue can be on loan at a time.  Until it is
+ * committed every other send to the queue blocks, or fails from an interrupt,
+ * so the task holding the loan must not send to the queue itself and should
+ * commit soon.  The commit unblocks as many of those senders as there are free
+ * slots left.  Overwrites cannot wait for the commit, so a queue that is
+ * overwritten must not be loaned.  configUSE_QUEUE_LOANS must be set to 1 in
+ * FreeRTOSConfig.h for these functions to be available.  They cannot be used
+ * on semaphores.
+ *
+ * On the host simulator the loan calls were slower than copying for every item
+ * size up to 256 bytes that the message benchmark of kBench.c measures, as the
+ * extra kernel calls cost more than the copies they save.  Measure on the
+ * target before using them for speed.
+ *
+ * @param xQueue The handle to the queue on which the item is to be posted.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for a free slot.
+ *
+ * @return The slot to write the item to, uxItemSize bytes aligned as the queue
+ * storage, or NULL if none came free in time.
+ *
+ * Example usage:
+   <pre>
+ struct AMessage *pxMessage;
+
+	pxMessage = ( struct AMessage * ) pvQueueLoanSend( xQueue, portMAX_DELAY );
+	pxMessage->ucMessageID = 1;
+	vQueueCommitSend( xQueue );
+   </pre>
+ *
+ * \defgroup pvQueueLoanSend pvQueueLoanSend
+ * \ingroup QueueManagement
+ */
+void *pvQueueLoanSend( QueueHandle_t xQueue, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+void vQueueCommitSend( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ void *pvQueueLoanReceive( QueueHandle_t xQueue, TickType_t xTicksToWait );
+ void vQueueReleaseReceive( QueueHandle_t xQueue );
+ * </pre>
+ *
+ * Receives the item at the head of a queue without copying it.
+ * pvQueueLoanReceive() waits up to xTicksToWait for an item, as
+ * xQueueReceive() would, and returns the slot that holds it.  The caller
+ * reads the item in place, then vQueueReleaseReceive() removes it and
+ * unblocks a waiting sender.
+ *
+ * Only one item of a queue can be on loan at a time.  Until it is released
+ * every other receive or peek from the queue blocks, or fails from an
+ * interrupt, as do sends to the front of the queue.  The release unblocks as
+ * many of those receivers as there are items left, and as many senders as
+ * there are free slots.  Overwrites assert, see xQueueOverwrite().
+ * configUSE_QUEUE_LOANS must be set to 1 in FreeRTOSConfig.h for these
+ * functions to be available.
+ *
+ * @param xQueue The handle to the queue from which the item is to be received.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item.
+ *
+ * @return The item, or NULL if the queue stayed empty for xTicksToWait.
+ *
+ * \defgroup pvQueueLoanReceive pvQueueLoanReceive
+ * \ingroup QueueManagement
+ */
+void *pvQueueLoanReceive( QueueHandle_t xQueue, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+void vQueueReleaseReceive( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
 /*
  * Utilities to query queues that are safe to use from an ISR.  These utilities
  * should be used only from witin an ISR, or within a critical section.
@@ -47,6 +47,10 @@
  * (such as xStreamBufferRead()) inside a critical section section and set the
  * receive block time to 0.
  *
+ * Alternatively, a stream buffer created with xStreamBufferCreateConcurrent()
+ * can be written and read by any number of tasks (but no interrupts), each
+ * with its own block time.
+ *
  */
 
 #ifndef STREAM_BUFFER_H
@@ -209,6 +213,46 @@ const size_t xTriggerLevel = 1;
  */
 #define xStreamBufferCreateStatic( xBufferSizeBytes, xTriggerLevelBytes, pucStreamBufferStorageArea, pxStaticStreamBuffer ) xStreamBufferGenericCreateStatic( xBufferSizeBytes, xTriggerLevelBytes, pdFALSE, pucStreamBufferStorageArea, pxStaticStreamBuffer )
 
+/**
+ * stream_buffer.h
+ *
+<pre>
+StreamBufferHandle_t xStreamBufferCreateConcurrent( size_t xBufferSizeBytes, size_t xTriggerLevelBytes );
+</pre>
+ *
+ * Creates a stream buffer, like xStreamBufferCreate(), that any number of
+ * tasks can write to and read from at the same time without a mutex.
+ *
+ * A writer reserves room for all of its data, copies the data with the
+ * scheduler running, then commits it.  The data of one xStreamBufferSend()
+ * call is therefore never interleaved with the data of another, and is never
+ * split: the call waits until all of it fits, and writes nothing if it times
+ * out.  Readers claim data in the same way.  Data becomes visible to readers
+ * once every writer that reserved room before it has committed, and space is
+ * freed once every reader that claimed data before it has finished.
+ *
+ * Any number of tasks can block in xStreamBufferSend() and
+ * xStreamBufferReceive(), in priority order, and task notifications are not
+ * used.  The FromISR functions must not be used with a concurrent stream
+ * buffer.
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION and configUSE_CONCURRENT_STREAM_BUFFERS
+ * must be set to 1 in FreeRTOSConfig.h for xStreamBufferCreateConcurrent() to
+ * be available.
+ *
+ * @param xBufferSizeBytes The total number of bytes the stream buffer will be
+ * able to hold at any one time.
+ *
+ * @param xTriggerLevelBytes As for xStreamBufferCreate().
+ *
+ * @return The handle of the new stream buffer, or NULL if there was not enough
+ * heap.
+ *
+ * \defgroup xStreamBufferCreateConcurrent xStreamBufferCreateConcurrent
+ * \ingroup StreamBufferManagement
+ */
+#define xStreamBufferCreateConcurrent( xBufferSizeBytes, xTriggerLevelBytes ) xStreamBufferGenericCreateConcurrent( xBufferSizeBytes, xTriggerLevelBytes, pdFALSE )
+
 /**
  * stream_buffer.h
  *
@@ -595,7 +639,8 @@ void vStreamBufferDelete( StreamBufferHandle_t xStreamBuffer );
  * then the allocated memory is freed.
  *
  * A stream buffer handle must not be used after the stream buffer has been
- * deleted.
+ * deleted.  A concurrent stream buffer must not be deleted while a task is
+ * waiting on, writing to or reading from it.
  *
  * @param xStreamBuffer The handle of the stream buffer to be deleted.
  *
@@ -654,7 +699,8 @@ BaseType_t xStreamBufferReset( StreamBufferHandle_t xStreamBuffer );
  * Resets a stream buffer to its initial, empty, state.  Any data that was in
  * the stream buffer is discarded.  A stream buffer can only be reset if there
  * are no tasks blocked waiting to either send to or receive from the stream
- * buffer.
+ * buffer.  A concurrent stream buffer can also not be reset while a task is
+ * writing to or reading from it.
  *
  * @param xStreamBuffer The handle of the stream buffer being reset.
  *
@@ -836,6 +882,10 @@ StreamBufferHandle_t xStreamBufferGenericCreateStatic( size_t xBufferSizeBytes,
 													   uint8_t * const pucStreamBufferStorageArea,
 													   StaticStreamBuffer_t * const pxStaticStreamBuffer ) PRIVILEGED_FUNCTION;
 
+StreamBufferHandle_t xStreamBufferGenericCreateConcurrent( size_t xBufferSizeBytes,
+														   size_t xTriggerLevelBytes,
+														   BaseType_t xIsMessageBuffer ) PRIVILEGED_FUNCTION;
+
 #if( configUSE_TRACE_FACILITY == 1 )
 	void vStreamBufferSetStreamBufferNumber( StreamBufferHandle_t xStreamBuffer, UBaseType_t uxStreamBufferNumber ) PRIVILEGED_FUNCTION;
 	UBaseType_t uxStreamBufferGetStreamBufferNumber( StreamBufferHandle_t xStreamBuffer ) PRIVILEGED_FUNCTION;
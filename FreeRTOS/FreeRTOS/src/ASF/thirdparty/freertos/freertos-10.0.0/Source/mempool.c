@@ -0,0 +1,348 @@
+/*
+ * FreeRTOS Kernel V10.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "mempool.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Pools can only be created from the heap, and wait on a counting semaphore. */
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_COUNTING_SEMAPHORES == 1 ) )
+
+/* Rounds a size up to a multiple of portBYTE_ALIGNMENT. */
+#define mpALIGN( x )	( ( ( x ) + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/*-----------------------------------------------------------*/
+
+/* A free block holds the address of the next free block in its first bytes. */
+typedef struct xMEMPOOL_FREE_BLOCK
+{
+	struct xMEMPOOL_FREE_BLOCK *pxNext;
+} MemPoolFreeBlock_t;
+
+/* Structure that holds state information on the pool.  The blocks follow it
+in the same allocation. */
+typedef struct xMEMPOOL /*lint !e9058 Style convention uses tag. */
+{
+	MemPoolFreeBlock_t *pxFreeList;			/* Free blocks, the most recently freed first. */
+	SemaphoreHandle_t xFreeBlocks;			/* Counts the free blocks, tasks wait on it for a block. */
+	uint8_t *pucBlocks;						/* The first block. */
+	uint8_t *pucBlocksEnd;					/* One past the last block. */
+	size_t xBlockSize;
+	UBaseType_t uxBlockCount;
+	UBaseType_t uxFreeCount;				/* Length of pxFreeList. */
+	UBaseType_t uxMinimumEverFreeCount;
+} MemPool_t;
+
+/* The blocks start on the first aligned address after the structure. */
+static const size_t xMemPoolStructSize = mpALIGN( sizeof( MemPool_t ) );
+
+/*
+ * Unlinks the first free block.  The caller has taken a count from
+ * xFreeBlocks, so the list is not empty, and masked interrupts.
+ */
+static void *prvPopFreeBlock( MemPool_t * const pxMemPool ) PRIVILEGED_FUNCTION;
+
+/*
+ * Links a block back into the free list.  Interrupts masked by the caller.
+ * Returns pdFAIL, leaving the list as it was, if every block is already free,
+ * as the block is then being freed twice.
+ */
+static BaseType_t prvPushFreeBlock( MemPool_t * const pxMemPool, void *pvBlock ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+MemPoolHandle_t xMemPoolCreate( size_t xBlockSize, UBaseType_t uxBlockCount )
+{
+MemPool_t *pxMemPool;
+uint8_t *pucBlock;
+UBaseType_t ux;
+
+	configASSERT( xBlockSize > ( size_t ) 0 );
+	configASSERT( uxBlockCount > ( UBaseType_t ) 0 );
+
+	/* A free block must hold the free list link, and every block must be
+	aligned for any type. */
+	if( xBlockSize < sizeof( MemPoolFreeBlock_t ) )
+	{
+		xBlockSize = sizeof( MemPoolFreeBlock_t );
+	}
+	xBlockSize = mpALIGN( xBlockSize );
+
+	/* The structure and the blocks are allocated in a single call, the
+	structure at the start. */
+	pxMemPool = ( MemPool_t * ) pvPortMalloc( xMemPoolStructSize + ( xBlockSize * ( size_t ) uxBlockCount ) ); /*lint !e9087 !e9079 Safe cast as allocated memory is aligned. */
+
+	if( pxMemPool != NULL )
+	{
+		pxMemPool->xFreeBlocks = xSemaphoreCreateCounting( uxBlockCount, uxBlockCount );
+
+		if( pxMemPool->xFreeBlocks != NULL )
+		{
+			pxMemPool->pucBlocks = ( ( uint8_t * ) pxMemPool ) + xMemPoolStructSize;
+			pxMemPool->pucBlocksEnd = pxMemPool->pucBlocks + ( xBlockSize * ( size_t ) uxBlockCount );
+			pxMemPool->xBlockSize = xBlockSize;
+			pxMemPool->uxBlockCount = uxBlockCount;
+			pxMemPool->uxFreeCount = uxBlockCount;
+			pxMemPool->uxMinimumEverFreeCount = uxBlockCount;
+
+			/* Link the blocks in address order, the first block first. */
+			pxMemPool->pxFreeList = NULL;
+			pucBlock = pxMemPool->pucBlocksEnd;
+			for( ux = 0; ux < uxBlockCount; ux++ )
+			{
+				pucBlock -= xBlockSize;
+				( ( MemPoolFreeBlock_t * ) pucBlock )->pxNext = pxMemPool->pxFreeList; /*lint !e826 !e9087 Blocks are aligned and at least a pointer in size. */
+				pxMemPool->pxFreeList = ( MemPoolFreeBlock_t * ) pucBlock; /*lint !e826 !e9087 As above. */
+			}
+		}
+		else
+		{
+			vPortFree( pxMemPool );
+			pxMemPool = NULL;
+		}
+	}
+
+	return ( MemPoolHandle_t ) pxMemPool;
+}
+/*-----------------------------------------------------------*/
+
+void vMemPoolDelete( MemPoolHandle_t xMemPool )
+{
+MemPool_t * const pxMemPool = ( MemPool_t * ) xMemPool; /*lint !e9087 !e9079 Safe cast as MemPoolHandle_t is opaque MemPool_t. */
+
+	configASSERT( pxMemPool );
+
+	vSemaphoreDelete( pxMemPool->xFreeBlocks );
+	vPortFree( pxMemPool );
+}
+/*-----------------------------------------------------------*/
+
+static void *prvPopFreeBlock( MemPool_t * const pxMemPool )
+{
+MemPoolFreeBlock_t * const pxBlock = pxMemPool->pxFreeList;
+
+	configASSERT( pxBlock );
+
+	pxMemPool->pxFreeList = pxBlock->pxNext;
+	pxMemPool->uxFreeCount--;
+
+	if( pxMemPool->uxFreeCount < pxMemPool->uxMinimumEverFreeCount )
+	{
+		pxMemPool->uxMinimumEverFreeCount = pxMemPool->uxFreeCount;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return ( void * ) pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPushFreeBlock( MemPool_t * const pxMemPool, void *pvBlock )
+{
+MemPoolFreeBlock_t * const pxBlock = ( MemPoolFreeBlock_t * ) pvBlock; /*lint !e9087 Blocks are aligned and at least a pointer in size. */
+BaseType_t xReturn = pdFAIL;
+
+	/* The block must come from this pool and start on a block boundary.  The
+	boundary check takes a division, which the Cortex-M0 does in software, but
+	only when configASSERT() is defined. */
+	configASSERT( ( ( uint8_t * ) pvBlock >= pxMemPool->pucBlocks ) && ( ( uint8_t * ) pvBlock < pxMemPool->pucBlocksEnd ) );
+	configASSERT( ( ( size_t ) ( ( uint8_t * ) pvBlock - pxMemPool->pucBlocks ) % pxMemPool->xBlockSize ) == ( size_t ) 0 );
+
+	/* Linking the block again would make the list cyclic, so the free is
+	refused even when configASSERT() is not defined. */
+	configASSERT( pxMemPool->uxFreeCount < pxMemPool->uxBlockCount );
+
+	if( pxMemPool->uxFreeCount < pxMemPool->uxBlockCount )
+	{
+		pxBlock->pxNext = pxMemPool->pxFreeList;
+		pxMemPool->pxFreeList = pxBlock;
+		pxMemPool->uxFreeCount++;
+		xReturn = pdPASS;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvMemPoolAlloc( MemPoolHandle_t xMemPool, TickType_t xTicksToWait )
+{
+MemPool_t * const pxMemPool = ( MemPool_t * ) xMemPool; /*lint !e9087 !e9079 Safe cast as MemPoolHandle_t is opaque MemPool_t. */
+void *pvReturn = NULL;
+
+	configASSERT( pxMemPool );
+
+	/* Each count of the semaphore is a block on the free list, so once a
+	count is taken a block is reserved for this task. */
+	if( xSemaphoreTake( pxMemPool->xFreeBlocks, xTicksToWait ) == pdTRUE )
+	{
+		taskENTER_CRITICAL();
+		{
+			pvReturn = prvPopFreeBlock( pxMemPool );
+		}
+		taskEXIT_CRITICAL();
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvMemPoolAllocFromISR( MemPoolHandle_t xMemPool )
+{
+MemPool_t * const pxMemPool = ( MemPool_t * ) xMemPool; /*lint !e9087 !e9079 Safe cast as MemPoolHandle_t is opaque MemPool_t. */
+UBaseType_t uxSavedInterruptStatus;
+void *pvReturn = NULL;
+
+	configASSERT( pxMemPool );
+
+	/* Nothing ever waits to give the semaphore, so taking it cannot wake a
+	task. */
+	if( xSemaphoreTakeFromISR( pxMemPool->xFreeBlocks, NULL ) == pdTRUE )
+	{
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			pvReturn = prvPopFreeBlock( pxMemPool );
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vMemPoolFree( MemPoolHandle_t xMemPool, void *pvBlock )
+{
+MemPool_t * const pxMemPool = ( MemPool_t * ) xMemPool; /*lint !e9087 !e9079 Safe cast as MemPoolHandle_t is opaque MemPool_t. */
+BaseType_t xReturn;
+
+	configASSERT( pxMemPool );
+	configASSERT( pvBlock );
+
+	taskENTER_CRITICAL();
+	{
+		xReturn = prvPushFreeBlock( pxMemPool, pvBlock );
+	}
+	taskEXIT_CRITICAL();
+
+	/* The block is listed before it is counted, so a task woken by the give
+	always finds it. */
+	if( xReturn != pdFAIL )
+	{
+		( void ) xSemaphoreGive( pxMemPool->xFreeBlocks );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vMemPoolFreeFromISR( MemPoolHandle_t xMemPool, void *pvBlock, BaseType_t *pxHigherPriorityTaskWoken )
+{
+MemPool_t * const pxMemPool = ( MemPool_t * ) xMemPool; /*lint !e9087 !e9079 Safe cast as MemPoolHandle_t is opaque MemPool_t. */
+UBaseType_t uxSavedInterruptStatus;
+BaseType_t xReturn;
+
+	configASSERT( pxMemPool );
+	configASSERT( pvBlock );
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		xReturn = prvPushFreeBlock( pxMemPool, pvBlock );
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	if( xReturn != pdFAIL )
+	{
+		( void ) xSemaphoreGiveFromISR( pxMemPool->xFreeBlocks, pxHigherPriorityTaskWoken );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMemPoolGetFreeCount( MemPoolHandle_t xMemPool )
+{
+MemPool_t * const pxMemPool = ( MemPool_t * ) xMemPool; /*lint !e9087 !e9079 Safe cast as MemPoolHandle_t is opaque MemPool_t. */
+
+	configASSERT( pxMemPool );
+
+	/* The count of the semaphore, not the length of the list, so blocks being
+	freed are only counted once a task can take them. */
+	return uxSemaphoreGetCount( pxMemPool->xFreeBlocks );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMemPoolGetMinimumEverFreeCount( MemPoolHandle_t xMemPool )
+{
+MemPool_t * const pxMemPool = ( MemPool_t * ) xMemPool; /*lint !e9087 !e9079 Safe cast as MemPoolHandle_t is opaque MemPool_t. */
+
+	configASSERT( pxMemPool );
+
+	return pxMemPool->uxMinimumEverFreeCount;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMemPoolGetBlockSize( MemPoolHandle_t xMemPool )
+{
+MemPool_t * const pxMemPool = ( MemPool_t * ) xMemPool; /*lint !e9087 !e9079 Safe cast as MemPoolHandle_t is opaque MemPool_t. */
+
+	configASSERT( pxMemPool );
+
+	return pxMemPool->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_COUNTING_SEMAPHORES == 1 ) */
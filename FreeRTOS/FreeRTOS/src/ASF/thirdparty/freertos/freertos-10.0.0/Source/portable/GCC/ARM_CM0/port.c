@@ -47,6 +47,7 @@
 #define portMIN_INTERRUPT_PRIORITY		( 255UL )
 #define portNVIC_PENDSV_PRI				( portMIN_INTERRUPT_PRIORITY << 16UL )
 #define portNVIC_SYSTICK_PRI			( portMIN_INTERRUPT_PRIORITY << 24UL )
+#define portMAX_24_BIT_NUMBER			( 0xffffffUL )
 
 /* Constants required to set up the initial stack. */
 #define portINITIAL_XPSR			( 0x01000000 )
@@ -60,16 +61,43 @@ debugger. */
 	#define portTASK_RETURN_ADDRESS	prvTaskExitError
 #endif
 
+#if( configUSE_TICKLESS_IDLE == 1 )
+
+	/* With tickless idle the tick comes from the RTC rather than SysTick, as
+	SysTick stops with the CPU clock in sleep and can only count 349ms at
+	48MHz.  The tick arithmetic is in portrtc.h. */
+	#include "portrtc.h"
+	#ifndef configRTC_GCLK_GENERATOR
+		#define configRTC_GCLK_GENERATOR	GCLK_CLKCTRL_GEN_GCLK1
+	#endif
+
+	/* Address of COUNT for the RTC read request. */
+	#define portRTC_READREQ_COUNT		( 0x10UL )
+
+#endif /* configUSE_TICKLESS_IDLE */
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
 static void prvSetupTimerInterrupt( void );
 
+#if( configUSE_TICKLESS_IDLE == 1 )
+
+	/*
+	 * RTC access for the tick.
+	 */
+	static void prvRtcSync( void );
+	static uint32_t prvRtcGetCount( void );
+	static void prvRtcSetCompare( uint32_t ulCompare );
+
+#endif /* configUSE_TICKLESS_IDLE */
+
 /*
  * Exception handlers.
  */
 void xPortPendSVHandler( void ) __attribute__ (( naked ));
 void xPortSysTickHandler( void );
+void xPortRtcTickHandler( void );
 void vPortSVCHandler( void );
 
 /*
@@ -88,6 +116,38 @@ static void prvTaskExitError( void );
 variable. */
 static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
 
+#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+
+	/* SysTick value when the outermost critical section was entered, and the
+	address it was entered from. */
+	static uint32_t ulCriticalEnterCount = 0;
+	static void *pvCriticalCaller = NULL;
+
+#endif /* configUSE_CRITICAL_SECTION_STATS */
+
+/*-----------------------------------------------------------*/
+
+#if( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+
+	/* Entry ( ( ( 2^( n + 1 ) ) - 1 ) * 0x07C4ACDD ) >> 27 holds n, see
+	uxPortGetHighestPriority(). */
+	const uint8_t ucPortDeBruijnBitPosition[ 32 ] =
+	{
+		0, 9, 1, 10, 13, 21, 2, 29, 11, 14, 16, 18, 22, 25, 3, 30,
+		8, 12, 20, 28, 15, 17, 24, 7, 19, 27, 23, 6, 26, 5, 4, 31
+	};
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TICKLESS_IDLE == 1 )
+
+	/* RTC count of the next tick, and the fraction of a count it has been
+	rounded down by, in units of 1 / configTICK_RATE_HZ counts. */
+	static uint32_t ulNextTickCount = 0;
+	static uint32_t ulNextTickFraction = 0;
+
+#endif /* configUSE_TICKLESS_IDLE */
 /*-----------------------------------------------------------*/
 
 /*
@@ -228,6 +288,17 @@ void vPortEnterCritical( void )
 {
     portDISABLE_INTERRUPTS();
     uxCriticalNesting++;
+
+	#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+	{
+		if( uxCriticalNesting == 1 )
+		{
+			pvCriticalCaller = __builtin_return_address( 0 );
+			ulCriticalEnterCount = *( portNVIC_SYSTICK_CURRENT_VALUE );
+		}
+	}
+	#endif /* configUSE_CRITICAL_SECTION_STATS */
+
 	__asm volatile( "dsb" ::: "memory" );
 	__asm volatile( "isb" );
 }
@@ -239,6 +310,23 @@ void vPortExitCritical( void )
     uxCriticalNesting--;
     if( uxCriticalNesting == 0 )
     {
+		#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+		{
+		uint32_t ulExitCount = *( portNVIC_SYSTICK_CURRENT_VALUE );
+		uint32_t ulCycles = ulCriticalEnterCount - ulExitCount;
+
+			/* SysTick counts down and reloads once per tick, or once every
+			2^24 cycles with tickless idle.  Sections are far shorter, so at
+			most one reload happened. */
+			if( ulExitCount > ulCriticalEnterCount )
+			{
+				ulCycles += *( portNVIC_SYSTICK_LOAD ) + 1UL;
+			}
+
+			configRECORD_CRITICAL_SECTION( pvCriticalCaller, ulCycles );
+		}
+		#endif /* configUSE_CRITICAL_SECTION_STATS */
+
         portENABLE_INTERRUPTS();
     }
 }
@@ -345,6 +433,8 @@ uint32_t ulPreviousMask;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TICKLESS_IDLE == 0 )
+
 /*
  * Setup the systick timer to generate the tick interrupts at the required
  * frequency.
@@ -361,3 +451,197 @@ void prvSetupTimerInterrupt( void )
 }
 /*-----------------------------------------------------------*/
 
+#else /* configUSE_TICKLESS_IDLE */
+
+/*
+ * Setup the RTC to generate the tick interrupts at the required frequency.
+ */
+void prvSetupTimerInterrupt( void )
+{
+	/* SysTick no longer generates the tick.  Leave it free running without an
+	interrupt so it can still be used as a cycle counter. */
+	*(portNVIC_SYSTICK_CTRL) = 0UL;
+	*(portNVIC_SYSTICK_LOAD) = portMAX_24_BIT_NUMBER;
+	*(portNVIC_SYSTICK_CURRENT_VALUE) = 0UL;
+	*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_ENABLE;
+
+	/* Clock the RTC from the 32 kHz generator. */
+	PM->APBAMASK.reg |= PM_APBAMASK_RTC;
+	GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID( RTC_GCLK_ID ) | configRTC_GCLK_GENERATOR | GCLK_CLKCTRL_CLKEN;
+	while( ( GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY ) != 0 )
+	{
+	}
+
+	/* A free running 32-bit counter, each tick is a compare match.  COUNT is
+	kept synchronised so it can be read without waiting. */
+	RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_SWRST;
+	while( ( RTC->MODE0.CTRL.reg & RTC_MODE0_CTRL_SWRST ) != 0 )
+	{
+	}
+	RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_MODE_COUNT32 | RTC_MODE0_CTRL_PRESCALER_DIV1;
+	RTC->MODE0.READREQ.reg = RTC_READREQ_RREQ | RTC_READREQ_RCONT | RTC_READREQ_ADDR( portRTC_READREQ_COUNT );
+
+	/* The counter starts from 0, the first tick is one tick period later. */
+	ulNextTickCount = portRTC_COUNTS_PER_TICK;
+	ulNextTickFraction = portRTC_TICK_REMAINDER;
+	prvRtcSetCompare( ulNextTickCount );
+	RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+	RTC->MODE0.INTENSET.reg = RTC_MODE0_INTENSET_CMP0;
+
+	/* Same priority as the kernel, like SysTick. */
+	NVIC_SetPriority( RTC_IRQn, ( 1UL << __NVIC_PRIO_BITS ) - 1UL );
+	NVIC_ClearPendingIRQ( RTC_IRQn );
+	NVIC_EnableIRQ( RTC_IRQn );
+
+	prvRtcSync();
+	RTC->MODE0.CTRL.reg |= RTC_MODE0_CTRL_ENABLE;
+	prvRtcSync();
+}
+/*-----------------------------------------------------------*/
+
+static void prvRtcSync( void )
+{
+	while( ( RTC->MODE0.STATUS.reg & RTC_STATUS_SYNCBUSY ) != 0 )
+	{
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRtcGetCount( void )
+{
+	/* The last value synchronised, a few counts behind, see
+	portRTC_MIN_LEAD. */
+	return RTC->MODE0.COUNT.reg;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRtcSetCompare( uint32_t ulCompare )
+{
+	/* Only waits if the previous compare value is still being synchronised,
+	which is never the case for the compare of the next tick, set a tick
+	after the previous one. */
+	prvRtcSync();
+	RTC->MODE0.COMP[ 0 ].reg = ulCompare;
+}
+/*-----------------------------------------------------------*/
+
+void xPortRtcTickHandler( void )
+{
+uint32_t ulPreviousMask, ulCount;
+BaseType_t xSwitchRequired = pdFALSE;
+
+	ulPreviousMask = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+
+		/* The compare matched, so at least one tick is due.  Count every tick
+		up to the first one that can still be set as the compare, in case the
+		interrupt was held off for more than a tick - the compare only matches
+		once per 2^32 counts if it is missed. */
+		ulCount = prvRtcGetCount();
+		do
+		{
+			/* Increment the RTOS tick. */
+			if( xTaskIncrementTick() != pdFALSE )
+			{
+				xSwitchRequired = pdTRUE;
+			}
+
+			vPortRtcNextTick( &ulNextTickCount, &ulNextTickFraction );
+		} while( ( int32_t ) ( ulNextTickCount - ulCount ) < portRTC_MIN_LEAD );
+
+		prvRtcSetCompare( ulNextTickCount );
+
+		if( xSwitchRequired != pdFALSE )
+		{
+			/* Pend a context switch. */
+			*(portNVIC_INT_CTRL) = portNVIC_PENDSVSET;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( ulPreviousMask );
+}
+/*-----------------------------------------------------------*/
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+uint32_t ulCount, ulCompleteTickPeriods;
+TickType_t xModifiableIdleTime, xTicksToStep;
+
+	/* Limit the sleep so its length in counts fits the arithmetic below. */
+	if( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+	{
+		xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+	}
+
+	/* Enter a critical section but don't use the taskENTER_CRITICAL() method
+	as that will mask interrupts that should exit sleep mode. */
+	__asm volatile( "cpsid i" ::: "memory" );
+	__asm volatile( "dsb" );
+	__asm volatile( "isb" );
+
+	/* If a context switch is pending or a task is waiting for the scheduler
+	to be unsuspended then abandon the low power entry.  Also leave a tick that
+	is too close to be moved to the tick interrupt. */
+	ulCount = prvRtcGetCount();
+	if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) ||
+		( ( int32_t ) ( ulNextTickCount - ulCount ) < portRTC_MIN_LEAD ) )
+	{
+		__asm volatile( "cpsie i" ::: "memory" );
+		return;
+	}
+
+	/* Move the compare to the tick the next task unblocks on.  The tick
+	interrupt is left enabled, it is what brings the MCU out of sleep, but
+	cannot run before interrupts are enabled again below. */
+	prvRtcSetCompare( ulPortRtcTickAfter( ulNextTickCount, ulNextTickFraction, xExpectedIdleTime - 1 ) );
+
+	/* Sleep until something happens.  configPRE_SLEEP_PROCESSING() can set
+	its parameter to 0 to indicate that its implementation contains its own
+	wait for interrupt or wait for event instruction, and so wfi should not be
+	executed again.  It may also select a deeper sleep mode, as long as the
+	RTC generator runs in it. */
+	xModifiableIdleTime = xExpectedIdleTime;
+	configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+	if( xModifiableIdleTime > 0 )
+	{
+		__asm volatile( "dsb" ::: "memory" );
+		__asm volatile( "wfi" );
+		__asm volatile( "isb" );
+	}
+	configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+	/* Count the ticks that passed, from the RTC, which kept counting.  Ticks
+	up to portRTC_MIN_LEAD counts ahead are counted too, the compare is set
+	for the first tick after those. */
+	ulCount = prvRtcGetCount() + ( uint32_t ) portRTC_MIN_LEAD;
+	ulCompleteTickPeriods = ulPortRtcPassTicks( &ulNextTickCount, &ulNextTickFraction, ulCount );
+	prvRtcSetCompare( ulNextTickCount );
+
+	/* The sleep compare may have matched, its tick has been counted. */
+	RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+	NVIC_ClearPendingIRQ( RTC_IRQn );
+
+	/* Step the tick count over the ticks that passed.  vTaskStepTick() must
+	not reach the tick the next task unblocks on, as that task is unblocked
+	by xTaskIncrementTick(), which is called for the rest as the tick
+	interrupt would.  The scheduler is suspended, so those calls only pend
+	the ticks until xTaskResumeAll(). */
+	xTicksToStep = ( TickType_t ) ulCompleteTickPeriods;
+	if( xTicksToStep >= xExpectedIdleTime )
+	{
+		xTicksToStep = xExpectedIdleTime - 1;
+	}
+	vTaskStepTick( xTicksToStep );
+	while( ulCompleteTickPeriods > ( uint32_t ) xTicksToStep )
+	{
+		( void ) xTaskIncrementTick();
+		ulCompleteTickPeriods--;
+	}
+
+	/* Exit with interrupts enabled, so the interrupt that brought the MCU out
+	of sleep mode runs. */
+	__asm volatile( "cpsie i" ::: "memory" );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TICKLESS_IDLE */
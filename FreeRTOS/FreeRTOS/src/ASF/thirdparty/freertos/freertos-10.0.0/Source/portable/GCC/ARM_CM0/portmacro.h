@@ -102,6 +102,65 @@ extern void vClearInterruptMaskFromISR( uint32_t ulMask )  __attribute__((naked)
 
 /*-----------------------------------------------------------*/
 
+/* Tickless idle/low power functionality. */
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specific optimisations. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#endif
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* Check the configuration. */
+	#if( configMAX_PRIORITIES > 32 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
+	#endif
+
+	/* Store/clear the ready priorities in a bit map. */
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	/*-----------------------------------------------------------*/
+
+	/* The Cortex-M0 has no CLZ instruction.  Instead every bit below the
+	highest set bit of the bit map is set, which leaves one of only 32 possible
+	values, and that value is turned into the bit number with a De Bruijn
+	multiply and a table look up.  The cost is the same whatever priorities are
+	ready, there are no branches and the shifts that cannot change anything for
+	configMAX_PRIORITIES are left out. */
+	extern const uint8_t ucPortDeBruijnBitPosition[ 32 ];
+
+	static inline UBaseType_t uxPortGetHighestPriority( UBaseType_t uxReadyPriorities ) __attribute__( ( always_inline ) );
+	static inline UBaseType_t uxPortGetHighestPriority( UBaseType_t uxReadyPriorities )
+	{
+	uint32_t ulBits = ( uint32_t ) uxReadyPriorities;
+
+		ulBits |= ulBits >> 1;
+		ulBits |= ulBits >> 2;
+		#if( configMAX_PRIORITIES > 4 )
+			ulBits |= ulBits >> 4;
+		#endif
+		#if( configMAX_PRIORITIES > 8 )
+			ulBits |= ulBits >> 8;
+		#endif
+		#if( configMAX_PRIORITIES > 16 )
+			ulBits |= ulBits >> 16;
+		#endif
+
+		return ( UBaseType_t ) ucPortDeBruijnBitPosition[ ( uint32_t ) ( ulBits * 0x07C4ACDDUL ) >> 27UL ];
+	}
+
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = uxPortGetHighestPriority( uxReadyPriorities )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+
+/*-----------------------------------------------------------*/
+
 /* Task function macros as described on the FreeRTOS.org WEB site. */
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
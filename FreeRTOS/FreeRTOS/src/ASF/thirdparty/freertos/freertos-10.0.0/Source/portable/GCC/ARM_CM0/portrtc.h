@@ -0,0 +1,113 @@
+/*
+ * FreeRTOS Kernel V10.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Tick arithmetic of the RTC tick of port.c, for tickless idle.  It is kept
+ * apart from the RTC access so the host simulator can test it on its own, see
+ * sim/rtc_tick_test.c.  Include FreeRTOS.h first.
+ */
+
+#ifndef PORTRTC_H
+#define PORTRTC_H
+
+/* The RTC is clocked from a 32 kHz generator, by default GCLK1 which
+conf_clocks.h sources from XOSC32K. */
+#ifndef configRTC_CLOCK_HZ
+	#define configRTC_CLOCK_HZ			( 32768UL )
+#endif
+
+/* A tick is a whole number of RTC counts plus a fraction, in units of
+1 / configTICK_RATE_HZ counts.  The fractions are carried from tick to tick
+so tick n is always at count ( n * configRTC_CLOCK_HZ ) / configTICK_RATE_HZ
+and the tick count never drifts from the RTC, however long the sleeps. */
+#define portRTC_COUNTS_PER_TICK		( configRTC_CLOCK_HZ / configTICK_RATE_HZ )
+#define portRTC_TICK_REMAINDER		( configRTC_CLOCK_HZ % configTICK_RATE_HZ )
+
+/* COUNT, read with continuous read synchronisation, lags the counter by up
+to about six RTC clocks, and a new compare value takes as long again to
+reach the counter.  A compare value closer than this to the last COUNT read
+may be passed before it takes effect. */
+#define portRTC_MIN_LEAD			( 16L )
+
+/* The longest sleep.  On wake-up the elapsed counts, including any time
+spent past the compare before the MCU ran again and portRTC_MIN_LEAD, are
+multiplied by configTICK_RATE_HZ.  Half of the 32-bit range, less a tick for
+the lead and the rounding, keeps that product clear of overflow with the
+other half as headroom, 65534 ticks at 1 kHz. */
+#define portMAX_SUPPRESSED_TICKS	( ( TickType_t ) ( ( ( 0xffffffffUL / configRTC_CLOCK_HZ ) / 2UL ) - 1UL ) )
+
+/*
+ * Moves the next tick, at count *pulCount plus *pulFraction, on by one tick
+ * period.
+ */
+static inline void vPortRtcNextTick( uint32_t *pulCount, uint32_t *pulFraction )
+{
+	*pulCount += portRTC_COUNTS_PER_TICK;
+	*pulFraction += portRTC_TICK_REMAINDER;
+	if( *pulFraction >= configTICK_RATE_HZ )
+	{
+		*pulFraction -= configTICK_RATE_HZ;
+		( *pulCount )++;
+	}
+}
+
+/*
+ * The count of the tick xTicks tick periods after the next tick, at ulCount
+ * plus ulFraction.  xTicks must not be above portMAX_SUPPRESSED_TICKS.
+ */
+static inline uint32_t ulPortRtcTickAfter( uint32_t ulCount, uint32_t ulFraction, TickType_t xTicks )
+{
+	return ulCount + ( ( ( ( uint32_t ) xTicks * configRTC_CLOCK_HZ ) + ulFraction ) / configTICK_RATE_HZ );
+}
+
+/*
+ * Returns how many ticks from the next one are at or before count ulNow, and
+ * moves the next tick to the first one after those.  The next tick must not be
+ * more than twice portMAX_SUPPRESSED_TICKS tick periods plus portRTC_MIN_LEAD
+ * counts before ulNow.
+ */
+static inline uint32_t ulPortRtcPassTicks( uint32_t *pulCount, uint32_t *pulFraction, uint32_t ulNow )
+{
+uint32_t ulCounts, ulTicks = 0;
+
+	if( ( int32_t ) ( ulNow - *pulCount ) >= 0 )
+	{
+		/* The last tick passed is the one the largest whole number of tick
+		periods after the next tick that is not after ulNow. */
+		ulCounts = ( ( ulNow - *pulCount ) + 1UL ) * configTICK_RATE_HZ;
+		ulTicks = ( ( ulCounts - *pulFraction - 1UL ) / configRTC_CLOCK_HZ ) + 1UL;
+
+		ulCounts = ( ulTicks * configRTC_CLOCK_HZ ) + *pulFraction;
+		*pulCount += ulCounts / configTICK_RATE_HZ;
+		*pulFraction = ulCounts % configTICK_RATE_HZ;
+	}
+
+	return ulTicks;
+}
+
+#endif /* PORTRTC_H */
@@ -0,0 +1,568 @@
+/*
+ * FreeRTOS Kernel V10.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+/*
+ * A two level segregated fit (TLSF) implementation of pvPortMalloc() and
+ * vPortFree().  Unlike heap_1.c, memory can be freed again, so tasks, queues
+ * and timers can be deleted.
+ *
+ * Free blocks are kept in lists by size class.  The first level splits sizes
+ * into powers of two, the second level splits each power of two into
+ * heapSL_INDEX_COUNT equal ranges.  A bit map per level records which lists
+ * are not empty, so an allocation finds a list whose blocks are all big enough
+ * with two bit scans, and a free merges the block with its free neighbours in
+ * memory before listing it.  A free, and an allocation that the bit scans
+ * satisfy, take the same time whatever the number of blocks.  Only when no
+ * list above the requested size has a block does an allocation walk the list
+ * of the size's own class, so that the largest free block can still be
+ * handed out; that walk grows with the number of free blocks in that one
+ * class.  Merging on every free keeps fragmentation low.
+ *
+ * Every block starts with a header holding its size and the address of the
+ * block below it, which costs heapHEADER_SIZE bytes per allocation.
+ *
+ * See heap_1.c for an implementation that cannot free but has no overhead.
+ */
+#include <stdlib.h>
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* A few bytes might be lost to byte aligning the heap start address. */
+#define configADJUSTED_HEAP_SIZE	( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT )
+
+/* Floor of log2( x ) for a constant x below 2^32, so the size of the list
+tables can follow configTOTAL_HEAP_SIZE. */
+#define heapLOG2_2( x )		( ( ( x ) & 0x2UL ) ? 1 : 0 )
+#define heapLOG2_4( x )		( ( ( x ) & 0xCUL ) ? ( 2 + heapLOG2_2( ( x ) >> 2 ) ) : heapLOG2_2( x ) )
+#define heapLOG2_8( x )		( ( ( x ) & 0xF0UL ) ? ( 4 + heapLOG2_4( ( x ) >> 4 ) ) : heapLOG2_4( x ) )
+#define heapLOG2_16( x )	( ( ( x ) & 0xFF00UL ) ? ( 8 + heapLOG2_8( ( x ) >> 8 ) ) : heapLOG2_8( x ) )
+#define heapLOG2( x )		( ( ( x ) & 0xFFFF0000UL ) ? ( 16 + heapLOG2_16( ( x ) >> 16 ) ) : heapLOG2_16( x ) )
+
+/* Each power of two is split into 2^heapSL_INDEX_COUNT_LOG2 size classes, so a
+block is at most 1/8th bigger than the smallest size of its class. */
+#define heapSL_INDEX_COUNT_LOG2		( 3 )
+#define heapSL_INDEX_COUNT			( 1UL << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks smaller than heapSMALL_BLOCK_SIZE all go in the first first level
+list, split into classes portBYTE_ALIGNMENT bytes wide.  Bigger blocks go in
+the first level of their highest set bit. */
+#define heapALIGNMENT_LOG2			heapLOG2( portBYTE_ALIGNMENT )
+#define heapFL_INDEX_SHIFT			( heapSL_INDEX_COUNT_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+#define heapFL_INDEX_COUNT			( heapLOG2( configADJUSTED_HEAP_SIZE ) - heapFL_INDEX_SHIFT + 2 )
+
+/* Block sizes are multiples of portBYTE_ALIGNMENT, which leaves the lowest
+bit free to mark free blocks. */
+#define heapBLOCK_FREE_BIT			( ( size_t ) 1 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xSize & ~heapBLOCK_FREE_BIT )
+#define heapBLOCK_IS_FREE( pxBlock )	( ( ( pxBlock )->xSize & heapBLOCK_FREE_BIT ) != 0 )
+#define heapNEXT_PHYSICAL( pxBlock )	( ( BlockLink_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/*-----------------------------------------------------------*/
+
+/* Header of every block.  The free list links overlap the data of allocated
+blocks, only the fields before pxNextFree are kept while a block is in use. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxPrevPhysical;	/*<< The block just below this one in memory, NULL for the first block. */
+	size_t xSize;							/*<< Size of the block including its header, heapBLOCK_FREE_BIT set while it is free. */
+	struct A_BLOCK_LINK *pxNextFree;		/*<< Next block of the same size class, free blocks only. */
+	struct A_BLOCK_LINK *pxPrevFree;		/*<< Previous block of the same size class, free blocks only. */
+} BlockLink_t;
+
+/* Bytes a block spends on its header, and the smallest block that can hold
+the free list links once freed. */
+#define heapHEADER_SIZE				( ( offsetof( BlockLink_t, pxNextFree ) + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define heapMINIMUM_BLOCK_SIZE		( ( sizeof( BlockLink_t ) + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Index of the highest set bit of a non zero value.
+ */
+static uint32_t prvFindLastSet( uint32_t ulValue );
+
+/*
+ * Index of the lowest set bit of a non zero value.
+ */
+static uint32_t prvFindFirstSet( uint32_t ulValue );
+
+/*
+ * The size class a block of xSize bytes is listed in.
+ */
+static void prvMappingInsert( size_t xSize, uint32_t *pulFirstLevel, uint32_t *pulSecondLevel );
+
+/*
+ * Adds a free block to the list of its size class, or takes it out again.
+ */
+static void prvInsertFreeBlock( BlockLink_t *pxBlock );
+static void prvRemoveFreeBlock( BlockLink_t *pxBlock );
+
+/*
+ * Finds a free block of at least xBlockSize bytes, NULL if there is none.
+ */
+static BlockLink_t *prvFindFreeBlock( size_t xBlockSize );
+
+/*
+ * Turns the heap into a single free block, followed by an empty block that
+ * stops the merging of the last block.  Called automatically by the first
+ * call to pvPortMalloc().
+ */
+static void prvHeapInit( void );
+
+/*-----------------------------------------------------------*/
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	/* The application writer has already defined the array used for the RTOS
+	heap - probably so it can be placed in a special segment or address. */
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* Heads of the free lists, and bit maps of the lists that are not empty: bit
+n of ulFirstLevelMap is set when ulSecondLevelMap[ n ] is not 0, bit m of
+ulSecondLevelMap[ n ] when pxFreeLists[ n ][ m ] is not NULL. */
+static BlockLink_t *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+static uint32_t ulFirstLevelMap = 0;
+static uint32_t ulSecondLevelMap[ heapFL_INDEX_COUNT ];
+
+static BaseType_t xHeapInitialised = pdFALSE;
+
+/* Statistics, including headers. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+static size_t xNumberOfSuccessfulAllocations = 0U;
+static size_t xNumberOfSuccessfulFrees = 0U;
+
+/* The Cortex-M0 has no CLZ instruction, so the highest set bit is found as in
+uxPortGetHighestPriority(): every bit below it is set, and the result turned
+into the bit number with a De Bruijn multiply and a table look up. */
+static const uint8_t ucDeBruijnBitPosition[ 32 ] =
+{
+	0, 9, 1, 10, 13, 21, 2, 29, 11, 14, 16, 18, 22, 25, 3, 30,
+	8, 12, 20, 28, 15, 17, 24, 7, 19, 27, 23, 6, 26, 5, 4, 31
+};
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvFindLastSet( uint32_t ulValue )
+{
+	ulValue |= ulValue >> 1UL;
+	ulValue |= ulValue >> 2UL;
+	ulValue |= ulValue >> 4UL;
+	ulValue |= ulValue >> 8UL;
+	ulValue |= ulValue >> 16UL;
+
+	return ( uint32_t ) ucDeBruijnBitPosition[ ( uint32_t ) ( ulValue * 0x07C4ACDDUL ) >> 27UL ];
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvFindFirstSet( uint32_t ulValue )
+{
+	/* Keep only the lowest set bit. */
+	return prvFindLastSet( ulValue & ( 0UL - ulValue ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, uint32_t *pulFirstLevel, uint32_t *pulSecondLevel )
+{
+uint32_t ulLastSet;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		*pulFirstLevel = 0UL;
+		*pulSecondLevel = ( uint32_t ) ( xSize >> heapALIGNMENT_LOG2 );
+	}
+	else
+	{
+		/* The bits below the highest set bit select the second level. */
+		ulLastSet = prvFindLastSet( ( uint32_t ) xSize );
+		*pulSecondLevel = ( uint32_t ) ( xSize >> ( ulLastSet - heapSL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT;
+		*pulFirstLevel = ulLastSet - ( heapFL_INDEX_SHIFT - 1UL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( BlockLink_t *pxBlock )
+{
+uint32_t ulFirstLevel, ulSecondLevel;
+BlockLink_t *pxHead;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &ulFirstLevel, &ulSecondLevel );
+	pxHead = pxFreeLists[ ulFirstLevel ][ ulSecondLevel ];
+
+	pxBlock->xSize |= heapBLOCK_FREE_BIT;
+	pxBlock->pxPrevFree = NULL;
+	pxBlock->pxNextFree = pxHead;
+	if( pxHead != NULL )
+	{
+		pxHead->pxPrevFree = pxBlock;
+	}
+	pxFreeLists[ ulFirstLevel ][ ulSecondLevel ] = pxBlock;
+
+	ulFirstLevelMap |= 1UL << ulFirstLevel;
+	ulSecondLevelMap[ ulFirstLevel ] |= 1UL << ulSecondLevel;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( BlockLink_t *pxBlock )
+{
+uint32_t ulFirstLevel, ulSecondLevel;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &ulFirstLevel, &ulSecondLevel );
+
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+	}
+	if( pxBlock->pxPrevFree != NULL )
+	{
+		pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+	}
+	else
+	{
+		/* The block was the head of its list. */
+		pxFreeLists[ ulFirstLevel ][ ulSecondLevel ] = pxBlock->pxNextFree;
+		if( pxBlock->pxNextFree == NULL )
+		{
+			ulSecondLevelMap[ ulFirstLevel ] &= ~( 1UL << ulSecondLevel );
+			if( ulSecondLevelMap[ ulFirstLevel ] == 0UL )
+			{
+				ulFirstLevelMap &= ~( 1UL << ulFirstLevel );
+			}
+		}
+	}
+
+	pxBlock->xSize &= ~heapBLOCK_FREE_BIT;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvFindFreeBlock( size_t xBlockSize )
+{
+uint32_t ulFirstLevel, ulSecondLevel, ulMap;
+size_t xRoundedSize = xBlockSize;
+BlockLink_t *pxBlock;
+
+	/* Round the size up to the next class boundary, then every block of the
+	class found is big enough and the head of its list can be taken. */
+	if( xRoundedSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xRoundedSize += ( ( size_t ) 1 << ( prvFindLastSet( ( uint32_t ) xRoundedSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1U;
+	}
+	prvMappingInsert( xRoundedSize, &ulFirstLevel, &ulSecondLevel );
+
+	if( ulFirstLevel < heapFL_INDEX_COUNT )
+	{
+		ulMap = ulSecondLevelMap[ ulFirstLevel ] & ( ~0UL << ulSecondLevel );
+		if( ulMap == 0UL )
+		{
+			/* Nothing in this first level, take the smallest class of the
+			next first level that is not empty. */
+			ulMap = ( ulFirstLevel + 1UL < 32UL ) ? ( ulFirstLevelMap & ( ~0UL << ( ulFirstLevel + 1UL ) ) ) : 0UL;
+			if( ulMap != 0UL )
+			{
+				ulFirstLevel = prvFindFirstSet( ulMap );
+				ulMap = ulSecondLevelMap[ ulFirstLevel ];
+			}
+		}
+
+		if( ulMap != 0UL )
+		{
+			return pxFreeLists[ ulFirstLevel ][ prvFindFirstSet( ulMap ) ];
+		}
+	}
+
+	/* The rounding skipped the class of the size itself, where some blocks may
+	still be big enough.  Search it, so that a request for the largest free
+	block succeeds. */
+	prvMappingInsert( xBlockSize, &ulFirstLevel, &ulSecondLevel );
+	for( pxBlock = pxFreeLists[ ulFirstLevel ][ ulSecondLevel ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+	{
+		if( heapBLOCK_SIZE( pxBlock ) >= xBlockSize )
+		{
+			break;
+		}
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+BlockLink_t *pxBlock, *pxRemainder;
+size_t xBlockSize;
+void *pvReturn = NULL;
+
+	/* The block holds the header too, and is a multiple of the alignment so
+	the next block is aligned as well. */
+	if( ( xWantedSize > 0U ) && ( xWantedSize <= configADJUSTED_HEAP_SIZE ) )
+	{
+		xBlockSize = ( xWantedSize + heapHEADER_SIZE + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+		if( xBlockSize < heapMINIMUM_BLOCK_SIZE )
+		{
+			xBlockSize = heapMINIMUM_BLOCK_SIZE;
+		}
+	}
+	else
+	{
+		xBlockSize = 0U;
+	}
+
+	vTaskSuspendAll();
+	{
+		if( xHeapInitialised == pdFALSE )
+		{
+			prvHeapInit();
+		}
+
+		if( ( xBlockSize != 0U ) && ( xBlockSize <= xFreeBytesRemaining ) )
+		{
+			pxBlock = prvFindFreeBlock( xBlockSize );
+			if( pxBlock != NULL )
+			{
+				prvRemoveFreeBlock( pxBlock );
+
+				/* Give the end of the block back if it can make a block of
+				its own. */
+				if( ( pxBlock->xSize - xBlockSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					pxRemainder = ( BlockLink_t * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+					pxRemainder->xSize = pxBlock->xSize - xBlockSize;
+					pxRemainder->pxPrevPhysical = pxBlock;
+					heapNEXT_PHYSICAL( pxRemainder )->pxPrevPhysical = pxRemainder;
+					pxBlock->xSize = xBlockSize;
+					prvInsertFreeBlock( pxRemainder );
+				}
+
+				xFreeBytesRemaining -= pxBlock->xSize;
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				xNumberOfSuccessfulAllocations++;
+
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + heapHEADER_SIZE );
+			}
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	configASSERT( ( ( ( portPOINTER_SIZE_TYPE ) pvReturn ) & ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) == 0 );
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+BlockLink_t *pxBlock, *pxNeighbour;
+
+	if( pv == NULL )
+	{
+		return;
+	}
+
+	pxBlock = ( BlockLink_t * ) ( ( ( uint8_t * ) pv ) - heapHEADER_SIZE );
+
+	/* Catch double frees and pointers that were not returned by
+	pvPortMalloc(). */
+	configASSERT( heapBLOCK_IS_FREE( pxBlock ) == pdFALSE );
+	configASSERT( pxBlock->xSize >= heapMINIMUM_BLOCK_SIZE );
+
+	vTaskSuspendAll();
+	{
+		xFreeBytesRemaining += pxBlock->xSize;
+		xNumberOfSuccessfulFrees++;
+		traceFREE( pv, pxBlock->xSize );
+
+		/* Merge with the free neighbours, so free memory is never split into
+		more blocks than necessary. */
+		pxNeighbour = heapNEXT_PHYSICAL( pxBlock );
+		if( heapBLOCK_IS_FREE( pxNeighbour ) != pdFALSE )
+		{
+			prvRemoveFreeBlock( pxNeighbour );
+			pxBlock->xSize += pxNeighbour->xSize;
+		}
+
+		pxNeighbour = pxBlock->pxPrevPhysical;
+		if( ( pxNeighbour != NULL ) && ( heapBLOCK_IS_FREE( pxNeighbour ) != pdFALSE ) )
+		{
+			prvRemoveFreeBlock( pxNeighbour );
+			pxNeighbour->xSize += pxBlock->xSize;
+			pxBlock = pxNeighbour;
+		}
+
+		heapNEXT_PHYSICAL( pxBlock )->pxPrevPhysical = pxBlock;
+		prvInsertFreeBlock( pxBlock );
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlockSize( void )
+{
+uint32_t ulFirstLevel;
+BlockLink_t *pxBlock;
+size_t xLargest = 0U;
+
+	vTaskSuspendAll();
+	{
+		/* The largest block is in the highest class that is not empty, but
+		not necessarily at the head of its list. */
+		if( ulFirstLevelMap != 0UL )
+		{
+			ulFirstLevel = prvFindLastSet( ulFirstLevelMap );
+			pxBlock = pxFreeLists[ ulFirstLevel ][ prvFindLastSet( ulSecondLevelMap[ ulFirstLevel ] ) ];
+			for( ; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+			{
+				if( heapBLOCK_SIZE( pxBlock ) > xLargest )
+				{
+					xLargest = heapBLOCK_SIZE( pxBlock );
+				}
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	/* The largest pvPortMalloc() request that succeeds. */
+	return ( xLargest > heapHEADER_SIZE ) ? ( xLargest - heapHEADER_SIZE ) : 0U;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+uint32_t ulFirstLevel, ulSecondLevel;
+BlockLink_t *pxBlock;
+size_t xLargest = 0U, xSmallest = ( size_t ) -1, xBlocks = 0U;
+
+	vTaskSuspendAll();
+	{
+		for( ulFirstLevel = 0UL; ulFirstLevel < heapFL_INDEX_COUNT; ulFirstLevel++ )
+		{
+			for( ulSecondLevel = 0UL; ulSecondLevel < heapSL_INDEX_COUNT; ulSecondLevel++ )
+			{
+				for( pxBlock = pxFreeLists[ ulFirstLevel ][ ulSecondLevel ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+				{
+					xBlocks++;
+					if( heapBLOCK_SIZE( pxBlock ) > xLargest )
+					{
+						xLargest = heapBLOCK_SIZE( pxBlock );
+					}
+					if( heapBLOCK_SIZE( pxBlock ) < xSmallest )
+					{
+						xSmallest = heapBLOCK_SIZE( pxBlock );
+					}
+				}
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	( void ) xTaskResumeAll();
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = xLargest;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = ( xBlocks != 0U ) ? xSmallest : 0U;
+	pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+BlockLink_t *pxFirstBlock, *pxEndMarker;
+uint8_t *pucAlignedHeap;
+size_t xTotalHeapSize;
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	pucAlignedHeap = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) &ucHeap[ portBYTE_ALIGNMENT ] ) & ( ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) );
+	xTotalHeapSize = configADJUSTED_HEAP_SIZE & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+	/* The end marker is an allocated block of size 0 in the last bytes, so the
+	last real block never merges past the end of the heap. */
+	pxFirstBlock = ( BlockLink_t * ) pucAlignedHeap;
+	pxFirstBlock->pxPrevPhysical = NULL;
+	pxFirstBlock->xSize = xTotalHeapSize - heapMINIMUM_BLOCK_SIZE;
+
+	pxEndMarker = heapNEXT_PHYSICAL( pxFirstBlock );
+	pxEndMarker->pxPrevPhysical = pxFirstBlock;
+	pxEndMarker->xSize = 0U;
+
+	prvInsertFreeBlock( pxFirstBlock );
+
+	xFreeBytesRemaining = heapBLOCK_SIZE( pxFirstBlock );
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+	xHeapInitialised = pdTRUE;
+}
@@ -0,0 +1,677 @@
+/*
+ * FreeRTOS Kernel V10.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the POSIX (Linux host)
+ * simulator port.
+ *
+ * Each task runs in its own pthread.  Only the thread of the task that is in
+ * the Running state is allowed to execute, every other task thread is blocked
+ * on its own semaphore, so the kernel still sees a single CPU.  A context
+ * switch posts the semaphore of the thread being resumed and then waits on the
+ * semaphore of the thread being suspended.
+ *
+ * Interrupts are simulated with signals.  The tick is SIGALRM from an interval
+ * timer, peripheral models raise their own signals with
+ * vPortGenerateSimulatedInterrupt().  All of those signals are blocked in every
+ * thread except the running one, and the running one blocks them while it is
+ * in a critical section, so a handler always runs in the context of the
+ * running task, just as an ISR interrupts the running task on the target.
+ *
+ * With configUSE_TICKLESS_IDLE the tick timer is a one shot CLOCK_MONOTONIC
+ * timer set for each tick instead, the same way the target sets the RTC
+ * compare, and the idle task sleeps in sigtimedwait().
+ *----------------------------------------------------------*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* The signal used for the tick interrupt. */
+#define portTICK_SIGNAL				SIGALRM
+
+/* Interval timer period that generates the tick interrupts. */
+#define portTICK_PERIOD_US			( 1000000UL / configTICK_RATE_HZ )
+#define portTICK_PERIOD_NS			( 1000000000ULL / configTICK_RATE_HZ )
+#define portNS_PER_SECOND			( 1000000000ULL )
+
+/*
+ * Per task state.  It is placed at the top of the task's own FreeRTOS stack,
+ * which is otherwise unused as the thread runs on a stack allocated by
+ * pthreads, so the first member of the TCB (pxTopOfStack) points at it.
+ */
+typedef struct THREAD
+{
+	pthread_t xThread;				/* The thread that runs the task. */
+	sem_t xWakeUp;					/* Posted to let the thread run. */
+	TaskFunction_t pxCode;			/* The function that implements the task. */
+	void *pvParameters;				/* Passed to pxCode. */
+} Thread_t;
+
+/*
+ * Thread functions.
+ */
+static void *prvThreadEntry( void *pvParams );
+static void prvSuspendSelf( Thread_t *pxThread );
+static void prvResumeThread( Thread_t *pxThread );
+static void prvSwitchThread( Thread_t *pxThreadToResume, Thread_t *pxThreadToSuspend );
+static void prvSwitchContext( void );
+
+/*
+ * Simulated interrupt functions.
+ */
+static void prvSetupSignalMask( void );
+static void prvSignalHandler( int iSignal );
+static void prvTickInterrupt( void );
+
+/*
+ * Tick timer functions.
+ */
+static void prvSetupTimerInterrupt( void );
+static void prvStopTimerInterrupt( void );
+
+#if( configUSE_TICKLESS_IDLE == 1 )
+
+	static void prvSetTickTimer( uint64_t ullTime );
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+#if( ( configUSE_TICKLESS_IDLE == 1 ) || ( configUSE_CRITICAL_SECTION_STATS == 1 ) )
+
+	static uint64_t prvGetTime( void );
+
+#endif
+
+/*
+ * Used to catch tasks that attempt to return from their implementing function.
+ */
+static void prvTaskExitError( void );
+
+/*-----------------------------------------------------------*/
+
+/* Each task maintains its own interrupt status in the critical nesting
+variable.  The value is saved by the thread that switches away and restored
+when it runs again, see prvSwitchThread(). */
+static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
+
+#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+
+	/* Time the outermost critical section was entered, or the task holding it
+	was switched back in, and the address it was entered from. */
+	static uint64_t ullCriticalEnterTime = 0;
+	static void *pvCriticalCaller = NULL;
+
+#endif /* configUSE_CRITICAL_SECTION_STATS */
+
+/* The signals that are treated as interrupts, i.e. blocked by
+portDISABLE_INTERRUPTS().  Everything except the signals that terminate the
+process or report a fault, so Ctrl-C, debuggers and sanitizers still work. */
+static sigset_t xInterruptSignals;
+static pthread_once_t xSignalMaskOnce = PTHREAD_ONCE_INIT;
+
+/* Handlers installed with vPortSetInterruptHandler(), indexed by signal. */
+static void ( *pvInterruptHandlers[ NSIG ] )( void );
+
+/* Posted by vPortEndScheduler() to let xPortStartScheduler() return. */
+static sem_t xSchedulerEnd;
+
+#if( configUSE_TICKLESS_IDLE == 1 )
+
+	/* The tick timer, and the CLOCK_MONOTONIC time of the next tick in
+	nanoseconds.  Tick n is always n tick periods after the first one, so the
+	tick count never drifts from the clock, however long the sleeps. */
+	static timer_t xTickTimer;
+	static uint64_t ullNextTickTime = 0;
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+/*-----------------------------------------------------------*/
+
+static Thread_t *prvGetThreadFromTask( void *pxTCB )
+{
+	/* The first item in the TCB is the task top of stack. */
+	return ( Thread_t * ) *( StackType_t ** ) pxTCB;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+sigset_t xSavedMask;
+int iResult;
+
+	prvSetupSignalMask();
+
+	pxThread = ( Thread_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack - sizeof( Thread_t ) ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) );
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	iResult = sem_init( &( pxThread->xWakeUp ), 0, 0 );
+	configASSERT( iResult == 0 );
+
+	/* The new thread inherits the signal mask, so it starts with interrupts
+	disabled and can never run a handler before it is scheduled. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xSavedMask );
+	iResult = pthread_create( &( pxThread->xThread ), NULL, prvThreadEntry, pxThread );
+	pthread_sigmask( SIG_SETMASK, &xSavedMask, NULL );
+	configASSERT( iResult == 0 );
+
+	return ( StackType_t * ) pxThread;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParams )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParams;
+
+	/* Wait until the scheduler selects this task for the first time. */
+	prvSuspendSelf( pxThread );
+
+	/* A task always starts outside of any critical section. */
+	uxCriticalNesting = 0;
+	vPortEnableInterrupts();
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	prvTaskExitError();
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskExitError( void )
+{
+	/* A function that implements a task must not exit or attempt to return to
+	its caller as there is nothing to return to.  If a task wants to exit it
+	should instead call vTaskDelete( NULL ).
+
+	Artificially force an assert() to be triggered if configASSERT() is
+	defined, then delete the task so the simulation can carry on. */
+	configASSERT( uxCriticalNesting == ~0UL );
+	vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSelf( Thread_t *pxThread )
+{
+	while( sem_wait( &( pxThread->xWakeUp ) ) != 0 )
+	{
+		configASSERT( errno == EINTR );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvResumeThread( Thread_t *pxThread )
+{
+	sem_post( &( pxThread->xWakeUp ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( Thread_t *pxThreadToResume, Thread_t *pxThreadToSuspend )
+{
+UBaseType_t uxSavedCriticalNesting;
+#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+	void *pvSavedCriticalCaller;
+#endif
+
+	if( pxThreadToResume != pxThreadToSuspend )
+	{
+		/* The critical nesting count is per task, keep this task's copy on
+		its thread's stack while the other task runs. */
+		uxSavedCriticalNesting = uxCriticalNesting;
+		#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+		{
+			pvSavedCriticalCaller = pvCriticalCaller;
+		}
+		#endif
+
+		prvResumeThread( pxThreadToResume );
+		prvSuspendSelf( pxThreadToSuspend );
+		uxCriticalNesting = uxSavedCriticalNesting;
+
+		#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+		{
+			/* On the target the section ends with the switch, here the
+			thread keeps it over the switch.  Only time the part after it,
+			which is what the target would see. */
+			pvCriticalCaller = pvSavedCriticalCaller;
+			ullCriticalEnterTime = prvGetTime();
+		}
+		#endif
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchContext( void )
+{
+Thread_t *pxThreadToSuspend, *pxThreadToResume;
+
+	/* Must be called with interrupts disabled. */
+	pxThreadToSuspend = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+	vTaskSwitchContext();
+	pxThreadToResume = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+
+	prvSwitchThread( pxThreadToResume, pxThreadToSuspend );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupSignalMaskOnce( void )
+{
+	sigfillset( &xInterruptSignals );
+	sigdelset( &xInterruptSignals, SIGINT );
+	sigdelset( &xInterruptSignals, SIGTERM );
+	sigdelset( &xInterruptSignals, SIGQUIT );
+	sigdelset( &xInterruptSignals, SIGHUP );
+	sigdelset( &xInterruptSignals, SIGABRT );
+	sigdelset( &xInterruptSignals, SIGSEGV );
+	sigdelset( &xInterruptSignals, SIGBUS );
+	sigdelset( &xInterruptSignals, SIGFPE );
+	sigdelset( &xInterruptSignals, SIGILL );
+	sigdelset( &xInterruptSignals, SIGTRAP );
+	sigdelset( &xInterruptSignals, SIGPROF );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupSignalMask( void )
+{
+	pthread_once( &xSignalMaskOnce, prvSetupSignalMaskOnce );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+BaseType_t xPortStartScheduler( void )
+{
+int iResult;
+
+	prvSetupSignalMask();
+
+	/* This thread only waits for the scheduler to end from now on, it must
+	never take an interrupt meant for the running task. */
+	vPortDisableInterrupts();
+
+	iResult = sem_init( &xSchedulerEnd, 0, 0 );
+	configASSERT( iResult == 0 );
+
+	/* Start the timer that generates the tick ISR. */
+	vPortSetInterruptHandler( portTICK_SIGNAL, prvTickInterrupt );
+	prvSetupTimerInterrupt();
+
+	/* Start the first task. */
+	prvResumeThread( prvGetThreadFromTask( xTaskGetCurrentTaskHandle() ) );
+
+	while( sem_wait( &xSchedulerEnd ) != 0 )
+	{
+		configASSERT( errno == EINTR );
+	}
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	prvStopTimerInterrupt();
+
+	/* Let vTaskStartScheduler() return in the thread that called it.  The
+	calling task is never resumed. */
+	sem_post( &xSchedulerEnd );
+	for( ;; )
+	{
+		prvSuspendSelf( prvGetThreadFromTask( xTaskGetCurrentTaskHandle() ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	vPortEnterCritical();
+	prvSwitchContext();
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	portDISABLE_INTERRUPTS();
+	uxCriticalNesting++;
+
+	#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+	{
+		if( uxCriticalNesting == 1 )
+		{
+			pvCriticalCaller = __builtin_return_address( 0 );
+			ullCriticalEnterTime = prvGetTime();
+		}
+	}
+	#endif /* configUSE_CRITICAL_SECTION_STATS */
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		#if( configUSE_CRITICAL_SECTION_STATS == 1 )
+		{
+			configRECORD_CRITICAL_SECTION( pvCriticalCaller, ( uint32_t ) ( prvGetTime() - ullCriticalEnterTime ) );
+		}
+		#endif /* configUSE_CRITICAL_SECTION_STATS */
+
+		portENABLE_INTERRUPTS();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xPortSetInterruptMask( void )
+{
+sigset_t xPreviousMask;
+
+	/* Returns pdTRUE if interrupts were already disabled, like reading
+	PRIMASK on the target. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xPreviousMask );
+	return ( UBaseType_t ) ( sigismember( &xPreviousMask, portTICK_SIGNAL ) == 1 );
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxMask )
+{
+	if( uxMask == pdFALSE )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortCancelThread( void *pxTaskToDelete )
+{
+Thread_t *pxThread = prvGetThreadFromTask( pxTaskToDelete );
+
+	/* The thread is blocked in sem_wait(), a cancellation point, whether the
+	task deleted itself or was deleted by another task.  Wait for it to be gone
+	before the kernel frees the stack that holds its Thread_t. */
+	pthread_cancel( pxThread->xThread );
+	pthread_join( pxThread->xThread, NULL );
+	sem_destroy( &( pxThread->xWakeUp ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( int iSignal, void ( *pvHandler )( void ) )
+{
+struct sigaction xAction;
+
+	prvSetupSignalMask();
+	configASSERT( ( iSignal > 0 ) && ( iSignal < NSIG ) );
+	configASSERT( sigismember( &xInterruptSignals, iSignal ) == 1 );
+
+	pvInterruptHandlers[ iSignal ] = pvHandler;
+
+	/* Interrupts do not nest, every simulated interrupt is masked while one of
+	them is being handled. */
+	memset( &xAction, 0x00, sizeof( xAction ) );
+	xAction.sa_handler = prvSignalHandler;
+	xAction.sa_mask = xInterruptSignals;
+	xAction.sa_flags = SA_RESTART;
+	sigaction( iSignal, &xAction, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( int iSignal )
+{
+	/* Sent to the process rather than the calling thread, so it is taken by
+	whichever task is running once interrupts are enabled.  Like an interrupt
+	flag, several requests made while it is pending are handled once. */
+	kill( getpid(), iSignal );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSignalHandler( int iSignal )
+{
+int iSavedErrno = errno;
+
+	/* Interrupts are masked while the handler runs, account for it so a
+	yield from the handler does not enable them. */
+	uxCriticalNesting++;
+	if( pvInterruptHandlers[ iSignal ] != NULL )
+	{
+		pvInterruptHandlers[ iSignal ]();
+	}
+	uxCriticalNesting--;
+
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+#if( ( configUSE_TICKLESS_IDLE == 1 ) || ( configUSE_CRITICAL_SECTION_STATS == 1 ) )
+
+static uint64_t prvGetTime( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( ( uint64_t ) xNow.tv_sec * portNS_PER_SECOND ) + ( uint64_t ) xNow.tv_nsec;
+}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TICKLESS_IDLE == 0 )
+
+static void prvSetupTimerInterrupt( void )
+{
+struct itimerval xTimer;
+int iResult;
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = portTICK_PERIOD_US;
+	xTimer.it_value = xTimer.it_interval;
+	iResult = setitimer( ITIMER_REAL, &xTimer, NULL );
+	configASSERT( iResult == 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStopTimerInterrupt( void )
+{
+struct itimerval xTimer;
+
+	memset( &xTimer, 0x00, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickInterrupt( void )
+{
+	/* Increment the RTOS tick. */
+	if( xTaskIncrementTick() != pdFALSE )
+	{
+		/* A context switch is required. */
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+#else /* configUSE_TICKLESS_IDLE */
+
+static void prvSetupTimerInterrupt( void )
+{
+struct sigevent xEvent;
+int iResult;
+
+	memset( &xEvent, 0x00, sizeof( xEvent ) );
+	xEvent.sigev_notify = SIGEV_SIGNAL;
+	xEvent.sigev_signo = portTICK_SIGNAL;
+	iResult = timer_create( CLOCK_MONOTONIC, &xEvent, &xTickTimer );
+	configASSERT( iResult == 0 );
+
+	ullNextTickTime = prvGetTime() + portTICK_PERIOD_NS;
+	prvSetTickTimer( ullNextTickTime );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStopTimerInterrupt( void )
+{
+	timer_delete( xTickTimer );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetTickTimer( uint64_t ullTime )
+{
+struct itimerspec xTimer;
+
+	memset( &xTimer, 0x00, sizeof( xTimer ) );
+	xTimer.it_value.tv_sec = ( time_t ) ( ullTime / portNS_PER_SECOND );
+	xTimer.it_value.tv_nsec = ( long ) ( ullTime % portNS_PER_SECOND );
+	timer_settime( xTickTimer, TIMER_ABSTIME, &xTimer, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickInterrupt( void )
+{
+uint64_t ullNow = prvGetTime();
+BaseType_t xSwitchRequired = pdFALSE;
+
+	/* Count every tick up to now.  The host may not have run the process for
+	more than a tick, and a signal raised again while pending is lost. */
+	while( ullNextTickTime <= ullNow )
+	{
+		/* Increment the RTOS tick. */
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			xSwitchRequired = pdTRUE;
+		}
+		ullNextTickTime += portTICK_PERIOD_NS;
+	}
+	prvSetTickTimer( ullNextTickTime );
+
+	if( xSwitchRequired != pdFALSE )
+	{
+		/* A context switch is required. */
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+uint64_t ullNow, ullWakeTime, ullCompleteTickPeriods;
+TickType_t xModifiableIdleTime, xTicksToStep;
+struct timespec xTimeout;
+int iSignal = -1;
+
+	/* Mask the simulated interrupts, they still end the sleep below. */
+	vPortDisableInterrupts();
+
+	/* If a context switch is pending or a task is waiting for the scheduler
+	to be unsuspended then abandon the low power entry. */
+	if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+	{
+		vPortEnableInterrupts();
+		return;
+	}
+
+	/* Stop the tick, sleep until the tick the next task unblocks on or until
+	a simulated interrupt is raised. */
+	prvSetTickTimer( 0 );
+	ullWakeTime = ullNextTickTime + ( ( uint64_t ) ( xExpectedIdleTime - 1 ) * portTICK_PERIOD_NS );
+	ullNow = prvGetTime();
+	if( ullWakeTime > ullNow )
+	{
+		xTimeout.tv_sec = ( time_t ) ( ( ullWakeTime - ullNow ) / portNS_PER_SECOND );
+		xTimeout.tv_nsec = ( long ) ( ( ullWakeTime - ullNow ) % portNS_PER_SECOND );
+
+		xModifiableIdleTime = xExpectedIdleTime;
+		configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+		if( xModifiableIdleTime > 0 )
+		{
+			iSignal = sigtimedwait( &xInterruptSignals, NULL, &xTimeout );
+		}
+		configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+	}
+
+	/* Count the ticks that passed and restart the tick. */
+	ullNow = prvGetTime();
+	ullCompleteTickPeriods = 0;
+	if( ullNow >= ullNextTickTime )
+	{
+		ullCompleteTickPeriods = ( ( ullNow - ullNextTickTime ) / portTICK_PERIOD_NS ) + 1ULL;
+		ullNextTickTime += ullCompleteTickPeriods * portTICK_PERIOD_NS;
+	}
+	prvSetTickTimer( ullNextTickTime );
+
+	/* Step the tick count over the ticks that passed.  vTaskStepTick() must
+	not reach the tick the next task unblocks on, as that task is unblocked
+	by xTaskIncrementTick(), which is called for the rest as the tick
+	interrupt would.  The scheduler is suspended, so those calls only pend
+	the ticks until xTaskResumeAll(). */
+	xTicksToStep = ( ullCompleteTickPeriods >= ( uint64_t ) xExpectedIdleTime ) ? ( xExpectedIdleTime - 1 ) : ( TickType_t ) ullCompleteTickPeriods;
+	vTaskStepTick( xTicksToStep );
+	while( ullCompleteTickPeriods > ( uint64_t ) xTicksToStep )
+	{
+		( void ) xTaskIncrementTick();
+		ullCompleteTickPeriods--;
+	}
+
+	/* sigtimedwait() took the signal that ended the sleep, raise it again so
+	its handler runs once interrupts are enabled.  The tick is accounted for
+	already. */
+	if( ( iSignal > 0 ) && ( iSignal != portTICK_SIGNAL ) )
+	{
+		vPortGenerateSimulatedInterrupt( iSignal );
+	}
+
+	vPortEnableInterrupts();
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TICKLESS_IDLE */
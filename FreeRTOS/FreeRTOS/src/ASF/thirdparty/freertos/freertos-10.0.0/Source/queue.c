@@ -52,6 +52,7 @@ privileged Vs unprivileged linkage and placement. */
 /* Constants used with the cRxLock and cTxLock structure members. */
 #define queueUNLOCKED					( ( int8_t ) -1 )
 #define queueLOCKED_UNMODIFIED			( ( int8_t ) 0 )
+#define queueLOCK_COUNT_MAX				( ( int8_t ) 127 )
 
 /* When the Queue_t structure is used to represent a base queue its pcHead and
 pcTail members are used as pointers into the queue storage area.  When the
@@ -73,6 +74,27 @@ zero. */
 #define queueSEMAPHORE_QUEUE_ITEM_LENGTH ( ( UBaseType_t ) 0 )
 #define queueMUTEX_GIVE_BLOCK_TIME		 ( ( TickType_t ) 0U )
 
+/* Bits of ucLoans, set while a slot of the queue is on loan.  See
+pvQueueLoanSend() and pvQueueLoanReceive(). */
+#define queueLOANED_SEND				( ( uint8_t ) 1U )
+#define queueLOANED_RECEIVE				( ( uint8_t ) 2U )
+
+/* The loans that stop an item being sent to xPosition.  A send loan holds the
+slot at pcWriteTo, so every send waits for its commit.  A receive loan holds
+the slot after pcReadFrom, which sends to the front and overwrites would move
+under it.  Overwrites cannot wait and must not fail, so they assert that
+neither loan is open. */
+#define queueSEND_LOANS( xPosition )	( ( ( xPosition ) == queueSEND_TO_BACK ) ? queueLOANED_SEND : ( uint8_t ) ( queueLOANED_SEND | queueLOANED_RECEIVE ) )
+
+#if( configUSE_QUEUE_LOANS == 1 )
+	#define queueNOT_LOANED( pxQueue, ucLoanMask )	( ( ( pxQueue )->ucLoans & ( ucLoanMask ) ) == ( uint8_t ) 0U )
+#else
+	#define queueNOT_LOANED( pxQueue, ucLoanMask )	( pdTRUE )
+#endif
+
+/* Copies one item into or out of the queue storage area. */
+typedef void ( *QueueCopyFunction_t )( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize );
+
 #if( configUSE_PREEMPTION == 0 )
 	/* If the cooperative scheduler is being used then a yield should not be
 	performed just because a higher priority task has been woken. */
@@ -98,6 +120,8 @@ typedef struct QueueDefinition
 		UBaseType_t uxRecursiveCallCount;/*< Maintains a count of the number of times a recursive mutex has been recursively 'taken' when the structure is used as a mutex. */
 	} u;
 
+	QueueCopyFunction_t pxCopyItem;	/*< Copies an item, chosen for uxItemSize when the queue is created so small items are not copied by a memcpy() call inside the critical section. */
+
 	List_t xTasksWaitingToSend;		/*< List of tasks that are blocked waiting to post onto this queue.  Stored in priority order. */
 	List_t xTasksWaitingToReceive;	/*< List of tasks that are blocked waiting to read from this queue.  Stored in priority order. */
 
@@ -108,6 +132,10 @@ typedef struct QueueDefinition
 	volatile int8_t cRxLock;		/*< Stores the number of items received from the queue (removed from the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 	volatile int8_t cTxLock;		/*< Stores the number of items transmitted to the queue (added to the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 
+	#if( configUSE_QUEUE_LOANS == 1 )
+		uint8_t ucLoans;			/*< queueLOANED_SEND and queueLOANED_RECEIVE bits of the slots on loan. */
+	#endif
+
 	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 		uint8_t ucStaticallyAllocated;	/*< Set to pdTRUE if the memory used by the queue was statically allocated to ensure no attempt is made to free the memory. */
 	#endif
@@ -191,6 +219,23 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue, const void *pvIte
  */
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Removes up to uxCount tasks from an event list of a queue, one for each item
+ * a batch call posted or received.  Called from a critical section with the
+ * queue unlocked.
+ *
+ * @return pdTRUE if a removed task has a priority above the running task.
+ */
+static BaseType_t prvUnblockTasks( List_t * const pxEventList, UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Adds the uxCount items a batch call posted or received to the Tx or Rx lock
+ * count of a locked queue, saturating at queueLOCK_COUNT_MAX as no queue has
+ * that many tasks waiting.  A member of a queue set needs one count per item,
+ * so xQueueSendMultipleFromISR() never sends it more than fit.
+ */
+static int8_t prvAddToLockCount( const int8_t cLock, const UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
 #if ( configUSE_QUEUE_SETS == 1 )
 	/*
 	 * Checks to see if a queue is a member of a queue set, and if so, notifies
@@ -205,6 +250,21 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
  */
 static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, uint8_t *pucQueueStorage, const uint8_t ucQueueType, Queue_t *pxNewQueue ) PRIVILEGED_FUNCTION;
 
+/*
+ * Item copy functions, one of which is selected for the item size of a queue
+ * by prvSelectCopyFunction() when the queue is created.  The small sizes call
+ * memcpy() with a constant size, which the compiler expands in place into
+ * loads and stores that suit the alignment it can prove, instead of a call.
+ * Items are copied as bytes, not through pointers to wider types, as they can
+ * be of any type and sent from and received into any buffer.
+ */
+static QueueCopyFunction_t prvSelectCopyFunction( const UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+static void prvCopyItem1( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+static void prvCopyItem2( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+static void prvCopyItem4( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+static void prvCopyItem8( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+static void prvCopyItemBytes( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+
 /*
  * Mutexes are a special type of queue.  When a mutex is created, first the
  * queue is created, then prvInitialiseMutex() is called to configure the queue
@@ -260,6 +320,12 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		pxQueue->cRxLock = queueUNLOCKED;
 		pxQueue->cTxLock = queueUNLOCKED;
 
+		#if( configUSE_QUEUE_LOANS == 1 )
+		{
+			pxQueue->ucLoans = ( uint8_t ) 0U;
+		}
+		#endif
+
 		if( xNewQueue == pdFALSE )
 		{
 			/* If there are tasks blocked waiting to read from the queue, then
@@ -430,6 +496,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 	defined. */
 	pxNewQueue->uxLength = uxQueueLength;
 	pxNewQueue->uxItemSize = uxItemSize;
+	pxNewQueue->pxCopyItem = prvSelectCopyFunction( uxItemSize );
 	( void ) xQueueGenericReset( pxNewQueue, pdTRUE );
 
 	#if ( configUSE_TRACE_FACILITY == 1 )
@@ -749,8 +816,11 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			/* Is there room on the queue now?  The running task must be the
 			highest priority task wanting to access the queue.  If the head item
 			in the queue is to be overwritten then it does not matter if the
-			queue is full. */
-			if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) )
+			queue is full.  An overwrite must not fail, so the queue must not
+			have a slot on loan, see xQueueOverwrite(). */
+			configASSERT( ( xCopyPosition != queueOVERWRITE ) || queueNOT_LOANED( pxQueue, queueSEND_LOANS( queueOVERWRITE ) ) );
+
+			if( ( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) ) && queueNOT_LOANED( pxQueue, queueSEND_LOANS( xCopyPosition ) ) )
 			{
 				traceQUEUE_SEND( pxQueue );
 				xYieldRequired = prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
@@ -954,7 +1024,10 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 	post). */
 	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
 	{
-		if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) )
+		/* See xQueueGenericSend(). */
+		configASSERT( ( xCopyPosition != queueOVERWRITE ) || queueNOT_LOANED( pxQueue, queueSEND_LOANS( queueOVERWRITE ) ) );
+
+		if( ( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) ) && queueNOT_LOANED( pxQueue, queueSEND_LOANS( xCopyPosition ) ) )
 		{
 			const int8_t cTxLock = pxQueue->cTxLock;
 
@@ -1270,7 +1343,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
 			/* Is there data in the queue now?  To be running the calling task
 			must be the highest priority task wanting to access the queue. */
-			if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+			if( ( uxMessagesWaiting > ( UBaseType_t ) 0 ) && queueNOT_LOANED( pxQueue, queueLOANED_RECEIVE ) )
 			{
 				/* Data available, remove one item. */
 				prvCopyDataFromQueue( pxQueue, pvBuffer );
@@ -1632,7 +1705,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
 			/* Is there data in the queue now?  To be running the calling task
 			must be the highest priority task wanting to access the queue. */
-			if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+			if( ( uxMessagesWaiting > ( UBaseType_t ) 0 ) && queueNOT_LOANED( pxQueue, queueLOANED_RECEIVE ) )
 			{
 				/* Remember the read position so it can be reset after the data
 				is read from the queue as this function is only peeking the
@@ -1778,7 +1851,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
 		/* Cannot block in an ISR, so check there is data available. */
-		if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+		if( ( uxMessagesWaiting > ( UBaseType_t ) 0 ) && queueNOT_LOANED( pxQueue, queueLOANED_RECEIVE ) )
 		{
 			const int8_t cRxLock = pxQueue->cRxLock;
 
@@ -1839,177 +1912,953 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,  void * const pvBuffer )
+BaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItemsToQueue, const UBaseType_t uxItemCount, TickType_t xTicksToWait )
 {
-BaseType_t xReturn;
-UBaseType_t uxSavedInterruptStatus;
-int8_t *pcOriginalReadPosition;
+BaseType_t xEntryTimeSet = pdFALSE, xYieldRequired;
+TimeOut_t xTimeOut;
 Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+const int8_t *pcItem;
+UBaseType_t uxSpaces, uxSent, ux;
 
 	configASSERT( pxQueue );
-	configASSERT( !( ( pvBuffer == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
-	configASSERT( pxQueue->uxItemSize != 0 ); /* Can't peek a semaphore. */
-
-	/* RTOS ports that support interrupt nesting have the concept of a maximum
-	system call (or maximum API call) interrupt priority.  Interrupts that are
-	above the maximum system call priority are kept permanently enabled, even
-	when the RTOS kernel is in a critical section, but cannot make any calls to
-	FreeRTOS API functions.  If configASSERT() is defined in FreeRTOSConfig.h
-	then portASSERT_IF_INTERRUPT_PRIORITY_INVALID() will result in an assertion
-	failure if a FreeRTOS API function is called from an interrupt that has been
-	assigned a priority above the configured maximum system call priority.
-	Only FreeRTOS functions that end in FromISR can be called from interrupts
-	that have been assigned a priority at or (logically) below the maximum
-	system call	interrupt priority.  FreeRTOS maintains a separate interrupt
-	safe API to ensure interrupt entry is as fast and as simple as possible.
-	More information (albeit Cortex-M specific) is provided on the following
-	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
-	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
-
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	configASSERT( pvItemsToQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
 	{
-		/* Cannot block in an ISR, so check there is data available. */
-		if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
-		{
-			traceQUEUE_PEEK_FROM_ISR( pxQueue );
-
-			/* Remember the read position so it can be reset as nothing is
-			actually being removed from the queue. */
-			pcOriginalReadPosition = pxQueue->u.pcReadFrom;
-			prvCopyDataFromQueue( pxQueue, pvBuffer );
-			pxQueue->u.pcReadFrom = pcOriginalReadPosition;
-
-			xReturn = pdPASS;
-		}
-		else
-		{
-			xReturn = pdFAIL;
-			traceQUEUE_PEEK_FROM_ISR_FAILED( pxQueue );
-		}
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
-
-	return xReturn;
-}
-/*-----------------------------------------------------------*/
-
-UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
-{
-UBaseType_t uxReturn;
-
-	configASSERT( xQueue );
+	#endif
 
-	taskENTER_CRITICAL();
+	if( uxItemCount == ( UBaseType_t ) 0 )
 	{
-		uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+		return 0;
 	}
-	taskEXIT_CRITICAL();
-
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
-
-UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue )
-{
-UBaseType_t uxReturn;
-Queue_t *pxQueue;
 
-	pxQueue = ( Queue_t * ) xQueue;
-	configASSERT( pxQueue );
-
-	taskENTER_CRITICAL();
+	/* The same structure as xQueueGenericSend(), except that every item that
+	fits is posted once there is room for one. */
+	for( ;; )
 	{
-		uxReturn = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
-	}
-	taskEXIT_CRITICAL();
-
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
+		taskENTER_CRITICAL();
+		{
+			uxSpaces = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
 
-UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
-{
-UBaseType_t uxReturn;
+			if( ( uxSpaces > ( UBaseType_t ) 0 ) && queueNOT_LOANED( pxQueue, queueLOANED_SEND ) )
+			{
+				uxSent = ( uxItemCount < uxSpaces ) ? uxItemCount : uxSpaces;
+				pcItem = ( const int8_t * ) pvItemsToQueue;
+				xYieldRequired = pdFALSE;
 
-	configASSERT( xQueue );
+				for( ux = 0; ux < uxSent; ux++ )
+				{
+					traceQUEUE_SEND( pxQueue );
+					( void ) prvCopyDataToQueue( pxQueue, pcItem, queueSEND_TO_BACK );
+					pcItem += pxQueue->uxItemSize;
 
-	uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+					#if ( configUSE_QUEUE_SETS == 1 )
+					{
+						/* The set holds one entry per item of the queue. */
+						if( pxQueue->pxQueueSetContainer != NULL )
+						{
+							if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
+							{
+								xYieldRequired = pdTRUE;
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					#endif /* configUSE_QUEUE_SETS */
+				}
 
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
+				#if ( configUSE_QUEUE_SETS == 1 )
+				if( pxQueue->pxQueueSetContainer == NULL )
+				#endif /* configUSE_QUEUE_SETS */
+				{
+					if( prvUnblockTasks( &( pxQueue->xTasksWaitingToReceive ), uxSent ) != pdFALSE )
+					{
+						xYieldRequired = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
 
-void vQueueDelete( QueueHandle_t xQueue )
-{
-Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+				if( xYieldRequired != pdFALSE )
+				{
+					/* One yield for the whole batch, from within the critical
+					section as in xQueueGenericSend(). */
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 
-	configASSERT( pxQueue );
-	traceQUEUE_DELETE( pxQueue );
+				taskEXIT_CRITICAL();
+				return ( BaseType_t ) uxSent;
+			}
+			else
+			{
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					taskEXIT_CRITICAL();
+					traceQUEUE_SEND_FAILED( pxQueue );
+					return 0;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					vTaskInternalSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
 
-	#if ( configQUEUE_REGISTRY_SIZE > 0 )
-	{
-		vQueueUnregisterQueue( pxQueue );
-	}
-	#endif
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
 
-	#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
-	{
-		/* The queue can only have been allocated dynamically - free it
-		again. */
-		vPortFree( pxQueue );
-	}
-	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
-	{
-		/* The queue could have been allocated statically or dynamically, so
-		check before attempting to free the memory. */
-		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
 		{
-			vPortFree( pxQueue );
+			if( prvIsQueueFull( pxQueue ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+			}
+			else
+			{
+				/* Try again. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
 		}
 		else
 		{
-			mtCOVERAGE_TEST_MARKER();
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+
+			traceQUEUE_SEND_FAILED( pxQueue );
+			return 0;
 		}
 	}
-	#else
-	{
-		/* The queue must have been statically allocated, so is not going to be
-		deleted.  Avoid compiler warnings about the unused parameter. */
-		( void ) pxQueue;
-	}
-	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
 }
 /*-----------------------------------------------------------*/
 
-#if ( configUSE_TRACE_FACILITY == 1 )
-
-	UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue )
-	{
-		return ( ( Queue_t * ) xQueue )->uxQueueNumber;
-	}
+BaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItemsToQueue, const UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+const int8_t *pcItem = ( const int8_t * ) pvItemsToQueue;
+UBaseType_t uxSpaces, uxSent, ux;
+BaseType_t xWoken = pdFALSE;
 
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+	configASSERT( pxQueue );
+	configASSERT( pvItemsToQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+	/* See xQueueGenericSendFromISR(). */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	void vQueueSetQueueNumber( QueueHandle_t xQueue, UBaseType_t uxQueueNumber )
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
 	{
-		( ( Queue_t * ) xQueue )->uxQueueNumber = uxQueueNumber;
-	}
-
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+		const int8_t cTxLock = pxQueue->cTxLock;
 
-#if ( configUSE_TRACE_FACILITY == 1 )
-
-	uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
-	{
-		return ( ( Queue_t * ) xQueue )->ucQueueType;
-	}
+		uxSpaces = queueNOT_LOANED( pxQueue, queueLOANED_SEND ) ? ( pxQueue->uxLength - pxQueue->uxMessagesWaiting ) : ( UBaseType_t ) 0;
+		uxSent = ( uxItemCount < uxSpaces ) ? uxItemCount : uxSpaces;
 
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+		#if ( configUSE_QUEUE_SETS == 1 )
+		{
+			/* prvUnlockQueue() posts one entry to the queue set for each
+			count of the lock, so a locked member of a set only takes as many
+			items as the count can still record. */
+			if( ( cTxLock != queueUNLOCKED ) && ( pxQueue->pxQueueSetContainer != NULL ) )
+			{
+				if( uxSent > ( UBaseType_t ) ( queueLOCK_COUNT_MAX - cTxLock ) )
+				{
+					uxSent = ( UBaseType_t ) ( queueLOCK_COUNT_MAX - cTxLock );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_QUEUE_SETS */
+
+		for( ux = 0; ux < uxSent; ux++ )
+		{
+			traceQUEUE_SEND_FROM_ISR( pxQueue );
+			( void ) prvCopyDataToQueue( pxQueue, pcItem, queueSEND_TO_BACK );
+			pcItem += pxQueue->uxItemSize;
+
+			#if ( configUSE_QUEUE_SETS == 1 )
+			{
+				if( ( cTxLock == queueUNLOCKED ) && ( pxQueue->pxQueueSetContainer != NULL ) )
+				{
+					if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
+					{
+						xWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configUSE_QUEUE_SETS */
+		}
+
+		if( uxSent == ( UBaseType_t ) 0 )
+		{
+			traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+		}
+		else if( cTxLock == queueUNLOCKED )
+		{
+			#if ( configUSE_QUEUE_SETS == 1 )
+			if( pxQueue->pxQueueSetContainer == NULL )
+			#endif /* configUSE_QUEUE_SETS */
+			{
+				if( prvUnblockTasks( &( pxQueue->xTasksWaitingToReceive ), uxSent ) != pdFALSE )
+				{
+					xWoken = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		else
+		{
+			/* The task that unlocks the queue unblocks the receivers. */
+			pxQueue->cTxLock = prvAddToLockCount( cTxLock, uxSent );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	if( ( xWoken != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+	{
+		*pxHigherPriorityTaskWoken = pdTRUE;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return ( BaseType_t ) uxSent;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxItemCount, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+int8_t *pcItem;
+UBaseType_t uxReceived, ux;
+
+	configASSERT( pxQueue );
+	configASSERT( pvBuffer );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	if( uxItemCount == ( UBaseType_t ) 0 )
+	{
+		return 0;
+	}
+
+	/* The same structure as xQueueReceive(), except that every waiting item
+	that fits in the buffer is received. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
+
+			if( ( uxMessagesWaiting > ( UBaseType_t ) 0 ) && queueNOT_LOANED( pxQueue, queueLOANED_RECEIVE ) )
+			{
+				uxReceived = ( uxItemCount < uxMessagesWaiting ) ? uxItemCount : uxMessagesWaiting;
+				pcItem = ( int8_t * ) pvBuffer;
+
+				for( ux = 0; ux < uxReceived; ux++ )
+				{
+					prvCopyDataFromQueue( pxQueue, pcItem );
+					traceQUEUE_RECEIVE( pxQueue );
+					pxQueue->uxMessagesWaiting--;
+					pcItem += pxQueue->uxItemSize;
+				}
+
+				if( prvUnblockTasks( &( pxQueue->xTasksWaitingToSend ), uxReceived ) != pdFALSE )
+				{
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				taskEXIT_CRITICAL();
+				return ( BaseType_t ) uxReceived;
+			}
+			else
+			{
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					taskEXIT_CRITICAL();
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return 0;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					vTaskInternalSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
+
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* The queue contains data again. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			/* Timed out, receive whatever arrived meanwhile. */
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceQUEUE_RECEIVE_FAILED( pxQueue );
+				return 0;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+int8_t *pcItem = ( int8_t * ) pvBuffer;
+UBaseType_t uxReceived, ux;
+
+	configASSERT( pxQueue );
+	configASSERT( pvBuffer );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+	/* See xQueueGenericSendFromISR(). */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		const int8_t cRxLock = pxQueue->cRxLock;
+		const UBaseType_t uxMessagesWaiting = queueNOT_LOANED( pxQueue, queueLOANED_RECEIVE ) ? pxQueue->uxMessagesWaiting : ( UBaseType_t ) 0;
+
+		uxReceived = ( uxItemCount < uxMessagesWaiting ) ? uxItemCount : uxMessagesWaiting;
+
+		for( ux = 0; ux < uxReceived; ux++ )
+		{
+			traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+			prvCopyDataFromQueue( pxQueue, pcItem );
+			pxQueue->uxMessagesWaiting--;
+			pcItem += pxQueue->uxItemSize;
+		}
+
+		if( uxReceived == ( UBaseType_t ) 0 )
+		{
+			traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+		}
+		else if( cRxLock == queueUNLOCKED )
+		{
+			if( ( prvUnblockTasks( &( pxQueue->xTasksWaitingToSend ), uxReceived ) != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+			{
+				*pxHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			/* The task that unlocks the queue unblocks the senders. */
+			pxQueue->cRxLock = prvAddToLockCount( cRxLock, uxReceived );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return ( BaseType_t ) uxReceived;
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_LOANS == 1 )
+
+	void *pvQueueLoanSend( QueueHandle_t xQueue, TickType_t xTicksToWait )
+	{
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+	void *pvReturn;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		/* The same structure as xQueueGenericSend(), except that the free slot
+		is reserved instead of written. */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) && queueNOT_LOANED( pxQueue, queueLOANED_SEND ) )
+				{
+					/* pcWriteTo stays where it is until the commit, so every
+					other send waits for it and items stay in order. */
+					pxQueue->ucLoans |= queueLOANED_SEND;
+					pvReturn = ( void * ) pxQueue->pcWriteTo;
+					taskEXIT_CRITICAL();
+					return pvReturn;
+				}
+				else
+				{
+					if( xTicksToWait == ( TickType_t ) 0 )
+					{
+						taskEXIT_CRITICAL();
+						traceQUEUE_SEND_FAILED( pxQueue );
+						return NULL;
+					}
+					else if( xEntryTimeSet == pdFALSE )
+					{
+						vTaskInternalSetTimeOutState( &xTimeOut );
+						xEntryTimeSet = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsQueueFull( pxQueue ) != pdFALSE )
+				{
+					traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+					vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+					prvUnlockQueue( pxQueue );
+
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+				}
+				else
+				{
+					/* Try again. */
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
+				}
+			}
+			else
+			{
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+
+				traceQUEUE_SEND_FAILED( pxQueue );
+				return NULL;
+			}
+		}
+	}
+
+#endif /* configUSE_QUEUE_LOANS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_LOANS == 1 )
+
+	void vQueueCommitSend( QueueHandle_t xQueue )
+	{
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+	BaseType_t xYieldRequired = pdFALSE;
+
+		configASSERT( pxQueue );
+
+		taskENTER_CRITICAL();
+		{
+			configASSERT( ( pxQueue->ucLoans & queueLOANED_SEND ) != 0U );
+
+			/* The item is already in place, queue it as prvCopyDataToQueue()
+			would have. */
+			traceQUEUE_SEND( pxQueue );
+			pxQueue->ucLoans &= ( uint8_t ) ~queueLOANED_SEND;
+			pxQueue->pcWriteTo += pxQueue->uxItemSize;
+			if( pxQueue->pcWriteTo >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+			{
+				pxQueue->pcWriteTo = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+			pxQueue->uxMessagesWaiting++;
+
+			#if ( configUSE_QUEUE_SETS == 1 )
+			if( pxQueue->pxQueueSetContainer != NULL )
+			{
+				xYieldRequired = prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK );
+			}
+			else
+			#endif /* configUSE_QUEUE_SETS */
+			{
+				xYieldRequired = prvUnblockTasks( &( pxQueue->xTasksWaitingToReceive ), ( UBaseType_t ) 1 );
+			}
+
+			/* Every sender that waited for the loan to end can go on while
+			there is room, so wake one per free slot rather than just one. */
+			if( pxQueue->uxMessagesWaiting < pxQueue->uxLength )
+			{
+				if( prvUnblockTasks( &( pxQueue->xTasksWaitingToSend ), pxQueue->uxLength - pxQueue->uxMessagesWaiting ) != pdFALSE )
+				{
+					xYieldRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( xYieldRequired != pdFALSE )
+			{
+				queueYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_QUEUE_LOANS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_LOANS == 1 )
+
+	void *pvQueueLoanReceive( QueueHandle_t xQueue, TickType_t xTicksToWait )
+	{
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+	int8_t *pcHeadItem;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		/* The same structure as xQueueReceive(), except that the head item is
+		lent instead of copied out. */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				if( ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) && queueNOT_LOANED( pxQueue, queueLOANED_RECEIVE ) )
+				{
+					/* The item stays counted until it is released, so no send
+					can reuse its slot. */
+					pxQueue->ucLoans |= queueLOANED_RECEIVE;
+					pcHeadItem = pxQueue->u.pcReadFrom + pxQueue->uxItemSize;
+					if( pcHeadItem >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+					{
+						pcHeadItem = pxQueue->pcHead;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+					taskEXIT_CRITICAL();
+					return ( void * ) pcHeadItem;
+				}
+				else
+				{
+					if( xTicksToWait == ( TickType_t ) 0 )
+					{
+						taskEXIT_CRITICAL();
+						traceQUEUE_RECEIVE_FAILED( pxQueue );
+						return NULL;
+					}
+					else if( xEntryTimeSet == pdFALSE )
+					{
+						vTaskInternalSetTimeOutState( &xTimeOut );
+						xEntryTimeSet = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+				{
+					traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+					vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+					prvUnlockQueue( pxQueue );
+
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					/* The queue contains data again. */
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
+				}
+			}
+			else
+			{
+				/* Timed out, lend whatever arrived meanwhile. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+
+				if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+				{
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return NULL;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+	}
+
+#endif /* configUSE_QUEUE_LOANS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_LOANS == 1 )
+
+	void vQueueReleaseReceive( QueueHandle_t xQueue )
+	{
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+	BaseType_t xYieldRequired;
+
+		configASSERT( pxQueue );
+
+		taskENTER_CRITICAL();
+		{
+			configASSERT( ( pxQueue->ucLoans & queueLOANED_RECEIVE ) != 0U );
+
+			/* Remove the item as prvCopyDataFromQueue() would have. */
+			pxQueue->ucLoans &= ( uint8_t ) ~queueLOANED_RECEIVE;
+			pxQueue->u.pcReadFrom += pxQueue->uxItemSize;
+			if( pxQueue->u.pcReadFrom >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+			{
+				pxQueue->u.pcReadFrom = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+			traceQUEUE_RECEIVE( pxQueue );
+			pxQueue->uxMessagesWaiting--;
+
+			/* A loan of either kind blocks senders, so those that waited for
+			this one can take every free slot, not just the one it freed. */
+			xYieldRequired = prvUnblockTasks( &( pxQueue->xTasksWaitingToSend ), pxQueue->uxLength - pxQueue->uxMessagesWaiting );
+
+			/* Likewise every receiver that waited for the loan to end can go
+			on while there are items. */
+			if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+			{
+				if( prvUnblockTasks( &( pxQueue->xTasksWaitingToReceive ), pxQueue->uxMessagesWaiting ) != pdFALSE )
+				{
+					xYieldRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( xYieldRequired != pdFALSE )
+			{
+				queueYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_QUEUE_LOANS */
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,  void * const pvBuffer )
+{
+BaseType_t xReturn;
+UBaseType_t uxSavedInterruptStatus;
+int8_t *pcOriginalReadPosition;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( !( ( pvBuffer == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
+	configASSERT( pxQueue->uxItemSize != 0 ); /* Can't peek a semaphore. */
+
+	/* RTOS ports that support interrupt nesting have the concept of a maximum
+	system call (or maximum API call) interrupt priority.  Interrupts that are
+	above the maximum system call priority are kept permanently enabled, even
+	when the RTOS kernel is in a critical section, but cannot make any calls to
+	FreeRTOS API functions.  If configASSERT() is defined in FreeRTOSConfig.h
+	then portASSERT_IF_INTERRUPT_PRIORITY_INVALID() will result in an assertion
+	failure if a FreeRTOS API function is called from an interrupt that has been
+	assigned a priority above the configured maximum system call priority.
+	Only FreeRTOS functions that end in FromISR can be called from interrupts
+	that have been assigned a priority at or (logically) below the maximum
+	system call	interrupt priority.  FreeRTOS maintains a separate interrupt
+	safe API to ensure interrupt entry is as fast and as simple as possible.
+	More information (albeit Cortex-M specific) is provided on the following
+	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		/* Cannot block in an ISR, so check there is data available. */
+		if( ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) && queueNOT_LOANED( pxQueue, queueLOANED_RECEIVE ) )
+		{
+			traceQUEUE_PEEK_FROM_ISR( pxQueue );
+
+			/* Remember the read position so it can be reset as nothing is
+			actually being removed from the queue. */
+			pcOriginalReadPosition = pxQueue->u.pcReadFrom;
+			prvCopyDataFromQueue( pxQueue, pvBuffer );
+			pxQueue->u.pcReadFrom = pcOriginalReadPosition;
+
+			xReturn = pdPASS;
+		}
+		else
+		{
+			xReturn = pdFAIL;
+			traceQUEUE_PEEK_FROM_ISR_FAILED( pxQueue );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+
+	configASSERT( xQueue );
+
+	taskENTER_CRITICAL();
+	{
+		uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+	}
+	taskEXIT_CRITICAL();
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+Queue_t *pxQueue;
+
+	pxQueue = ( Queue_t * ) xQueue;
+	configASSERT( pxQueue );
+
+	taskENTER_CRITICAL();
+	{
+		uxReturn = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+	}
+	taskEXIT_CRITICAL();
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+
+	configASSERT( xQueue );
+
+	uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+void vQueueDelete( QueueHandle_t xQueue )
+{
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	traceQUEUE_DELETE( pxQueue );
+
+	#if ( configQUEUE_REGISTRY_SIZE > 0 )
+	{
+		vQueueUnregisterQueue( pxQueue );
+	}
+	#endif
+
+	#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
+	{
+		/* The queue can only have been allocated dynamically - free it
+		again. */
+		vPortFree( pxQueue );
+	}
+	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+	{
+		/* The queue could have been allocated statically or dynamically, so
+		check before attempting to free the memory. */
+		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+		{
+			vPortFree( pxQueue );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#else
+	{
+		/* The queue must have been statically allocated, so is not going to be
+		deleted.  Avoid compiler warnings about the unused parameter. */
+		( void ) pxQueue;
+	}
+	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue )
+	{
+		return ( ( Queue_t * ) xQueue )->uxQueueNumber;
+	}
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	void vQueueSetQueueNumber( QueueHandle_t xQueue, UBaseType_t uxQueueNumber )
+	{
+		( ( Queue_t * ) xQueue )->uxQueueNumber = uxQueueNumber;
+	}
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
+	{
+		return ( ( Queue_t * ) xQueue )->ucQueueType;
+	}
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
 
 #if( configUSE_MUTEXES == 1 )
 
@@ -2066,7 +2915,7 @@ UBaseType_t uxMessagesWaiting;
 	}
 	else if( xPosition == queueSEND_TO_BACK )
 	{
-		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0. */
+		pxQueue->pxCopyItem( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, pxQueue->uxItemSize );
 		pxQueue->pcWriteTo += pxQueue->uxItemSize;
 		if( pxQueue->pcWriteTo >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 		{
@@ -2079,7 +2928,7 @@ UBaseType_t uxMessagesWaiting;
 	}
 	else
 	{
-		( void ) memcpy( ( void * ) pxQueue->u.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+		pxQueue->pxCopyItem( ( void * ) pxQueue->u.pcReadFrom, pvItemToQueue, pxQueue->uxItemSize );
 		pxQueue->u.pcReadFrom -= pxQueue->uxItemSize;
 		if( pxQueue->u.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 		{
@@ -2130,11 +2979,119 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
-		( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.pcReadFrom, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0. */
+		pxQueue->pxCopyItem( pvBuffer, ( void * ) pxQueue->u.pcReadFrom, pxQueue->uxItemSize );
 	}
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvUnblockTasks( List_t * const pxEventList, UBaseType_t uxCount )
+{
+BaseType_t xReturn = pdFALSE;
+
+	while( ( uxCount > ( UBaseType_t ) 0 ) && ( listLIST_IS_EMPTY( pxEventList ) == pdFALSE ) )
+	{
+		if( xTaskRemoveFromEventList( pxEventList ) != pdFALSE )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+		uxCount--;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int8_t prvAddToLockCount( const int8_t cLock, const UBaseType_t uxCount )
+{
+int8_t cReturn;
+
+	if( uxCount >= ( UBaseType_t ) ( queueLOCK_COUNT_MAX - cLock ) )
+	{
+		cReturn = queueLOCK_COUNT_MAX;
+	}
+	else
+	{
+		cReturn = ( int8_t ) ( cLock + ( int8_t ) uxCount );
+	}
+
+	return cReturn;
+}
+/*-----------------------------------------------------------*/
+
+static QueueCopyFunction_t prvSelectCopyFunction( const UBaseType_t uxItemSize )
+{
+QueueCopyFunction_t pxReturn;
+
+	switch( uxItemSize )
+	{
+		case ( UBaseType_t ) 1 :
+			pxReturn = prvCopyItem1;
+			break;
+
+		case ( UBaseType_t ) 2 :
+			pxReturn = prvCopyItem2;
+			break;
+
+		case ( UBaseType_t ) 4 :
+			pxReturn = prvCopyItem4;
+			break;
+
+		case ( UBaseType_t ) 8 :
+			pxReturn = prvCopyItem8;
+			break;
+
+		default :
+			/* Semaphores have an item size of 0 and never copy. */
+			pxReturn = prvCopyItemBytes;
+			break;
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItem1( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize )
+{
+	( void ) uxItemSize;
+
+	*( ( uint8_t * ) pvDestination ) = *( ( const uint8_t * ) pvSource );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItem2( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize )
+{
+	( void ) uxItemSize;
+
+	( void ) memcpy( pvDestination, pvSource, ( size_t ) 2 ); /*lint !e961 !e418 Constant size, see prvSelectCopyFunction(). */
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItem4( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize )
+{
+	( void ) uxItemSize;
+
+	( void ) memcpy( pvDestination, pvSource, ( size_t ) 4 ); /*lint !e961 !e418 Constant size, see prvSelectCopyFunction(). */
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItem8( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize )
+{
+	( void ) uxItemSize;
+
+	( void ) memcpy( pvDestination, pvSource, ( size_t ) 8 ); /*lint !e961 !e418 Constant size, see prvSelectCopyFunction(). */
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItemBytes( void *pvDestination, const void *pvSource, UBaseType_t uxItemSize )
+{
+	( void ) memcpy( pvDestination, pvSource, ( size_t ) uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0. */
+}
+/*-----------------------------------------------------------*/
+
 static void prvUnlockQueue( Queue_t * const pxQueue )
 {
 	/* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED. */
@@ -2261,7 +3218,8 @@ BaseType_t xReturn;
 
 	taskENTER_CRITICAL();
 	{
-		if( pxQueue->uxMessagesWaiting == ( UBaseType_t )  0 )
+		/* A queue whose head is on loan has nothing to receive either. */
+		if( ( pxQueue->uxMessagesWaiting == ( UBaseType_t )  0 ) || !queueNOT_LOANED( pxQueue, queueLOANED_RECEIVE ) )
 		{
 			xReturn = pdTRUE;
 		}
@@ -2300,7 +3258,9 @@ BaseType_t xReturn;
 
 	taskENTER_CRITICAL();
 	{
-		if( pxQueue->uxMessagesWaiting == pxQueue->uxLength )
+		/* Any loan can stop a send, so a sender blocks until the loan ends
+		rather than spinning.  The end of a loan unblocks a sender. */
+		if( ( pxQueue->uxMessagesWaiting == pxQueue->uxLength ) || !queueNOT_LOANED( pxQueue, ( uint8_t ) ( queueLOANED_SEND | queueLOANED_RECEIVE ) ) )
 		{
 			xReturn = pdTRUE;
 		}
@@ -125,12 +125,33 @@ that uses task notifications. */
 #endif /* sbSEND_COMPLETE_FROM_ISR */
 /*lint -restore (9026) */
 
+#if( configUSE_PREEMPTION == 0 )
+	/* If the cooperative scheduler is being used then a yield should not be
+	performed just because a higher priority task has been woken. */
+	#define sbYIELD_IF_USING_PREEMPTION()
+#else
+	#define sbYIELD_IF_USING_PREEMPTION() portYIELD_WITHIN_API()
+#endif
+
 /* The number of bytes used to hold the length of a message in the buffer. */
 #define sbBYTES_TO_STORE_MESSAGE_LENGTH ( sizeof( size_t ) )
 
 /* Bits stored in the ucFlags field of the stream buffer. */
 #define sbFLAGS_IS_MESSAGE_BUFFER		( ( uint8_t ) 1 ) /* Set if the stream buffer was created as a message buffer, in which case it holds discrete messages rather than a stream. */
 #define sbFLAGS_IS_STATICALLY_ALLOCATED ( ( uint8_t ) 2 ) /* Set if the stream buffer was created using statically allocated memory. */
+#define sbFLAGS_IS_CONCURRENT			( ( uint8_t ) 4 ) /* Set if the stream buffer was created for several writers and readers. */
+
+/* Writers of a concurrent buffer reserve space up to xReservedHead before the
+data is published by moving xHead, and readers claim data up to xReservedTail
+before the space is freed by moving xTail.  These are where the next write and
+read start. */
+#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+	#define sbNEXT_WRITE( pxStreamBuffer )	( ( ( ( pxStreamBuffer )->ucFlags & sbFLAGS_IS_CONCURRENT ) != ( uint8_t ) 0 ) ? ( pxStreamBuffer )->xReservedHead : ( pxStreamBuffer )->xHead )
+	#define sbNEXT_READ( pxStreamBuffer )	( ( ( ( pxStreamBuffer )->ucFlags & sbFLAGS_IS_CONCURRENT ) != ( uint8_t ) 0 ) ? ( pxStreamBuffer )->xReservedTail : ( pxStreamBuffer )->xTail )
+#else
+	#define sbNEXT_WRITE( pxStreamBuffer )	( ( pxStreamBuffer )->xHead )
+	#define sbNEXT_READ( pxStreamBuffer )	( ( pxStreamBuffer )->xTail )
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -149,6 +170,15 @@ typedef struct xSTREAM_BUFFER /*lint !e9058 Style convention uses tag. */
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t uxStreamBufferNumber;		/* Used for tracing purposes. */
 	#endif
+
+	#if ( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+		volatile size_t xReservedHead;			/* End of the space reserved by writers, xHead once they have all finished. */
+		volatile size_t xReservedTail;			/* End of the data claimed by readers, xTail once they have all finished. */
+		List_t xTasksWaitingToSend;				/* Tasks of a concurrent buffer waiting for space, in priority order. */
+		List_t xTasksWaitingToReceive;			/* Tasks of a concurrent buffer waiting for data, in priority order. */
+		UBaseType_t uxWriters;					/* Tasks copying into reserved space. */
+		UBaseType_t uxReaders;					/* Tasks copying out of claimed data. */
+	#endif
 } StreamBuffer_t;
 
 /*
@@ -199,6 +229,50 @@ static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer,
 									  size_t xMaxCount,
 									  size_t xBytesAvailable ); PRIVILEGED_FUNCTION
 
+/*
+ * Copy xCount bytes to or from the storage area starting at index xIndex,
+ * wrapping at its end, and return the index that follows them.  Neither moves
+ * xHead or xTail.
+ */
+static size_t prvWriteBytesAt( const StreamBuffer_t * const pxStreamBuffer, size_t xIndex, const uint8_t *pucData, size_t xCount ) PRIVILEGED_FUNCTION;
+static size_t prvReadBytesAt( const StreamBuffer_t * const pxStreamBuffer, size_t xIndex, uint8_t *pucData, size_t xCount ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+
+	/*
+	 * Send and receive for buffers created with
+	 * xStreamBufferGenericCreateConcurrent().  A writer reserves the space of
+	 * its whole message and a reader claims a whole message in a critical
+	 * section, then each copies with interrupts enabled, so writers and readers
+	 * only hold each other up for the time it takes to move an index.
+	 */
+	static size_t prvSendConcurrent( StreamBuffer_t * const pxStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+	static size_t prvReceiveConcurrent( StreamBuffer_t * const pxStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Makes a stream buffer concurrent, used after it has been initialised.
+	 */
+	static void prvInitialiseConcurrent( StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Unblocks every task waiting on pxEventList, each one then checks the
+	 * buffer again.  Called from a critical section.  Returns pdTRUE if a task
+	 * of a higher priority than the calling task was unblocked.
+	 */
+	static BaseType_t prvUnblockAll( List_t * const pxEventList ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Returns pdTRUE if pxStreamBuffer is concurrent and a task is waiting on
+	 * it or copying to or from it.
+	 */
+	static BaseType_t prvIsConcurrentBusy( const StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+
+#else
+
+	#define prvIsConcurrentBusy( pxStreamBuffer ) pdFALSE
+
+#endif /* configUSE_CONCURRENT_STREAM_BUFFERS */
+
 /*
  * Called by both pxStreamBufferCreate() and pxStreamBufferCreateStatic() to
  * initialise the members of the newly created stream buffer structure.
@@ -263,6 +337,27 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_CONCURRENT_STREAM_BUFFERS == 1 ) )
+
+	StreamBufferHandle_t xStreamBufferGenericCreateConcurrent( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, BaseType_t xIsMessageBuffer )
+	{
+	StreamBuffer_t * const pxStreamBuffer = ( StreamBuffer_t * ) xStreamBufferGenericCreate( xBufferSizeBytes, xTriggerLevelBytes, xIsMessageBuffer ); /*lint !e9087 !e9079 Safe cast as StreamBufferHandle_t is opaque Streambuffer_t. */
+
+		if( pxStreamBuffer != NULL )
+		{
+			prvInitialiseConcurrent( pxStreamBuffer );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( StreamBufferHandle_t ) pxStreamBuffer;
+	}
+
+#endif /* ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_CONCURRENT_STREAM_BUFFERS == 1 ) */
+/*-----------------------------------------------------------*/
+
 #if( configSUPPORT_STATIC_ALLOCATION == 1 )
 
 	StreamBufferHandle_t xStreamBufferGenericCreateStatic( size_t xBufferSizeBytes,
@@ -335,6 +430,10 @@ StreamBuffer_t * pxStreamBuffer = ( StreamBuffer_t * ) xStreamBuffer; /*lint !e9
 
 	configASSERT( pxStreamBuffer );
 
+	/* A concurrent buffer must not be deleted while a task waits on, writes
+	to or reads from it. */
+	configASSERT( prvIsConcurrentBusy( pxStreamBuffer ) == pdFALSE );
+
 	traceSTREAM_BUFFER_DELETE( xStreamBuffer );
 
 	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) pdFALSE )
@@ -371,8 +470,26 @@ BaseType_t xReturn = pdFAIL, xIsMessageBuffer;
 	UBaseType_t uxStreamBufferNumber;
 #endif
 
+#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+	uint8_t ucConcurrent;
+#endif
+
 	configASSERT( pxStreamBuffer );
 
+	#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+	{
+		/* Nor while tasks wait on, write to or read from a concurrent
+		buffer.  A task can start to do so at any time, so the check and the
+		initialisation are made in one critical section.  The flag is kept
+		here as the initialisation clears it. */
+		ucConcurrent = pxStreamBuffer->ucFlags & sbFLAGS_IS_CONCURRENT;
+		if( ucConcurrent != ( uint8_t ) 0 )
+		{
+			taskENTER_CRITICAL();
+		}
+	}
+	#endif
+
 	#if( configUSE_TRACE_FACILITY == 1 )
 	{
 		/* Store the stream buffer number so it can be restored after the
@@ -384,7 +501,7 @@ BaseType_t xReturn = pdFAIL, xIsMessageBuffer;
 	/* Can only reset a message buffer if there are no tasks blocked on it. */
 	if( pxStreamBuffer->xTaskWaitingToReceive == NULL )
 	{
-		if( pxStreamBuffer->xTaskWaitingToSend == NULL )
+		if( ( pxStreamBuffer->xTaskWaitingToSend == NULL ) && ( prvIsConcurrentBusy( pxStreamBuffer ) == pdFALSE ) )
 		{
 			if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
 			{
@@ -402,6 +519,15 @@ BaseType_t xReturn = pdFAIL, xIsMessageBuffer;
 										  xIsMessageBuffer );
 			xReturn = pdPASS;
 
+			#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+			{
+				if( ucConcurrent != ( uint8_t ) 0 )
+				{
+					prvInitialiseConcurrent( pxStreamBuffer );
+				}
+			}
+			#endif
+
 			#if( configUSE_TRACE_FACILITY == 1 )
 			{
 				pxStreamBuffer->uxStreamBufferNumber = uxStreamBufferNumber;
@@ -412,6 +538,15 @@ BaseType_t xReturn = pdFAIL, xIsMessageBuffer;
 		}
 	}
 
+	#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+	{
+		if( ucConcurrent != ( uint8_t ) 0 )
+		{
+			taskEXIT_CRITICAL();
+		}
+	}
+	#endif
+
 	return xReturn;
 }
 /*-----------------------------------------------------------*/
@@ -453,7 +588,7 @@ size_t xSpace;
 	configASSERT( pxStreamBuffer );
 
 	xSpace = pxStreamBuffer->xLength + pxStreamBuffer->xTail;
-	xSpace -= pxStreamBuffer->xHead;
+	xSpace -= sbNEXT_WRITE( pxStreamBuffer );
 	xSpace -= ( size_t ) 1;
 
 	if( xSpace >= pxStreamBuffer->xLength )
@@ -494,6 +629,15 @@ TimeOut_t xTimeOut;
 	configASSERT( pvTxData );
 	configASSERT( pxStreamBuffer );
 
+	#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+	{
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_CONCURRENT ) != ( uint8_t ) 0 )
+		{
+			return prvSendConcurrent( pxStreamBuffer, pvTxData, xDataLengthBytes, xTicksToWait );
+		}
+	}
+	#endif
+
 	/* This send function is used to write to both message buffers and stream
 	buffers.  If this is a message buffer then the space needed must be
 	increased by the amount of bytes needed to store the length of the
@@ -594,6 +738,10 @@ size_t xRequiredSpace = xDataLengthBytes;
 	configASSERT( pvTxData );
 	configASSERT( pxStreamBuffer );
 
+	/* Concurrent buffers wake their tasks through event lists, which
+	interrupts must not touch. */
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_CONCURRENT ) == ( uint8_t ) 0 );
+
 	/* This send function is used to write to both message buffers and stream
 	buffers.  If this is a message buffer then the space needed must be
 	increased by the amount of bytes needed to store the length of the
@@ -696,6 +844,15 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 	configASSERT( pvRxData );
 	configASSERT( pxStreamBuffer );
 
+	#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+	{
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_CONCURRENT ) != ( uint8_t ) 0 )
+		{
+			return prvReceiveConcurrent( pxStreamBuffer, pvRxData, xBufferLengthBytes, xTicksToWait );
+		}
+	}
+	#endif
+
 	/* This receive function is used by both message buffers, which store
 	discrete messages, and stream buffers, which store a continuous stream of
 	bytes.  Discrete messages include an additional
@@ -800,6 +957,9 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 	configASSERT( pvRxData );
 	configASSERT( pxStreamBuffer );
 
+	/* See xStreamBufferSendFromISR(). */
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_CONCURRENT ) == ( uint8_t ) 0 );
+
 	/* This receive function is used by both message buffers, which store
 	discrete messages, and stream buffers, which store a continuous stream of
 	bytes.  Discrete messages include an additional
@@ -905,7 +1065,7 @@ size_t xTail;
 	configASSERT( pxStreamBuffer );
 
 	/* True if no bytes are available. */
-	xTail = pxStreamBuffer->xTail;
+	xTail = sbNEXT_READ( pxStreamBuffer );
 	if( pxStreamBuffer->xHead == xTail )
 	{
 		xReturn = pdTRUE;
@@ -1016,11 +1176,17 @@ UBaseType_t uxSavedInterruptStatus;
 
 static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount )
 {
-size_t xNextHead, xFirstLength;
-
 	configASSERT( xCount > ( size_t ) 0 );
 
-	xNextHead = pxStreamBuffer->xHead;
+	pxStreamBuffer->xHead = prvWriteBytesAt( pxStreamBuffer, pxStreamBuffer->xHead, pucData, xCount );
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWriteBytesAt( const StreamBuffer_t * const pxStreamBuffer, size_t xIndex, const uint8_t *pucData, size_t xCount )
+{
+size_t xNextHead = xIndex, xFirstLength;
 
 	/* Calculate the number of bytes that can be added in the first write -
 	which may be less than the total number of bytes that need to be added if
@@ -1054,64 +1220,67 @@ size_t xNextHead, xFirstLength;
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	pxStreamBuffer->xHead = xNextHead;
-
-	return xCount;
+	return xNextHead;
 }
 /*-----------------------------------------------------------*/
 
 static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer, uint8_t *pucData, size_t xMaxCount, size_t xBytesAvailable )
 {
-size_t xCount, xFirstLength, xNextTail;
+size_t xCount;
 
 	/* Use the minimum of the wanted bytes and the available bytes. */
 	xCount = configMIN( xBytesAvailable, xMaxCount );
 
 	if( xCount > ( size_t ) 0 )
 	{
-		xNextTail = pxStreamBuffer->xTail;
-
-		/* Calculate the number of bytes that can be read - which may be
-		less than the number wanted if the data wraps around to the start of
+		/* Move the tail pointer to effectively remove the data read from
 		the buffer. */
-		xFirstLength = configMIN( pxStreamBuffer->xLength - xNextTail, xCount );
+		pxStreamBuffer->xTail = prvReadBytesAt( pxStreamBuffer, pxStreamBuffer->xTail, pucData, xCount );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
-		/* Obtain the number of bytes it is possible to obtain in the first
-		read.  Asserts check bounds of read and write. */
-		configASSERT( xFirstLength <= xMaxCount );
-		configASSERT( ( xNextTail + xFirstLength ) <= pxStreamBuffer->xLength );
-		memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	return xCount;
+}
+/*-----------------------------------------------------------*/
 
-		/* If the total number of wanted bytes is greater than the number
-		that could be read in the first read... */
-		if( xCount > xFirstLength )
-		{
-			/*...then read the remaining bytes from the start of the buffer. */
-			configASSERT( xCount <= xMaxCount );
-			memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
-		}
-		else
-		{
-			mtCOVERAGE_TEST_MARKER();
-		}
+static size_t prvReadBytesAt( const StreamBuffer_t * const pxStreamBuffer, size_t xIndex, uint8_t *pucData, size_t xCount )
+{
+size_t xFirstLength, xNextTail = xIndex;
 
-		/* Move the tail pointer to effectively remove the data read from
-		the buffer. */
-		xNextTail += xCount;
+	/* Calculate the number of bytes that can be read - which may be
+	less than the number wanted if the data wraps around to the start of
+	the buffer. */
+	xFirstLength = configMIN( pxStreamBuffer->xLength - xNextTail, xCount );
 
-		if( xNextTail >= pxStreamBuffer->xLength )
-		{
-			xNextTail -= pxStreamBuffer->xLength;
-		}
+	/* Obtain the number of bytes it is possible to obtain in the first
+	read.  Asserts check bounds of read and write. */
+	configASSERT( ( xNextTail + xFirstLength ) <= pxStreamBuffer->xLength );
+	memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 
-		pxStreamBuffer->xTail = xNextTail;
+	/* If the total number of wanted bytes is greater than the number
+	that could be read in the first read... */
+	if( xCount > xFirstLength )
+	{
+		/*...then read the remaining bytes from the start of the buffer. */
+		configASSERT( ( xCount - xFirstLength ) <= pxStreamBuffer->xLength );
+		memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 	}
 	else
 	{
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	return xCount;
+	xNextTail += xCount;
+
+	if( xNextTail >= pxStreamBuffer->xLength )
+	{
+		xNextTail -= pxStreamBuffer->xLength;
+	}
+
+	return xNextTail;
 }
 /*-----------------------------------------------------------*/
 
@@ -1121,7 +1290,7 @@ static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer )
 size_t xCount;
 
 	xCount = pxStreamBuffer->xLength + pxStreamBuffer->xHead;
-	xCount -= pxStreamBuffer->xTail;
+	xCount -= sbNEXT_READ( pxStreamBuffer );
 	if ( xCount >= pxStreamBuffer->xLength )
 	{
 		xCount -= pxStreamBuffer->xLength;
@@ -1164,6 +1333,316 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 		pxStreamBuffer->ucFlags |= sbFLAGS_IS_MESSAGE_BUFFER;
 	}
 }
+/*-----------------------------------------------------------*/
+
+#if( configUSE_CONCURRENT_STREAM_BUFFERS == 1 )
+
+	static void prvInitialiseConcurrent( StreamBuffer_t * const pxStreamBuffer )
+	{
+		/* The indexes and counts were zeroed with the rest of the structure,
+		so xReservedHead and xReservedTail already match xHead and xTail. */
+		vListInitialise( &( pxStreamBuffer->xTasksWaitingToSend ) );
+		vListInitialise( &( pxStreamBuffer->xTasksWaitingToReceive ) );
+		pxStreamBuffer->ucFlags |= sbFLAGS_IS_CONCURRENT;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvIsConcurrentBusy( const StreamBuffer_t * const pxStreamBuffer )
+	{
+	BaseType_t xReturn = pdFALSE;
+
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_CONCURRENT ) != ( uint8_t ) 0 )
+		{
+			if( ( listLIST_IS_EMPTY( &( pxStreamBuffer->xTasksWaitingToSend ) ) == pdFALSE ) ||
+				( listLIST_IS_EMPTY( &( pxStreamBuffer->xTasksWaitingToReceive ) ) == pdFALSE ) ||
+				( pxStreamBuffer->uxWriters != ( UBaseType_t ) 0 ) ||
+				( pxStreamBuffer->uxReaders != ( UBaseType_t ) 0 ) )
+			{
+				xReturn = pdTRUE;
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvUnblockAll( List_t * const pxEventList )
+	{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+		/* With the scheduler running the tasks go straight to the ready list.
+		Unlike xTaskResumeAll(), this only asks for a yield for a task of a
+		higher priority, so writers and readers of the same priority do not
+		switch after every message. */
+		while( listLIST_IS_EMPTY( pxEventList ) == pdFALSE )
+		{
+			if( xTaskRemoveFromEventList( pxEventList ) != pdFALSE )
+			{
+				xHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		return xHigherPriorityTaskWoken;
+	}
+	/*-----------------------------------------------------------*/
+
+	static size_t prvSendConcurrent( StreamBuffer_t * const pxStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, TickType_t xTicksToWait )
+	{
+	size_t xRequiredSpace = xDataLengthBytes, xIndex;
+	BaseType_t xYieldRequired = pdFALSE;
+	TimeOut_t xTimeOut;
+
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+		{
+			xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+		}
+		else if( xDataLengthBytes == ( size_t ) 0 )
+		{
+			/* There is no empty stream write. */
+			return ( size_t ) 0;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Unlike a stream buffer with a single writer, the data is never
+		split, so it must fit in the storage area as a whole. */
+		if( xRequiredSpace >= pxStreamBuffer->xLength )
+		{
+			traceSTREAM_BUFFER_SEND_FAILED( pxStreamBuffer );
+			return ( size_t ) 0;
+		}
+
+		if( xTicksToWait != ( TickType_t ) 0 )
+		{
+			vTaskSetTimeOutState( &xTimeOut );
+		}
+
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				if( xStreamBufferSpacesAvailable( pxStreamBuffer ) >= xRequiredSpace )
+				{
+					/* Reserve the space.  No other writer can use it and no
+					reader can see it until xHead moves past it. */
+					xIndex = pxStreamBuffer->xReservedHead;
+					pxStreamBuffer->xReservedHead = ( xIndex + xRequiredSpace >= pxStreamBuffer->xLength ) ? ( xIndex + xRequiredSpace - pxStreamBuffer->xLength ) : ( xIndex + xRequiredSpace );
+					( pxStreamBuffer->uxWriters )++;
+					taskEXIT_CRITICAL();
+					break;
+				}
+				else if( ( xTicksToWait == ( TickType_t ) 0 ) || ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE ) )
+				{
+					taskEXIT_CRITICAL();
+					traceSTREAM_BUFFER_SEND_FAILED( pxStreamBuffer );
+					return ( size_t ) 0;
+				}
+				else
+				{
+					/* Interrupts never use the event list, so a critical
+					section protects it as well as suspending the scheduler
+					would. */
+					traceBLOCKING_ON_STREAM_BUFFER_SEND( pxStreamBuffer );
+					vTaskPlaceOnEventList( &( pxStreamBuffer->xTasksWaitingToSend ), xTicksToWait );
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			/* The task is no longer ready, switch to another one.  It may have
+			been unblocked already, in which case it only yields. */
+			portYIELD_WITHIN_API();
+		}
+
+		/* Copy with the scheduler running, other writers can reserve and
+		copy at the same time. */
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+		{
+			xIndex = prvWriteBytesAt( pxStreamBuffer, xIndex, ( const uint8_t * ) &xDataLengthBytes, sbBYTES_TO_STORE_MESSAGE_LENGTH );
+		}
+
+		if( xDataLengthBytes > ( size_t ) 0 )
+		{
+			( void ) prvWriteBytesAt( pxStreamBuffer, xIndex, ( const uint8_t * ) pvTxData, xDataLengthBytes ); /*lint !e9079 Storage buffer is implemented as uint8_t for ease of sizing, alighment and access. */
+		}
+
+		taskENTER_CRITICAL();
+		{
+			configASSERT( pxStreamBuffer->uxWriters > ( UBaseType_t ) 0 );
+			( pxStreamBuffer->uxWriters )--;
+
+			/* Writers can finish in any order, so the data is published when
+			the last one finishes, and with it the data of every writer that
+			reserved space before it. */
+			if( pxStreamBuffer->uxWriters == ( UBaseType_t ) 0 )
+			{
+				pxStreamBuffer->xHead = pxStreamBuffer->xReservedHead;
+
+				if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+				{
+					xYieldRequired = prvUnblockAll( &( pxStreamBuffer->xTasksWaitingToReceive ) );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xYieldRequired != pdFALSE )
+		{
+			sbYIELD_IF_USING_PREEMPTION();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		traceSTREAM_BUFFER_SEND( pxStreamBuffer, xDataLengthBytes );
+
+		return xDataLengthBytes;
+	}
+	/*-----------------------------------------------------------*/
+
+	static size_t prvReceiveConcurrent( StreamBuffer_t * const pxStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, TickType_t xTicksToWait )
+	{
+	size_t xBytesToStoreMessageLength, xBytesAvailable, xReceivedLength, xIndex;
+	BaseType_t xYieldRequired = pdFALSE;
+	TimeOut_t xTimeOut;
+
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+		{
+			xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+		}
+		else
+		{
+			xBytesToStoreMessageLength = 0;
+		}
+
+		if( xTicksToWait != ( TickType_t ) 0 )
+		{
+			vTaskSetTimeOutState( &xTimeOut );
+		}
+
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+				if( xBytesAvailable > xBytesToStoreMessageLength )
+				{
+					xIndex = pxStreamBuffer->xReservedTail;
+
+					if( xBytesToStoreMessageLength != ( size_t ) 0 )
+					{
+						/* Claim a whole message, or leave it in the buffer if
+						it does not fit in pvRxData. */
+						xIndex = prvReadBytesAt( pxStreamBuffer, xIndex, ( uint8_t * ) &xReceivedLength, xBytesToStoreMessageLength );
+
+						if( xReceivedLength > xBufferLengthBytes )
+						{
+							taskEXIT_CRITICAL();
+							traceSTREAM_BUFFER_RECEIVE_FAILED( pxStreamBuffer );
+							return ( size_t ) 0;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						xReceivedLength = configMIN( xBytesAvailable, xBufferLengthBytes );
+					}
+
+					/* No other reader can take the claimed data and no writer
+					can overwrite it until xTail moves past it. */
+					pxStreamBuffer->xReservedTail = ( xIndex + xReceivedLength >= pxStreamBuffer->xLength ) ? ( xIndex + xReceivedLength - pxStreamBuffer->xLength ) : ( xIndex + xReceivedLength );
+					( pxStreamBuffer->uxReaders )++;
+					taskEXIT_CRITICAL();
+					break;
+				}
+				else if( ( xTicksToWait == ( TickType_t ) 0 ) || ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE ) )
+				{
+					taskEXIT_CRITICAL();
+					traceSTREAM_BUFFER_RECEIVE_FAILED( pxStreamBuffer );
+					return ( size_t ) 0;
+				}
+				else
+				{
+					traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( pxStreamBuffer );
+					vTaskPlaceOnEventList( &( pxStreamBuffer->xTasksWaitingToReceive ), xTicksToWait );
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			portYIELD_WITHIN_API();
+		}
+
+		/* Copy with the scheduler running, other readers can claim and copy
+		at the same time. */
+		if( xReceivedLength > ( size_t ) 0 )
+		{
+			( void ) prvReadBytesAt( pxStreamBuffer, xIndex, ( uint8_t * ) pvRxData, xReceivedLength ); /*lint !e9079 Data storage area is implemented as uint8_t array for ease of sizing, indexing and alignment. */
+		}
+
+		taskENTER_CRITICAL();
+		{
+			configASSERT( pxStreamBuffer->uxReaders > ( UBaseType_t ) 0 );
+			( pxStreamBuffer->uxReaders )--;
+
+			/* As for writers, the space is freed when the last reader
+			finishes. */
+			if( pxStreamBuffer->uxReaders == ( UBaseType_t ) 0 )
+			{
+				pxStreamBuffer->xTail = pxStreamBuffer->xReservedTail;
+				xYieldRequired = prvUnblockAll( &( pxStreamBuffer->xTasksWaitingToSend ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xYieldRequired != pdFALSE )
+		{
+			sbYIELD_IF_USING_PREEMPTION();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		traceSTREAM_BUFFER_RECEIVE( pxStreamBuffer, xReceivedLength );
+
+		return xReceivedLength;
+	}
+
+#endif /* configUSE_CONCURRENT_STREAM_BUFFERS */
 
 #if ( configUSE_TRACE_FACILITY == 1 )
 
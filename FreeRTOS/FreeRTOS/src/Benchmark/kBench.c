@@ -0,0 +1,1033 @@
+/**************************************************************************//**
+* @file      kBench.c
+* @brief     Kernel microbenchmarks
+* @details   Times the kernel primitives in this configuration: context
+*            switch, queue send/receive, semaphore give/take, direct to
+*            task notification and timer command dispatch and expiry.
+*            Each primitive runs in a ping-pong pattern (two workers
+*            bounce it back and forth) and in a fan-in pattern (every
+*            other worker feeds worker 0) for KBENCH_ITERATIONS.
+*            The timeout benchmark repeats the queue ping-pong with a
+*            block time while more and more other tasks are delayed, to
+*            show what the delayed task structure costs.
+*            The isr patterns fill and drain a queue of 1 or 4 byte items
+*            with the FromISR calls, from worker 0 with interrupts masked
+*            as a handler would, to time what a UART or timer interrupt
+*            pays per item.
+*            The isr-to-task patterns send bursts of bytes with the
+*            FromISR call of a queue, a stream buffer and a channel, again
+*            with interrupts masked, and receive them from the task
+*            without blocking, the path a UART receive handler and its
+*            task take.
+*            The batch benchmark streams KBENCH_ITERATIONS items from
+*            worker 1 to worker 0 with xQueueSendMultiple and
+*            xQueueReceiveMultiple, 1, 8 or KBENCH_BATCH_MAX at a time.
+*            The message benchmark streams 4 to 256 byte messages from
+*            worker 1 to worker 0: copied into and out of a queue, passed
+*            by pointer to a memory pool block, and written and read in
+*            place in the queue with the loan calls when
+*            configUSE_QUEUE_LOANS is set, to show when each pays for
+*            itself.
+*            The log benchmark has 2, 4 or KBENCH_LOG_WRITERS tasks write
+*            KBENCH_ITERATIONS lines each into one message buffer that
+*            another task drains, once with a mutex around each send and
+*            once with a concurrent message buffer.
+*
+*            Results are printed as one CSV line per benchmark:
+*            bench,<primitive>,<pattern>,<operations>,<total>,<per_op>,<unit>
+*            per_op is per round trip for ping-pong, per item for fan-in,
+*            per send and receive pair for isr and batch, per switch for yield, per
+*            command or expiry for timers,
+*            per message for messages and per line for log.
+*            The unit is CPU cycles on the target (SysTick) and
+*            nanoseconds on the host simulator (CLOCK_MONOTONIC).
+* @author    Adi
+* @date      2024-1-8
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <asf.h>
+#include "kBench.h"
+#include "kLine.h"
+#include "mempool.h"
+#include "channel.h"
+#if !defined(__arm__)
+#include <time.h>
+#endif
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KBENCH_LINE_SIZE		96	 // Longest result line
+#define KBENCH_COMMAND_PERIOD	pdMS_TO_TICKS(1000)	 // Never expires while commands are timed
+#define KBENCH_SLEEP			pdMS_TO_TICKS(60000)  // Sleepers never wake while a benchmark runs
+#define KBENCH_TIMEOUT			(2 * KBENCH_SLEEP)	 // Block time of the timeout benchmark, after every sleeper
+#define KBENCH_TASKS_MAX		(KBENCH_LOG_WRITERS + 1)	 // Most tasks running one job, the log writers and reader
+
+#if defined(__arm__)
+#define KBENCH_UNIT		"cycles"
+#else
+#define KBENCH_UNIT		"ns"
+#endif
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+typedef uint32_t kBench_Count;  ///< Cycles or nanoseconds, differences are taken modulo 2^32
+typedef void (*kBench_Job)(uint8_t worker);
+
+/// A benchmark executed by the workers
+typedef struct {
+	const char *primitive;
+	const char *pattern;
+	kBench_Job job;
+	uint32_t operations;  ///< Operations timed by one run of job
+} kBench_Benchmark;
+
+/// A way of passing messages, for the message and log benchmarks
+typedef struct {
+	const char *pattern;  ///< Pattern prefix, the message size follows
+	kBench_Job job;
+} kBench_Message;
+
+static TaskHandle_t workers[KBENCH_WORKERS];  ///< Suspended between benchmarks
+static kBench_Job workerJob;  ///< Job of the running benchmark, the same for every worker
+static SemaphoreHandle_t jobDone;  ///< Given by each worker once its part of the job is done
+
+static QueueHandle_t pingQueue;
+static QueueHandle_t pongQueue;
+static QueueHandle_t fanInQueue;
+static QueueHandle_t isrByteQueue;
+static QueueHandle_t isrWordQueue;
+static StreamBufferHandle_t isrStream;
+static ChannelHandle_t isrChannel;
+static SemaphoreHandle_t pingSemaphore;
+static SemaphoreHandle_t pongSemaphore;
+static SemaphoreHandle_t fanInSemaphore;
+static TimerHandle_t commandTimer;
+static TimerHandle_t latencyTimer;
+static QueueHandle_t batchQueue;  ///< Only while the batch benchmark runs
+static UBaseType_t batchSize;  ///< Items per call of the running batch benchmark
+static uint32_t batchOut[KBENCH_BATCH_MAX];  ///< Batches, too big for the worker stacks
+static uint32_t batchIn[KBENCH_BATCH_MAX];
+static QueueHandle_t messageQueue;  ///< Messages or pointers to pool blocks, only while the message benchmark runs
+static MemPoolHandle_t messagePool;
+static size_t messageSize;  ///< Size of the messages of the running message benchmark
+static uint8_t messageOut[KBENCH_MESSAGE_MAX];  ///< Message copies, too big for the worker stacks
+static uint8_t messageIn[KBENCH_MESSAGE_MAX];
+static volatile uint8_t messageSink;  ///< Last byte of each message received, so reading it is not optimised away
+static MessageBufferHandle_t logBuffer;  ///< Only while the log benchmark runs
+static SemaphoreHandle_t logMutex;  ///< Guards sends to a plain logBuffer
+static uint8_t logWriters;  ///< Writers of the running log benchmark
+static uint8_t logLine[KBENCH_LOG_LINE];  ///< Line sent by every writer
+static uint8_t logIn[KBENCH_LOG_LINE];
+static TaskHandle_t sleepers[KBENCH_SLEEPERS];  ///< Suspended unless the timeout benchmark needs them delayed
+
+static volatile kBench_Count spinStamp;  ///< Last time seen by the runner while waiting for latencyTimer
+static volatile kBench_Count latencyTotal;
+static volatile bool latencyFired;
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static kBench_Count kBench_Now(void);
+static void kBench_Worker(void * parameter);
+static void kBench_Sleeper(void * parameter);
+static kBench_Count kBench_RunTasks(TaskHandle_t *tasks, uint8_t count, kBench_Job job);
+static kBench_Count kBench_RunJob(kBench_Job job);
+static kBench_Count kBench_RunTimeout(uint16_t blocked);
+static kBench_Count kBench_RunTimerCommand(void);
+static kBench_Count kBench_RunBatch(UBaseType_t size);
+static kBench_Count kBench_RunMessage(size_t size, kBench_Job job);
+static kBench_Count kBench_RunLog(uint8_t writers, kBench_Job job);
+static kBench_Count kBench_RunTimerLatency(void);
+static void kBench_TimerCallback(TimerHandle_t xTimer);
+static void kBench_Report(const char *primitive, const char *pattern, uint32_t operations, kBench_Count total);
+
+static void kBench_Yield(uint8_t worker);
+static void kBench_QueuePingPong(uint8_t worker);
+static void kBench_QueueFanIn(uint8_t worker);
+static void kBench_QueueIsr(QueueHandle_t queue, void *item);
+static void kBench_QueueIsrByte(uint8_t worker);
+static void kBench_QueueIsrWord(uint8_t worker);
+static void kBench_QueueIsrToTask(uint8_t worker);
+static void kBench_StreamIsrToTask(uint8_t worker);
+static void kBench_ChannelIsrToTask(uint8_t worker);
+static void kBench_SemaphorePingPong(uint8_t worker);
+static void kBench_SemaphoreFanIn(uint8_t worker);
+static void kBench_NotifyPingPong(uint8_t worker);
+static void kBench_NotifyFanIn(uint8_t worker);
+static void kBench_TimeoutPingPong(uint8_t worker);
+static void kBench_QueueBatch(uint8_t worker);
+static void kBench_MessageCopy(uint8_t worker);
+static void kBench_MessagePointer(uint8_t worker);
+#if (configUSE_QUEUE_LOANS == 1)
+static void kBench_MessageLoan(uint8_t worker);
+#endif
+static void kBench_LogMutex(uint8_t worker);
+#if (configUSE_CONCURRENT_STREAM_BUFFERS == 1)
+static void kBench_LogConcurrent(uint8_t worker);
+#endif
+
+/// Numbers of other delayed tasks the timeout benchmark runs with
+static const uint16_t blockedCounts[] = { 0, KBENCH_SLEEPERS / 4, KBENCH_SLEEPERS };
+
+/// Items per call of the batch benchmark, up to KBENCH_BATCH_MAX
+static const uint8_t batchSizes[] = { 1, 8, KBENCH_BATCH_MAX };
+
+/// Message sizes of the message benchmark, up to KBENCH_MESSAGE_MAX
+static const uint16_t messageSizes[] = { 4, 64, 128, KBENCH_MESSAGE_MAX };
+
+static const kBench_Message messageKinds[] = {
+	{ "copy-",		kBench_MessageCopy },
+	{ "pointer-",	kBench_MessagePointer },
+#if (configUSE_QUEUE_LOANS == 1)
+	{ "loan-",		kBench_MessageLoan },
+#endif
+};
+
+/// Numbers of writers of the log benchmark, up to KBENCH_LOG_WRITERS
+static const uint8_t logWriterCounts[] = { 2, 4, KBENCH_LOG_WRITERS };
+
+static const kBench_Message logKinds[] = {
+	{ "mutex-",			kBench_LogMutex },
+#if (configUSE_CONCURRENT_STREAM_BUFFERS == 1)
+	{ "concurrent-",	kBench_LogConcurrent },
+#endif
+};
+
+static const kBench_Benchmark benchmarks[] = {
+	{ "switch",		"yield",		kBench_Yield,				2 * KBENCH_ITERATIONS },
+	{ "queue",		"ping-pong",	kBench_QueuePingPong,		KBENCH_ITERATIONS },
+	{ "queue",		"fan-in",		kBench_QueueFanIn,			(KBENCH_WORKERS - 1) * KBENCH_ITERATIONS },
+	{ "queue",		"isr-1",		kBench_QueueIsrByte,		KBENCH_ITERATIONS },
+	{ "queue",		"isr-4",		kBench_QueueIsrWord,		KBENCH_ITERATIONS },
+	{ "queue",		"isr-to-task",	kBench_QueueIsrToTask,		KBENCH_ITERATIONS },
+	{ "stream",		"isr-to-task",	kBench_StreamIsrToTask,		KBENCH_ITERATIONS },
+	{ "channel",	"isr-to-task",	kBench_ChannelIsrToTask,	KBENCH_ITERATIONS },
+	{ "semaphore",	"ping-pong",	kBench_SemaphorePingPong,	KBENCH_ITERATIONS },
+	{ "semaphore",	"fan-in",		kBench_SemaphoreFanIn,		(KBENCH_WORKERS - 1) * KBENCH_ITERATIONS },
+	{ "notify",		"ping-pong",	kBench_NotifyPingPong,		KBENCH_ITERATIONS },
+	{ "notify",		"fan-in",		kBench_NotifyFanIn,			(KBENCH_WORKERS - 1) * KBENCH_ITERATIONS },
+};
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_Now(void)
+* @brief	Reads the benchmark clock
+* @details 	On the target the tick count and the SysTick down-counter are
+*			combined into a cycle count. The tick count is read again to
+*			catch a tick interrupt between the two reads. With tickless
+*			idle the tick comes from the RTC and SysTick free-runs over
+*			24 bits instead, its wraps are counted here.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		Current time in KBENCH_UNIT
+* @note         Task context with interrupts enabled. Wraps after 2^32
+*				units, about 89 s at 48 MHz. With tickless idle, calls
+*				must be less than 2^24 cycles (349 ms) apart to see
+*				every SysTick wrap.
+*****************************************************************************/
+static kBench_Count kBench_Now(void)
+{
+#if defined(__arm__) && (configUSE_TICKLESS_IDLE == 1)
+    static uint32_t wraps, last;
+    uint32_t current;
+    kBench_Count now;
+
+    taskENTER_CRITICAL();
+    current = SysTick->LOAD - SysTick->VAL;
+    if (current < last) {
+        wraps++;
+    }
+    last = current;
+    now = (wraps * (SysTick->LOAD + 1)) + current;
+    taskEXIT_CRITICAL();
+
+    return now;
+#elif defined(__arm__)
+    TickType_t ticks;
+    uint32_t current;
+
+    do {
+        ticks = xTaskGetTickCount();
+        current = SysTick->VAL;
+    } while (ticks != xTaskGetTickCount());
+
+    return (ticks * (SysTick->LOAD + 1)) + (SysTick->LOAD - current);
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (kBench_Count)(((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec);
+#endif
+}
+
+/**************************************************************************//**
+* @fn		static void kBench_Worker(void * parameter)
+* @brief	Runs its part of every benchmark job
+* @param[in]	parameter - Worker index
+* @param[out]	N/A
+* @return		N/A
+* @note         Suspended while no benchmark runs
+*****************************************************************************/
+static void kBench_Worker(void * parameter)
+{
+	uint8_t worker = (uint8_t)(uintptr_t)parameter;
+
+	while(1) {
+		vTaskSuspend(NULL);
+		workerJob(worker);
+		xSemaphoreGive(jobDone);
+	}
+}
+
+/**************************************************************************//**
+* @fn		static void kBench_Sleeper(void * parameter)
+* @brief	Stays delayed until it is suspended
+* @details 	Each sleeper has its own wake time, so they are spread over
+*			the delayed task structure instead of waking together.
+* @param[in]	parameter - Sleeper index
+* @param[out]	N/A
+* @return		N/A
+* @note         Suspended while the timeout benchmark does not need it
+*****************************************************************************/
+static void kBench_Sleeper(void * parameter)
+{
+	uint16_t sleeper = (uint16_t)(uintptr_t)parameter;
+
+	while(1) {
+		vTaskDelay(KBENCH_SLEEP + sleeper);
+	}
+}
+
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_RunTasks(TaskHandle_t *tasks, uint8_t count, kBench_Job job)
+* @brief	Runs one benchmark on suspended kBench_Worker tasks and times it
+* @details 	The tasks are resumed with the scheduler suspended so they
+*			all become ready together, then run above the runner until
+*			every one of them has given jobDone. Resuming and the final
+*			gives are part of the time, which is negligible once spread
+*			over KBENCH_ITERATIONS.
+* @param[in]	tasks - Tasks to run the job on, the index in tasks is
+*				the worker number passed to job
+*				count - Number of tasks, up to KBENCH_TASKS_MAX
+*				job - Job to run
+* @param[out]	N/A
+* @return		Total time of the run
+* @note         Runner task only
+*****************************************************************************/
+static kBench_Count kBench_RunTasks(TaskHandle_t *tasks, uint8_t count, kBench_Job job)
+{
+    kBench_Count start;
+    uint8_t i;
+
+    workerJob = job;
+    start = kBench_Now();
+
+    vTaskSuspendAll();
+    for (i = 0; i < count; i++) {
+        vTaskResume(tasks[i]);
+    }
+    xTaskResumeAll();
+
+    for (i = 0; i < count; i++) {
+        xSemaphoreTake(jobDone, portMAX_DELAY);
+    }
+
+    return kBench_Now() - start;
+}
+
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_RunJob(kBench_Job job)
+* @brief	Runs one benchmark on all workers and times it
+* @param[in]	job - Job to run
+* @param[out]	N/A
+* @return		Total time of the run
+* @note         Runner task only
+*****************************************************************************/
+static kBench_Count kBench_RunJob(kBench_Job job)
+{
+    return kBench_RunTasks(workers, KBENCH_WORKERS, job);
+}
+
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_RunTimeout(uint16_t blocked)
+* @brief	Times the queue ping-pong with a block time while other tasks
+*			are delayed
+* @details 	The sleepers run above the runner, so each one is delayed
+*			again as soon as it is resumed. Every receive of the
+*			ping-pong then puts its task among them, which is where a
+*			sorted delayed list pays for each of them.
+* @param[in]	blocked - Sleepers delayed during the run
+* @param[out]	N/A
+* @return		Total time of the run
+* @note         Runner task only
+*****************************************************************************/
+static kBench_Count kBench_RunTimeout(uint16_t blocked)
+{
+    kBench_Count total;
+    uint16_t i;
+
+    for (i = 0; i < blocked; i++) {
+        vTaskResume(sleepers[i]);
+    }
+
+    total = kBench_RunJob(kBench_TimeoutPingPong);
+
+    for (i = 0; i < blocked; i++) {
+        vTaskSuspend(sleepers[i]);
+    }
+
+    return total;
+}
+
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_RunTimerCommand(void)
+* @brief	Times the dispatch of timer commands
+* @details 	The timer task has a higher priority than the runner, so each
+*			xTimerReset is queued, received, processed and returned from
+*			before the next one is sent.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		Total time of KBENCH_ITERATIONS commands
+* @note         Runner task only
+*****************************************************************************/
+static kBench_Count kBench_RunTimerCommand(void)
+{
+    kBench_Count start = kBench_Now();
+    uint32_t i;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i++) {
+        xTimerReset(commandTimer, portMAX_DELAY);
+    }
+
+    start = kBench_Now() - start;
+    xTimerStop(commandTimer, portMAX_DELAY);
+    return start;
+}
+
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_RunBatch(UBaseType_t size)
+* @brief	Times the stream of items from worker 1 to worker 0 with the
+*			batch queue calls
+* @details 	The queue holds KBENCH_BATCH_MAX items, so a whole batch
+*			always fits once the consumer has emptied it.
+* @param[in]	size - Items per call, up to KBENCH_BATCH_MAX
+* @param[out]	N/A
+* @return		Total time of KBENCH_ITERATIONS items, 0 if the heap is
+*				too small
+* @note         Runner task only
+*****************************************************************************/
+static kBench_Count kBench_RunBatch(UBaseType_t size)
+{
+    kBench_Count total = 0;
+
+    batchSize = size;
+    batchQueue = xQueueCreate(KBENCH_BATCH_MAX, sizeof(uint32_t));
+    if (batchQueue != NULL) {
+        total = kBench_RunJob(kBench_QueueBatch);
+        vQueueDelete(batchQueue);
+    }
+    return total;
+}
+
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_RunMessage(size_t size, kBench_Job job)
+* @brief	Times the stream of messages of one size from worker 1 to
+*			worker 0
+* @details 	The queue, and the pool for pointers, are created for the run
+*			and deleted afterwards, so only one size at a time takes heap.
+* @param[in]	size - Message size in bytes, up to KBENCH_MESSAGE_MAX
+*				job - One of the messageKinds jobs
+* @param[out]	N/A
+* @return		Total time of KBENCH_ITERATIONS messages, 0 if the heap
+*				is too small
+* @note         Runner task only
+*****************************************************************************/
+static kBench_Count kBench_RunMessage(size_t size, kBench_Job job)
+{
+    bool pointer = (job == kBench_MessagePointer);
+    kBench_Count total = 0;
+
+    messageSize = size;
+    if (pointer) {
+        messagePool = xMemPoolCreate(size, KBENCH_MESSAGE_SLOTS);
+        messageQueue = xQueueCreate(KBENCH_MESSAGE_SLOTS, sizeof(void *));
+    } else {
+        messagePool = NULL;
+        messageQueue = xQueueCreate(KBENCH_MESSAGE_SLOTS, size);
+    }
+
+    if ((messageQueue != NULL) && (!pointer || (messagePool != NULL))) {
+        total = kBench_RunJob(job);
+    }
+
+    if (messageQueue != NULL) {
+        vQueueDelete(messageQueue);
+    }
+    if (messagePool != NULL) {
+        vMemPoolDelete(messagePool);
+    }
+    return total;
+}
+
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_RunLog(uint8_t writers, kBench_Job job)
+* @brief	Times lines written by several tasks to one log message buffer
+* @details 	Task 0 reads, the others write. The tasks and the buffer are
+*			created for the run and deleted afterwards, the tasks suspend
+*			themselves as soon as they are created, like the workers.
+* @param[in]	writers - Writing tasks, up to KBENCH_LOG_WRITERS
+*				job - One of the logKinds jobs
+* @param[out]	N/A
+* @return		Total time of writers * KBENCH_ITERATIONS lines, 0 if
+*				the heap is too small
+* @note         Runner task only
+*****************************************************************************/
+static kBench_Count kBench_RunLog(uint8_t writers, kBench_Job job)
+{
+    TaskHandle_t tasks[KBENCH_TASKS_MAX];
+    kBench_Count total = 0;
+    uint8_t created = 0;
+
+    logWriters = writers;
+#if (configUSE_CONCURRENT_STREAM_BUFFERS == 1)
+    if (job == kBench_LogConcurrent) {
+        logMutex = NULL;
+        logBuffer = xMessageBufferCreateConcurrent(KBENCH_LOG_SIZE);
+    } else
+#endif
+    {
+        logMutex = xSemaphoreCreateMutex();
+        logBuffer = xMessageBufferCreate(KBENCH_LOG_SIZE);
+    }
+
+    if ((logBuffer != NULL) && ((logMutex != NULL) || (job != kBench_LogMutex))) {
+        while ((created <= writers) &&
+               (xTaskCreate(kBench_Worker, "Log", KBENCH_WORKER_STACK, (void *)(uintptr_t)created, KBENCH_WORKER_PRIORITY, &tasks[created]) == pdPASS)) {
+            created++;
+        }
+        if (created > writers) {
+            total = kBench_RunTasks(tasks, created, job);
+        }
+    }
+
+    while (created > 0) {
+        vTaskDelete(tasks[--created]);
+    }
+    if (logBuffer != NULL) {
+        vMessageBufferDelete(logBuffer);
+    }
+    if (logMutex != NULL) {
+        vSemaphoreDelete(logMutex);
+    }
+    return total;
+}
+
+/**************************************************************************//**
+* @fn		static kBench_Count kBench_RunTimerLatency(void)
+* @brief	Times how long a timer callback runs after its tick
+* @details 	The runner keeps stamping spinStamp until latencyTimer has
+*			fired. The tick interrupt and the timer task preempt it, so
+*			the callback sees the last stamp taken before the tick and the
+*			difference is the expiry latency: tick interrupt, switch to
+*			the timer task, timer list processing and callback dispatch.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		Total latency of KBENCH_TIMER_SAMPLES expiries
+* @note         Runner task only
+*****************************************************************************/
+static kBench_Count kBench_RunTimerLatency(void)
+{
+    uint32_t i;
+
+    latencyTotal = 0;
+    for (i = 0; i < KBENCH_TIMER_SAMPLES; i++) {
+        latencyFired = false;
+        xTimerStart(latencyTimer, portMAX_DELAY);
+        while (!latencyFired) {
+            spinStamp = kBench_Now();
+        }
+    }
+
+    return latencyTotal;
+}
+
+/**************************************************************************//**
+* @fn		static void kBench_TimerCallback(TimerHandle_t xTimer)
+* @brief	Callback of commandTimer and latencyTimer
+* @param[in]	xTimer - Expired timer
+* @param[out]	N/A
+* @return		N/A
+* @note         Runs in the timer service task
+*****************************************************************************/
+static void kBench_TimerCallback(TimerHandle_t xTimer)
+{
+    if (xTimer == latencyTimer) {
+        latencyTotal += kBench_Now() - spinStamp;
+        latencyFired = true;
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void kBench_Report(const char *primitive, const char *pattern, uint32_t operations, kBench_Count total)
+* @brief	Prints the result line of a benchmark
+* @details 	Waits for room in the TX buffer instead of letting the line be
+*			dropped, so every result reaches the PC.
+* @param[in]	primitive, pattern - Benchmark name
+*				operations - Operations timed
+*				total - Time of all operations
+* @param[out]	N/A
+* @return		N/A
+* @note         Runner task only, never while a benchmark is timed
+*****************************************************************************/
+static void kBench_Report(const char *primitive, const char *pattern, uint32_t operations, kBench_Count total)
+{
+    char line[KBENCH_LINE_SIZE] = "";  // Initialised as GCC takes end, a const pointer into it, for a read
+    const char *end = &line[KBENCH_LINE_SIZE - KLINE_ROOM];
+    char *out;
+
+    out = kLine_Append(line, end, "bench,");
+    out = kLine_Append(out, end, primitive);
+    out = kLine_Append(out, end, ",");
+    out = kLine_Append(out, end, pattern);
+    out = kLine_Append(out, end, ",");
+    out = kLine_AppendUnsigned(out, end, operations);
+    out = kLine_Append(out, end, ",");
+    out = kLine_AppendUnsigned(out, end, total);
+    out = kLine_Append(out, end, ",");
+    out = kLine_AppendUnsigned(out, end, total / operations);
+    out = kLine_Append(out, end, "," KBENCH_UNIT);
+    kLine_Write(line, out);
+}
+
+/******************************************************************************
+* Benchmark Jobs
+******************************************************************************/
+static void kBench_Yield(uint8_t worker)
+{
+    uint32_t i;
+
+    if (worker < 2) {
+        for (i = 0; i < KBENCH_ITERATIONS; i++) {
+            taskYIELD();
+        }
+    }
+}
+
+static void kBench_QueuePingPong(uint8_t worker)
+{
+    uint32_t i, value;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (worker == 0) {
+            xQueueSend(pingQueue, &i, portMAX_DELAY);
+            xQueueReceive(pongQueue, &value, portMAX_DELAY);
+        } else if (worker == 1) {
+            xQueueReceive(pingQueue, &value, portMAX_DELAY);
+            xQueueSend(pongQueue, &value, portMAX_DELAY);
+        }
+    }
+}
+
+static void kBench_QueueFanIn(uint8_t worker)
+{
+    uint32_t i, value;
+
+    if (worker == 0) {
+        for (i = 0; i < (KBENCH_WORKERS - 1) * KBENCH_ITERATIONS; i++) {
+            xQueueReceive(fanInQueue, &value, portMAX_DELAY);
+        }
+    } else {
+        for (i = 0; i < KBENCH_ITERATIONS; i++) {
+            xQueueSend(fanInQueue, &i, portMAX_DELAY);
+        }
+    }
+}
+
+static void kBench_QueueIsr(QueueHandle_t queue, void *item)
+{
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t woken = pdFALSE;
+    uint32_t i, j;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i += KBENCH_QUEUE_LENGTH) {
+        uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+        for (j = 0; j < KBENCH_QUEUE_LENGTH; j++) {
+            xQueueSendFromISR(queue, item, &woken);
+        }
+        for (j = 0; j < KBENCH_QUEUE_LENGTH; j++) {
+            xQueueReceiveFromISR(queue, item, &woken);
+        }
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+    }
+}
+
+static void kBench_QueueIsrByte(uint8_t worker)
+{
+    uint8_t item = 0;
+
+    if (worker == 0) {
+        kBench_QueueIsr(isrByteQueue, &item);
+    }
+}
+
+static void kBench_QueueIsrWord(uint8_t worker)
+{
+    uint32_t item = 0;
+
+    if (worker == 0) {
+        kBench_QueueIsr(isrWordQueue, &item);
+    }
+}
+
+static void kBench_QueueIsrToTask(uint8_t worker)
+{
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t woken = pdFALSE;
+    uint8_t item = 0;
+    uint32_t i, j;
+
+    if (worker == 0) {
+        for (i = 0; i < KBENCH_ITERATIONS; i += KBENCH_QUEUE_LENGTH) {
+            uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+            for (j = 0; j < KBENCH_QUEUE_LENGTH; j++) {
+                xQueueSendFromISR(isrByteQueue, &item, &woken);
+            }
+            portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+            for (j = 0; j < KBENCH_QUEUE_LENGTH; j++) {
+                xQueueReceive(isrByteQueue, &item, 0);
+            }
+        }
+    }
+}
+
+static void kBench_StreamIsrToTask(uint8_t worker)
+{
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t woken = pdFALSE;
+    uint8_t item = 0;
+    uint32_t i, j;
+
+    if (worker == 0) {
+        for (i = 0; i < KBENCH_ITERATIONS; i += KBENCH_QUEUE_LENGTH) {
+            uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+            for (j = 0; j < KBENCH_QUEUE_LENGTH; j++) {
+                xStreamBufferSendFromISR(isrStream, &item, 1, &woken);
+            }
+            portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+            for (j = 0; j < KBENCH_QUEUE_LENGTH; j++) {
+                xStreamBufferReceive(isrStream, &item, 1, 0);
+            }
+        }
+    }
+}
+
+static void kBench_ChannelIsrToTask(uint8_t worker)
+{
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t woken = pdFALSE;
+    uint8_t item = 0;
+    uint32_t i, j;
+
+    if (worker == 0) {
+        for (i = 0; i < KBENCH_ITERATIONS; i += KBENCH_QUEUE_LENGTH) {
+            uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+            for (j = 0; j < KBENCH_QUEUE_LENGTH; j++) {
+                xChannelSendFromISR(isrChannel, &item, &woken);
+            }
+            portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+            for (j = 0; j < KBENCH_QUEUE_LENGTH; j++) {
+                xChannelReceive(isrChannel, &item, 0);
+            }
+        }
+        // The first send of each burst notified this worker, clear the
+        // count before the notify benchmarks take from it
+        ulTaskNotifyTake(pdTRUE, 0);
+    }
+}
+
+static void kBench_QueueBatch(uint8_t worker)
+{
+    uint32_t done = 0;
+    UBaseType_t count;
+
+    // Each call moves what it can, which may be less than a batch
+    while (done < KBENCH_ITERATIONS) {
+        count = ((KBENCH_ITERATIONS - done) < batchSize) ? (KBENCH_ITERATIONS - done) : batchSize;
+        if (worker == 0) {
+            done += xQueueReceiveMultiple(batchQueue, batchIn, count, portMAX_DELAY);
+        } else if (worker == 1) {
+            batchOut[0] = done;
+            done += xQueueSendMultiple(batchQueue, batchOut, count, portMAX_DELAY);
+        } else {
+            break;
+        }
+    }
+}
+
+static void kBench_SemaphorePingPong(uint8_t worker)
+{
+    uint32_t i;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (worker == 0) {
+            xSemaphoreGive(pingSemaphore);
+            xSemaphoreTake(pongSemaphore, portMAX_DELAY);
+        } else if (worker == 1) {
+            xSemaphoreTake(pingSemaphore, portMAX_DELAY);
+            xSemaphoreGive(pongSemaphore);
+        }
+    }
+}
+
+static void kBench_SemaphoreFanIn(uint8_t worker)
+{
+    uint32_t i;
+
+    if (worker == 0) {
+        for (i = 0; i < (KBENCH_WORKERS - 1) * KBENCH_ITERATIONS; i++) {
+            xSemaphoreTake(fanInSemaphore, portMAX_DELAY);
+        }
+    } else {
+        for (i = 0; i < KBENCH_ITERATIONS; i++) {
+            xSemaphoreGive(fanInSemaphore);
+        }
+    }
+}
+
+static void kBench_NotifyPingPong(uint8_t worker)
+{
+    uint32_t i;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (worker == 0) {
+            xTaskNotifyGive(workers[1]);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        } else if (worker == 1) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            xTaskNotifyGive(workers[0]);
+        }
+    }
+}
+
+static void kBench_NotifyFanIn(uint8_t worker)
+{
+    uint32_t i;
+
+    if (worker == 0) {
+        // Take one notification at a time, each give is one item
+        for (i = 0; i < (KBENCH_WORKERS - 1) * KBENCH_ITERATIONS; i++) {
+            ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+        }
+    } else {
+        for (i = 0; i < KBENCH_ITERATIONS; i++) {
+            xTaskNotifyGive(workers[0]);
+        }
+    }
+}
+
+static void kBench_TimeoutPingPong(uint8_t worker)
+{
+    uint32_t i, value;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (worker == 0) {
+            xQueueSend(pingQueue, &i, KBENCH_TIMEOUT);
+            xQueueReceive(pongQueue, &value, KBENCH_TIMEOUT);
+        } else if (worker == 1) {
+            xQueueReceive(pingQueue, &value, KBENCH_TIMEOUT);
+            xQueueSend(pongQueue, &value, KBENCH_TIMEOUT);
+        }
+    }
+}
+
+static void kBench_MessageCopy(uint8_t worker)
+{
+    uint32_t i;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (worker == 0) {
+            xQueueReceive(messageQueue, messageIn, portMAX_DELAY);
+            messageSink = messageIn[messageSize - 1];
+        } else if (worker == 1) {
+            memset(messageOut, (uint8_t)i, messageSize);
+            xQueueSend(messageQueue, messageOut, portMAX_DELAY);
+        }
+    }
+}
+
+static void kBench_MessagePointer(uint8_t worker)
+{
+    uint8_t *message;
+    uint32_t i;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (worker == 0) {
+            xQueueReceive(messageQueue, &message, portMAX_DELAY);
+            messageSink = message[messageSize - 1];
+            vMemPoolFree(messagePool, message);
+        } else if (worker == 1) {
+            message = pvMemPoolAlloc(messagePool, portMAX_DELAY);
+            memset(message, (uint8_t)i, messageSize);
+            xQueueSend(messageQueue, &message, portMAX_DELAY);
+        }
+    }
+}
+
+#if (configUSE_QUEUE_LOANS == 1)
+static void kBench_MessageLoan(uint8_t worker)
+{
+    uint8_t *message;
+    uint32_t i;
+
+    for (i = 0; i < KBENCH_ITERATIONS; i++) {
+        if (worker == 0) {
+            message = pvQueueLoanReceive(messageQueue, portMAX_DELAY);
+            messageSink = message[messageSize - 1];
+            vQueueReleaseReceive(messageQueue);
+        } else if (worker == 1) {
+            message = pvQueueLoanSend(messageQueue, portMAX_DELAY);
+            memset(message, (uint8_t)i, messageSize);
+            vQueueCommitSend(messageQueue);
+        }
+    }
+}
+#endif
+
+static void kBench_LogMutex(uint8_t worker)
+{
+    uint32_t i;
+
+    if (worker == 0) {
+        for (i = 0; i < (uint32_t)logWriters * KBENCH_ITERATIONS; i++) {
+            xMessageBufferReceive(logBuffer, logIn, sizeof(logIn), portMAX_DELAY);
+        }
+    } else {
+        for (i = 0; i < KBENCH_ITERATIONS; i++) {
+            xSemaphoreTake(logMutex, portMAX_DELAY);
+            xMessageBufferSend(logBuffer, logLine, sizeof(logLine), portMAX_DELAY);
+            xSemaphoreGive(logMutex);
+        }
+    }
+}
+
+#if (configUSE_CONCURRENT_STREAM_BUFFERS == 1)
+static void kBench_LogConcurrent(uint8_t worker)
+{
+    uint32_t i;
+
+    if (worker == 0) {
+        for (i = 0; i < (uint32_t)logWriters * KBENCH_ITERATIONS; i++) {
+            xMessageBufferReceive(logBuffer, logIn, sizeof(logIn), portMAX_DELAY);
+        }
+    } else {
+        for (i = 0; i < KBENCH_ITERATIONS; i++) {
+            xMessageBufferSend(logBuffer, logLine, sizeof(logLine), portMAX_DELAY);
+        }
+    }
+}
+#endif
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		void kBench_Task(void * parameter)
+* @brief	Creates the benchmark objects, runs every benchmark and prints
+*			the results
+* @details 	Must be created at a priority below the timer task and
+*			KBENCH_WORKER_PRIORITY. On the host simulator the scheduler is
+*			ended afterwards, so a CI job can simply capture stdout.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Selected with CURRENT_TASK == BENCHMARK_TASK
+*****************************************************************************/
+void kBench_Task(void * parameter)
+{
+	uint16_t i;
+
+	jobDone = xSemaphoreCreateCounting(KBENCH_TASKS_MAX, 0);
+	pingQueue = xQueueCreate(1, sizeof(uint32_t));
+	pongQueue = xQueueCreate(1, sizeof(uint32_t));
+	fanInQueue = xQueueCreate(KBENCH_QUEUE_LENGTH, sizeof(uint32_t));
+	isrByteQueue = xQueueCreate(KBENCH_QUEUE_LENGTH, sizeof(uint8_t));
+	isrWordQueue = xQueueCreate(KBENCH_QUEUE_LENGTH, sizeof(uint32_t));
+	isrStream = xStreamBufferCreate(2 * KBENCH_QUEUE_LENGTH, 1);  // Must exceed the size of a message length, even for a stream
+	isrChannel = xChannelCreate(KBENCH_QUEUE_LENGTH, sizeof(uint8_t));
+	pingSemaphore = xSemaphoreCreateBinary();
+	pongSemaphore = xSemaphoreCreateBinary();
+	fanInSemaphore = xSemaphoreCreateCounting((KBENCH_WORKERS - 1) * KBENCH_ITERATIONS, 0);
+	commandTimer = xTimerCreate("Bench", KBENCH_COMMAND_PERIOD, pdFALSE, NULL, kBench_TimerCallback);
+	latencyTimer = xTimerCreate("Latency", 1, pdFALSE, NULL, kBench_TimerCallback);
+
+	// Workers run above this task, each one suspends itself as soon as it is created
+	for (i = 0; i < KBENCH_WORKERS; i++) {
+		xTaskCreate(kBench_Worker, "Bench", KBENCH_WORKER_STACK, (void *)(uintptr_t)i, KBENCH_WORKER_PRIORITY, &workers[i]);
+	}
+	// Sleepers delay themselves as soon as they are created, and are kept
+	// suspended until needed, for the whole run
+	for (i = 0; i < KBENCH_SLEEPERS; i++) {
+		xTaskCreate(kBench_Sleeper, "Sleep", configMINIMAL_STACK_SIZE, (void *)(uintptr_t)i, KBENCH_WORKER_PRIORITY, &sleepers[i]);
+		vTaskSuspend(sleepers[i]);
+	}
+
+	dUART_WriteString("# primitive,pattern,operations,total,per_op,unit\r\n");
+	for (i = 0; i < (sizeof(benchmarks) / sizeof(benchmarks[0])); i++) {
+		kBench_Count total = kBench_RunJob(benchmarks[i].job);
+		kBench_Report(benchmarks[i].primitive, benchmarks[i].pattern, benchmarks[i].operations, total);
+	}
+	for (i = 0; i < (sizeof(blockedCounts) / sizeof(blockedCounts[0])); i++) {
+		char pattern[16];
+		char *end = kLine_AppendUnsigned(kLine_Append(pattern, &pattern[sizeof(pattern) - 1], "blocked-"), &pattern[sizeof(pattern) - 1], blockedCounts[i]);
+
+		*end = '\0';
+		kBench_Report("timeout", pattern, KBENCH_ITERATIONS, kBench_RunTimeout(blockedCounts[i]));
+	}
+	for (i = 0; i < (sizeof(batchSizes) / sizeof(batchSizes[0])); i++) {
+		char pattern[16];
+		char *end = kLine_AppendUnsigned(kLine_Append(pattern, &pattern[sizeof(pattern) - 1], "batch-"), &pattern[sizeof(pattern) - 1], batchSizes[i]);
+
+		*end = '\0';
+		kBench_Report("queue", pattern, KBENCH_ITERATIONS, kBench_RunBatch(batchSizes[i]));
+	}
+	for (i = 0; i < (sizeof(messageSizes) / sizeof(messageSizes[0])); i++) {
+		uint8_t kind;
+
+		for (kind = 0; kind < (sizeof(messageKinds) / sizeof(messageKinds[0])); kind++) {
+			char pattern[16];
+			char *end = kLine_AppendUnsigned(kLine_Append(pattern, &pattern[sizeof(pattern) - 1], messageKinds[kind].pattern), &pattern[sizeof(pattern) - 1], messageSizes[i]);
+
+			*end = '\0';
+			kBench_Report("message", pattern, KBENCH_ITERATIONS, kBench_RunMessage(messageSizes[i], messageKinds[kind].job));
+		}
+	}
+	for (i = 0; i < (sizeof(logWriterCounts) / sizeof(logWriterCounts[0])); i++) {
+		uint8_t kind;
+
+		for (kind = 0; kind < (sizeof(logKinds) / sizeof(logKinds[0])); kind++) {
+			char pattern[16];
+			char *end = kLine_AppendUnsigned(kLine_Append(pattern, &pattern[sizeof(pattern) - 1], logKinds[kind].pattern), &pattern[sizeof(pattern) - 1], logWriterCounts[i]);
+
+			*end = '\0';
+			kBench_Report("log", pattern, (uint32_t)logWriterCounts[i] * KBENCH_ITERATIONS, kBench_RunLog(logWriterCounts[i], logKinds[kind].job));
+		}
+	}
+	kBench_Report("timer", "command", KBENCH_ITERATIONS, kBench_RunTimerCommand());
+	kBench_Report("timer", "latency", KBENCH_TIMER_SAMPLES, kBench_RunTimerLatency());
+	dUART_WriteString("# done\r\n");
+
+#if !defined(__arm__)
+	while (!dUART_IsTxEmpty()) {
+		vTaskDelay(1);
+	}
+	vTaskEndScheduler();
+#endif
+	vTaskSuspend(NULL);
+}
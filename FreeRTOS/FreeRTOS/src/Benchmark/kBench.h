@@ -0,0 +1,43 @@
+/**************************************************************************//**
+* @file      kBench.h
+* @brief     Kernel microbenchmarks
+* @author    Adi
+* @date      2024-1-8
+
+******************************************************************************/
+#ifndef KBENCH_H_
+#define KBENCH_H_
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include "SerialConsole/dUART.h"
+/******************************************************************************
+* Defines
+******************************************************************************/
+#ifndef KBENCH_ITERATIONS
+#define KBENCH_ITERATIONS		1000	///< Operations per worker and benchmark
+#endif
+#define KBENCH_TIMER_SAMPLES	100		///< Timer expiries measured, each one costs a tick
+#define KBENCH_WORKERS			3		///< Worker 0 is the consumer of fan-in patterns, the others produce
+#define KBENCH_QUEUE_LENGTH		8		///< Length of the fan-in and isr queues, a power of two dividing KBENCH_ITERATIONS
+#define KBENCH_WORKER_PRIORITY	3		///< Above the timer task, so workers are never interrupted by it
+#define KBENCH_WORKER_STACK		130
+#define KBENCH_BATCH_MAX		64		///< Largest batch of the batch benchmark, and length of its queue
+#define KBENCH_MESSAGE_MAX		256		///< Largest message of the message benchmark
+#define KBENCH_MESSAGE_SLOTS	4		///< Messages in flight, queue length and pool blocks
+#define KBENCH_LOG_WRITERS		8		///< Most tasks writing at once in the log benchmark
+#define KBENCH_LOG_LINE			24		///< Bytes per line of the log benchmark
+#define KBENCH_LOG_SIZE			256		///< Bytes of the log message buffer
+#if defined(__arm__)
+#define KBENCH_SLEEPERS			8		///< Most tasks kept blocked by the timeout benchmark, bounded by the heap
+#else
+#define KBENCH_SLEEPERS			256
+#endif
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+void kBench_Task(void * parameter);
+
+#endif /* KBENCH_H_ */
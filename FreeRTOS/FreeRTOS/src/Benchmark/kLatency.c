@@ -0,0 +1,199 @@
+/**************************************************************************//**
+* @file      kLatency.c
+* @brief     Critical section latency statistics
+* @details   With configUSE_CRITICAL_SECTION_STATS set, the port times every
+*            outermost taskENTER_CRITICAL/taskEXIT_CRITICAL pair and hands
+*            the time interrupts were masked to kLatency_Record, together
+*            with the address the section was entered from. Each call site
+*            keeps a count, its worst case and a histogram, so the paths
+*            that hold off the UART interrupt the longest can be found.
+*
+*            kLatency_Dump (CLI command "crit") prints one CSV line per
+*            call site, worst first, and starts a new measurement:
+*            crit,<caller>,<count>,<max>,<bucket 0>,...,<bucket 7>,<unit>
+*            Callers are return addresses, arm-none-eabi-addr2line -e
+*            FreeRTOS.elf <caller> names the kernel function. The unit is
+*            CPU cycles on the target (SysTick) and nanoseconds on the host
+*            simulator (CLOCK_MONOTONIC).
+* @author    Adi
+* @date      2024-1-10
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <asf.h>
+#include "kLatency.h"
+#include "kLine.h"
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KLATENCY_LINE_SIZE		128	 // Longest result line
+#define KLATENCY_STACK_MARGIN	16	 // Words of its 130 the console task must have left after a dump, checked in debug builds
+
+#if defined(__arm__)
+#define KLATENCY_UNIT	"cycles"
+#else
+#define KLATENCY_UNIT	"ns"
+#endif
+
+#if (KLATENCY_SITES & (KLATENCY_SITES - 1)) != 0
+#error KLATENCY_SITES must be a power of 2
+#endif
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+#if (configUSE_CRITICAL_SECTION_STATS == 1)
+/// Statistics of the critical sections entered from one address
+typedef struct {
+	const void *caller;  ///< NULL while the slot is free
+	uint32_t count;
+	uint32_t max;
+	uint16_t histogram[KLATENCY_BUCKETS];  ///< Saturates at UINT16_MAX
+} kLatency_Site;
+
+static kLatency_Site sites[KLATENCY_SITES];  ///< Open addressing on the caller, only written with interrupts masked
+static uint32_t untracked;  ///< Sections from call sites that found the table full
+static kLatency_Site snapshot[KLATENCY_SITES];  ///< Copy printed by kLatency_Dump, too big for the console task's stack
+static char line[KLATENCY_LINE_SIZE];  ///< Line printed by kLatency_Dump, also kept off that stack
+#endif
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+#if (configUSE_CRITICAL_SECTION_STATS == 1)
+/**************************************************************************//**
+* @fn		void kLatency_Record(const void *caller, uint32_t duration)
+* @brief	Adds one critical section to the statistics of its call site
+* @details 	The slot is found by hashing the caller and probing linearly,
+*			which takes a single step unless call sites collide. It runs
+*			at the end of the section, so it is not part of the time
+*			measured, but it does add to the time interrupts are masked.
+* @param[in]	caller - Address the section was entered from
+*				duration - Time interrupts were masked, in KLATENCY_UNIT
+* @param[out]	N/A
+* @return		N/A
+* @note         Called by the port as configRECORD_CRITICAL_SECTION, with
+*				interrupts masked
+*****************************************************************************/
+void kLatency_Record(const void *caller, uint32_t duration)
+{
+    uint32_t slot = (uint32_t)((uintptr_t)caller >> 1);
+    uint32_t limit = KLATENCY_FIRST_BUCKET;
+    uint8_t bucket = 0;
+    uint8_t probe;
+    kLatency_Site *site = NULL;
+
+    for (probe = 0; probe < KLATENCY_SITES; probe++) {
+        site = &sites[(slot + probe) & (KLATENCY_SITES - 1)];
+        if (site->caller == caller) {
+            break;
+        }
+        if (site->caller == NULL) {
+            site->caller = caller;
+            break;
+        }
+    }
+    if (probe == KLATENCY_SITES) {
+        untracked++;
+        return;
+    }
+
+    while ((bucket < (KLATENCY_BUCKETS - 1)) && (duration >= limit)) {
+        bucket++;
+        limit <<= 2;
+    }
+
+    site->count++;
+    if (duration > site->max) {
+        site->max = duration;
+    }
+    if (site->histogram[bucket] != UINT16_MAX) {
+        site->histogram[bucket]++;
+    }
+}
+#endif
+
+/**************************************************************************//**
+* @fn		int32_t kLatency_Dump(void)
+* @brief	Prints the statistics of every call site, worst first, and
+*			clears them
+* @details 	The table is copied and cleared in one critical section, which
+*			shows up in the next dump, then sorted and printed from the
+*			copy.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		0, -1 if configUSE_CRITICAL_SECTION_STATS is off
+* @note         Task context only, not reentrant
+*****************************************************************************/
+int32_t kLatency_Dump(void)
+{
+#if (configUSE_CRITICAL_SECTION_STATS == 1)
+    const char *end = &line[KLATENCY_LINE_SIZE - KLINE_ROOM];
+    char *out;
+    uint32_t skipped, limit;
+    uint8_t i, j, bucket;
+
+    taskENTER_CRITICAL();
+    memcpy(snapshot, sites, sizeof(sites));
+    memset(sites, 0, sizeof(sites));
+    skipped = untracked;
+    untracked = 0;
+    taskEXIT_CRITICAL();
+
+    // Insertion sort on the worst case, free slots sort last
+    for (i = 1; i < KLATENCY_SITES; i++) {
+        kLatency_Site site = snapshot[i];
+
+        for (j = i; (j > 0) && (snapshot[j - 1].max < site.max); j--) {
+            snapshot[j] = snapshot[j - 1];
+        }
+        snapshot[j] = site;
+    }
+
+    out = kLine_Append(line, end, "# caller,count,max");
+    for (bucket = 0, limit = KLATENCY_FIRST_BUCKET; bucket < (KLATENCY_BUCKETS - 1); bucket++, limit <<= 2) {
+        out = kLine_Append(out, end, ",<");
+        out = kLine_AppendUnsigned(out, end, limit);
+    }
+    out = kLine_Append(out, end, ",more,unit");
+    kLine_Write(line, out);
+
+    for (i = 0; (i < KLATENCY_SITES) && (snapshot[i].caller != NULL); i++) {
+        out = kLine_Append(line, end, "crit,");
+        out = kLine_AppendHex(out, end, (uintptr_t)snapshot[i].caller);
+        out = kLine_Append(out, end, ",");
+        out = kLine_AppendUnsigned(out, end, snapshot[i].count);
+        out = kLine_Append(out, end, ",");
+        out = kLine_AppendUnsigned(out, end, snapshot[i].max);
+        for (bucket = 0; bucket < KLATENCY_BUCKETS; bucket++) {
+            out = kLine_Append(out, end, ",");
+            out = kLine_AppendUnsigned(out, end, snapshot[i].histogram[bucket]);
+        }
+        out = kLine_Append(out, end, "," KLATENCY_UNIT);
+        kLine_Write(line, out);
+    }
+
+    out = kLine_Append(line, end, "# untracked,");
+    out = kLine_AppendUnsigned(out, end, skipped);
+    kLine_Write(line, out);
+
+#ifdef DEBUG
+    configASSERT(uxTaskGetStackHighWaterMark(NULL) >= KLATENCY_STACK_MARGIN);
+#endif
+    return 0;
+#else
+    dUART_WriteString((char *)"Set configUSE_CRITICAL_SECTION_STATS to 1 for critical section statistics\r\n");
+    return -1;
+#endif
+}
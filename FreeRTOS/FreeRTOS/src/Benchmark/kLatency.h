@@ -0,0 +1,28 @@
+/**************************************************************************//**
+* @file      kLatency.h
+* @brief     Critical section latency statistics
+* @author    Adi
+* @date      2024-1-10
+
+******************************************************************************/
+#ifndef KLATENCY_H_
+#define KLATENCY_H_
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include "SerialConsole/dUART.h"
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KLATENCY_SITES			32		///< Call sites tracked, a power of 2. Sections from further sites are only counted
+#define KLATENCY_BUCKETS		8		///< Histogram buckets, each one 4 times as wide as the previous one
+#define KLATENCY_FIRST_BUCKET	64		///< Upper bound of the first bucket, in cycles or ns
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+void kLatency_Record(const void *caller, uint32_t duration);
+int32_t kLatency_Dump(void);
+
+#endif /* KLATENCY_H_ */
@@ -0,0 +1,94 @@
+/**************************************************************************//**
+* @file      kLine.c
+* @brief     Line formatting for the CSV output of the benchmarks
+* @details   kBench, kLatency and kTop build their result lines in a
+*            buffer without printf: each Append call adds to the line and
+*            returns the position after it, truncating at end. kLine_Write
+*            ends the line and prints it whole.
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <asf.h>
+#include "kLine.h"
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		char * kLine_Append(char *out, const char *end, const char *text)
+* @brief	Appends text to a line, truncating it at end
+* @return		Position after the appended text
+*****************************************************************************/
+char * kLine_Append(char *out, const char *end, const char *text)
+{
+    while ((*text != '\0') && (out < end)) {
+        *out++ = *text++;
+    }
+    return out;
+}
+
+/**************************************************************************//**
+* @fn		char * kLine_AppendUnsigned(char *out, const char *end, uint32_t value)
+* @brief	Appends a decimal number to a line, truncating it at end
+* @return		Position after the appended number
+*****************************************************************************/
+char * kLine_AppendUnsigned(char *out, const char *end, uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+
+    do {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    while ((count > 0) && (out < end)) {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+/**************************************************************************//**
+* @fn		char * kLine_AppendHex(char *out, const char *end, uintptr_t value)
+* @brief	Appends an address as 0x and every hex digit of a pointer
+* @return		Position after the appended number
+*****************************************************************************/
+char * kLine_AppendHex(char *out, const char *end, uintptr_t value)
+{
+    int8_t shift;
+
+    out = kLine_Append(out, end, "0x");
+    for (shift = (int8_t)((sizeof(value) * 8) - 4); (shift >= 0) && (out < end); shift -= 4) {
+        *out++ = "0123456789abcdef"[(value >> shift) & 0xF];
+    }
+    return out;
+}
+
+/**************************************************************************//**
+* @fn		void kLine_Write(char *line, char *out)
+* @brief	Terminates and prints a line
+* @details 	Waits for room in the TX buffer instead of letting the line be
+*			dropped, so every line reaches the PC.
+* @param[in]	line - Start of the line
+*				out - End of its text, at least KLINE_ROOM bytes before
+*				the end of the buffer
+* @param[out]	N/A
+* @return		N/A
+* @note         Task context only
+*****************************************************************************/
+void kLine_Write(char *line, char *out)
+{
+    *out++ = '\r';
+    *out++ = '\n';
+    *out = '\0';
+
+    while (dUART_GetTxSpace() < (size_t)(out - line)) {
+        vTaskDelay(1);
+    }
+    dUART_WriteString(line);
+}
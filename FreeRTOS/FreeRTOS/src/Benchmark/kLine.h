@@ -0,0 +1,28 @@
+/**************************************************************************//**
+* @file      kLine.h
+* @brief     Line formatting for the CSV output of the benchmarks
+* @author    Adi
+* @date      2024-1-14
+
+******************************************************************************/
+#ifndef KLINE_H_
+#define KLINE_H_
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include "SerialConsole/dUART.h"
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KLINE_ROOM		3		///< Bytes a line keeps free after its text, for the "\r\n" and '\0' of kLine_Write
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+char * kLine_Append(char *out, const char *end, const char *text);
+char * kLine_AppendUnsigned(char *out, const char *end, uint32_t value);
+char * kLine_AppendHex(char *out, const char *end, uintptr_t value);
+void kLine_Write(char *line, char *out);
+
+#endif /* KLINE_H_ */
@@ -0,0 +1,239 @@
+/**************************************************************************//**
+* @file      kTop.c
+* @brief     Run-time statistics and per task CPU accounting
+* @details   Provides the run time counter of configGENERATE_RUN_TIME_STATS
+*            and a low priority task that streams a top-style table (CLI
+*            command "top <period ms>", "top 0" stops it):
+*            # interval,<ms>
+*            top,<task>,<state>,<priority>,<cpu %>,<stack high water mark>
+*            CPU % is the share of the interval since the previous table,
+*            so a task polling without blocking stands out at once. The
+*            high water mark is the least free stack ever seen, in words.
+*
+*            The counter is TC4 and TC5 chained into one 32-bit counter at
+*            KTOP_COUNTER_HZ, so it wraps about every 24 minutes. Tables
+*            only use differences, which survive the wrap as long as the
+*            period is shorter. The TC keeps counting through tickless
+*            idle, which only stops the CPU clock, so the sleep time is
+*            charged to the idle task. On the host simulator the counter
+*            is CLOCK_MONOTONIC in microseconds.
+* @author    Adi
+* @date      2024-1-11
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <asf.h>
+#include "kTop.h"
+#include "kLine.h"
+#if !defined(__arm__)
+#include <time.h>
+#endif
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KTOP_LINE_SIZE		64	 // Longest table line
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+static TaskHandle_t topTask;  ///< Created by the first "top" command, then kept for the later ones
+static volatile uint32_t topPeriod;  ///< Time between two tables in ms, 0 while stopped
+
+static TaskStatus_t taskStatus[KTOP_MAX_TASKS];  ///< Current table, too big for the stack of topTask
+static TaskHandle_t lastHandle[KTOP_MAX_TASKS];  ///< Tasks of the previous table
+static uint32_t lastCounter[KTOP_MAX_TASKS];  ///< Their run time counters at the time
+static UBaseType_t lastCount;
+static uint32_t lastTotal;  ///< Run time counter at the previous table
+#if !defined(__arm__)
+static uint64_t counterBase;  ///< CLOCK_MONOTONIC at kTop_ConfigureTimer, so the counter starts at 0 as on the target
+#endif
+
+static const char * const stateName[] = { "running", "ready", "blocked", "suspended", "deleted" };
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void kTop_Task(void * parameter);
+static void kTop_Print(void);
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static void kTop_Task(void * parameter)
+* @brief	Prints a table every topPeriod ms
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Notified by kTop_SetPeriod to start, stop or change period
+*****************************************************************************/
+static void kTop_Task(void * parameter)
+{
+	while(1) {
+		if (topPeriod == 0) {
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		} else {
+			kTop_Print();
+			ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(topPeriod));
+		}
+	}
+}
+
+/**************************************************************************//**
+* @fn		static void kTop_Print(void)
+* @brief	Prints the table of the interval since the previous one
+* @details 	uxTaskGetSystemState suspends the scheduler while it copies
+*			the task states, the formatting is done afterwards from the
+*			copy. A task is matched with its previous counter by handle,
+*			a task created since then is charged its whole counter.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         topTask only
+*****************************************************************************/
+static void kTop_Print(void)
+{
+    char line[KTOP_LINE_SIZE];
+    const char *end = &line[KTOP_LINE_SIZE - KLINE_ROOM];
+    char *out;
+    UBaseType_t count, i, j;
+    uint32_t total, elapsed, used, permille;
+
+    count = uxTaskGetSystemState(taskStatus, KTOP_MAX_TASKS, &total);
+    if (count == 0) {
+        dUART_WriteString((char *)"More tasks than KTOP_MAX_TASKS\r\n");
+        return;
+    }
+    elapsed = total - lastTotal;
+
+    out = kLine_Append(line, end, "# interval,");
+    out = kLine_AppendUnsigned(out, end, elapsed / (KTOP_COUNTER_HZ / 1000));
+    out = kLine_Append(out, end, " ms\r\n# task,state,priority,cpu %,stack");
+    kLine_Write(line, out);
+
+    for (i = 0; i < count; i++) {
+        used = taskStatus[i].ulRunTimeCounter;
+        for (j = 0; j < lastCount; j++) {
+            if (lastHandle[j] == taskStatus[i].xHandle) {
+                used -= lastCounter[j];
+                break;
+            }
+        }
+        // Per mille without a 64-bit division, the Cortex-M0 has no divider
+        permille = (elapsed >= 1000) ? (used / (elapsed / 1000)) : 0;
+
+        out = kLine_Append(line, end, "top,");
+        out = kLine_Append(out, end, taskStatus[i].pcTaskName);
+        out = kLine_Append(out, end, ",");
+        out = kLine_Append(out, end, (taskStatus[i].eCurrentState < (sizeof(stateName) / sizeof(stateName[0]))) ? stateName[taskStatus[i].eCurrentState] : "invalid");
+        out = kLine_Append(out, end, ",");
+        out = kLine_AppendUnsigned(out, end, taskStatus[i].uxCurrentPriority);
+        out = kLine_Append(out, end, ",");
+        out = kLine_AppendUnsigned(out, end, permille / 10);
+        out = kLine_Append(out, end, ".");
+        out = kLine_AppendUnsigned(out, end, permille % 10);
+        out = kLine_Append(out, end, ",");
+        out = kLine_AppendUnsigned(out, end, taskStatus[i].usStackHighWaterMark);
+        kLine_Write(line, out);
+    }
+
+    for (i = 0; i < count; i++) {
+        lastHandle[i] = taskStatus[i].xHandle;
+        lastCounter[i] = taskStatus[i].ulRunTimeCounter;
+    }
+    lastCount = count;
+    lastTotal = total;
+}
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		void kTop_ConfigureTimer(void)
+* @brief	Starts the run time counter
+* @details 	TC4 in 32-bit mode takes TC5 as its upper half. It is clocked
+*			from GCLK0 divided by 16 and read with continuous read
+*			synchronisation, so a read of COUNT does not stall on the bus.
+*			On the host simulator the current time becomes the origin.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Called by vTaskStartScheduler as
+*				portCONFIGURE_TIMER_FOR_RUN_TIME_STATS. KTOP_COUNTER_HZ
+*				assumes GCLK0 runs at 48 MHz.
+*****************************************************************************/
+void kTop_ConfigureTimer(void)
+{
+#if defined(__arm__)
+    PM->APBCMASK.reg |= PM_APBCMASK_TC4 | PM_APBCMASK_TC5;
+    GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID_TC4_TC5 | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_CLKEN;
+    while (GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY) {
+    }
+
+    TC4->COUNT32.CTRLA.reg = TC_CTRLA_SWRST;
+    while ((TC4->COUNT32.CTRLA.reg & TC_CTRLA_SWRST) || (TC4->COUNT32.STATUS.reg & TC_STATUS_SYNCBUSY)) {
+    }
+    TC4->COUNT32.CTRLA.reg = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_PRESCALER_DIV16;
+    TC4->COUNT32.READREQ.reg = TC_READREQ_RREQ | TC_READREQ_RCONT | TC_READREQ_ADDR(TC_COUNT32_COUNT_OFFSET);
+    TC4->COUNT32.CTRLA.reg |= TC_CTRLA_ENABLE;
+    while (TC4->COUNT32.STATUS.reg & TC_STATUS_SYNCBUSY) {
+    }
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    counterBase = ((uint64_t)now.tv_sec * 1000000ULL) + ((uint64_t)now.tv_nsec / 1000ULL);
+#endif
+}
+
+/**************************************************************************//**
+* @fn		uint32_t kTop_GetCounter(void)
+* @brief	Reads the run time counter
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		Time in 1 / KTOP_COUNTER_HZ s, wraps at 2^32
+* @note         Called by the kernel at every context switch as
+*				portGET_RUN_TIME_COUNTER_VALUE
+*****************************************************************************/
+uint32_t kTop_GetCounter(void)
+{
+#if defined(__arm__)
+    return TC4->COUNT32.COUNT.reg;
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((((uint64_t)now.tv_sec * 1000000ULL) + ((uint64_t)now.tv_nsec / 1000ULL)) - counterBase);
+#endif
+}
+
+/**************************************************************************//**
+* @fn		int32_t kTop_SetPeriod(uint32_t periodMs)
+* @brief	Starts, changes or stops the table stream
+* @param[in]	periodMs - Time between two tables, 0 stops the stream
+* @param[out]	N/A
+* @return		0 on success, -1 if the period is too short or the task
+*				cannot be created
+* @note         Task context only
+*****************************************************************************/
+int32_t kTop_SetPeriod(uint32_t periodMs)
+{
+    if ((periodMs != 0) && (periodMs < KTOP_MIN_PERIOD_MS)) {
+        dUART_WriteString((char *)"Period must be 0 or at least 100 ms\r\n");
+        return -1;
+    }
+
+    topPeriod = periodMs;
+    if (topTask != NULL) {
+        // Wake it up, so the new period applies at once
+        xTaskNotifyGive(topTask);
+    } else if ((periodMs != 0) && (xTaskCreate(kTop_Task, "Top", KTOP_TASK_STACK, NULL, KTOP_TASK_PRIORITY, &topTask) != pdPASS)) {
+        topPeriod = 0;
+        dUART_WriteString((char *)"No memory for the top task\r\n");
+        return -1;
+    }
+    return 0;
+}
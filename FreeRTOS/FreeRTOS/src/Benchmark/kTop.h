@@ -0,0 +1,36 @@
+/**************************************************************************//**
+* @file      kTop.h
+* @brief     Run-time statistics and per task CPU accounting
+* @author    Adi
+* @date      2024-1-11
+
+******************************************************************************/
+#ifndef KTOP_H_
+#define KTOP_H_
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include "SerialConsole/dUART.h"
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KTOP_MAX_TASKS		12		///< Tasks shown, further ones are left out
+#define KTOP_TASK_STACK		160
+#define KTOP_TASK_PRIORITY	1		///< Same as the application tasks, so it only uses spare time
+#define KTOP_MIN_PERIOD_MS	100		///< Shortest time between two tables
+
+#if defined(__arm__)
+#define KTOP_COUNTER_HZ		3000000UL	///< TC4/TC5 as one 32-bit counter, GCLK0 (48 MHz) / 16
+#else
+#define KTOP_COUNTER_HZ		1000000UL	///< CLOCK_MONOTONIC in microseconds
+#endif
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+void kTop_ConfigureTimer(void);
+uint32_t kTop_GetCounter(void);
+int32_t kTop_SetPeriod(uint32_t periodMs);
+
+#endif /* KTOP_H_ */
@@ -0,0 +1,291 @@
+/**************************************************************************//**
+* @file      kTrace.c
+* @brief     Kernel trace recorder
+* @details   With configUSE_TRACE_RECORDER set, the kernel trace hooks (see
+*            kTrace.h) write 8 byte records into a RAM ring: run time
+*            counter, event, current task, object and value. The idle task
+*            streams them over the console UART next to the log, each one
+*            as KTRACE_FRAME_SYNC followed by the record, and
+*            tools/ktrace_json.py turns a capture into a Chrome trace /
+*            Perfetto JSON file:
+*            printf 'trace 7\r' | ./build/FreeRTOS_sim | ktrace_json.py > trace.json
+*
+*            Recording only masks interrupts around the copy of one record,
+*            it never enters a kernel critical section, so it may run from
+*            interrupts and from the critical sections timed by kLatency.
+*            When the ring is full new records are dropped and counted, a
+*            LOST record tells the viewer. At 115200 baud about 1200
+*            records per second get through, which is why ticks have their
+*            own class.
+*
+*            "trace <mask>" sends the counter frequency and the name of
+*            every task, then records the classes of mask, "trace 0" stops.
+* @author    Adi
+* @date      2024-1-12
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <asf.h>
+#include "kTrace.h"
+#include "kTop.h"
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KTRACE_FRAME_SIZE		(1 + sizeof(kTrace_Record_t))
+
+#if (KTRACE_RECORDS & (KTRACE_RECORDS - 1)) != 0
+#error KTRACE_RECORDS must be a power of 2
+#endif
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+volatile uint8_t kTraceMask;
+
+#if (configUSE_TRACE_RECORDER == 1)
+static kTrace_Record_t ring[KTRACE_RECORDS];
+static volatile uint16_t ringHead;  ///< Next record written, only moved with interrupts masked
+static volatile uint16_t ringTail;  ///< Next record sent, only moved by kTrace_Flush
+static uint32_t dropped;  ///< Records lost on a full ring since the last LOST record, interrupts masked
+static uint8_t queueCount;  ///< Queues created so far, the last queue number given out
+
+static TaskStatus_t taskStatus[KTRACE_MAX_TASKS];  ///< Tasks named by kTrace_Start, too big for the console task's stack
+#endif
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+#if (configUSE_TRACE_RECORDER == 1)
+static void kTrace_Write(uint32_t time, uint8_t event, uint8_t task, uint8_t object, uint8_t value);
+static void kTrace_Put(uint32_t time, uint8_t event, uint8_t task, uint8_t object, uint8_t value);
+static void kTrace_PutName(uint8_t task, const char *name);
+#endif
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+#if (configUSE_TRACE_RECORDER == 1)
+/**************************************************************************//**
+* @fn		static void kTrace_Write(uint32_t time, uint8_t event, uint8_t task, uint8_t object, uint8_t value)
+* @brief	Appends a record to the ring, or counts it as dropped
+* @details 	After drops, the first record that fits is preceded by a LOST
+*			record, so the viewer sees the gap where it happened.
+* @param[in]	time - Counter value, or the data of a START, TASK_NAME or
+*				LOST record
+*				event, task, object, value - See kTrace_Record_t
+* @param[out]	N/A
+* @return		N/A
+* @note         Interrupts masked by the caller
+*****************************************************************************/
+static void kTrace_Write(uint32_t time, uint8_t event, uint8_t task, uint8_t object, uint8_t value)
+{
+    uint16_t head = ringHead;
+    uint16_t space = KTRACE_RECORDS - (uint16_t)(head - ringTail);
+    kTrace_Record_t *record;
+
+    if ((space == 0) || ((dropped != 0) && (space < 2))) {
+        dropped++;
+        return;
+    }
+    if (dropped != 0) {
+        record = &ring[head++ & (KTRACE_RECORDS - 1)];
+        record->time = dropped;
+        record->event = KTRACE_LOST;
+        record->task = task;
+        record->object = 0;
+        record->value = 0;
+        dropped = 0;
+    }
+
+    record = &ring[head++ & (KTRACE_RECORDS - 1)];
+    record->time = time;
+    record->event = event;
+    record->task = task;
+    record->object = object;
+    record->value = value;
+    ringHead = head;
+}
+
+/**************************************************************************//**
+* @fn		static void kTrace_Put(uint32_t time, uint8_t event, uint8_t task, uint8_t object, uint8_t value)
+* @brief	Appends a record that carries data instead of a time
+* @param[in]	See kTrace_Write
+* @param[out]	N/A
+* @return		N/A
+* @note         Any context
+*****************************************************************************/
+static void kTrace_Put(uint32_t time, uint8_t event, uint8_t task, uint8_t object, uint8_t value)
+{
+    UBaseType_t uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+    kTrace_Write(time, event, task, object, value);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**************************************************************************//**
+* @fn		static void kTrace_PutName(uint8_t task, const char *name)
+* @brief	Sends the first 8 characters of a task name as two records
+* @param[in]	task - Task number
+*				name - NUL terminated name
+* @param[out]	N/A
+* @return		N/A
+* @note         Any context
+*****************************************************************************/
+static void kTrace_PutName(uint8_t task, const char *name)
+{
+    uint8_t chunk, i;
+
+    for (chunk = 0; chunk < 2; chunk++) {
+        uint32_t text = 0;
+
+        // Little-endian, so the characters come out in order; the rest stays NUL
+        for (i = 0; (i < 4) && (*name != '\0'); i++) {
+            text |= (uint32_t)(uint8_t)*name++ << (8 * i);
+        }
+        kTrace_Put(text, KTRACE_TASK_NAME, kTrace_CurrentTask(), task, chunk);
+    }
+}
+#endif
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+#if (configUSE_TRACE_RECORDER == 1)
+/**************************************************************************//**
+* @fn		void kTrace_Record(uint8_t event, uint8_t task, uint8_t object, uint8_t value)
+* @brief	Records an event at the current time
+* @details 	The counter is read with interrupts masked, so records are in
+*			time order even when an interrupt records in between.
+* @param[in]	event, task, object, value - See kTrace_Record_t
+* @param[out]	N/A
+* @return		N/A
+* @note         Called by the KTRACE hooks, any context
+*****************************************************************************/
+void kTrace_Record(uint8_t event, uint8_t task, uint8_t object, uint8_t value)
+{
+    UBaseType_t uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+    kTrace_Write(kTop_GetCounter(), event, task, object, value);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**************************************************************************//**
+* @fn		void kTrace_TaskCreated(uint8_t task, uint8_t priority, const char *name)
+* @brief	Records a task creation and the name of the new task
+* @param[in]	task - Number of the new task
+*				priority - Its priority
+*				name - Its name
+* @param[out]	N/A
+* @return		N/A
+* @note         Called by traceTASK_CREATE
+*****************************************************************************/
+void kTrace_TaskCreated(uint8_t task, uint8_t priority, const char *name)
+{
+    if ((kTraceMask & KTRACE_CLASS_SCHED) != 0) {
+        kTrace_Record(KTRACE_TASK_CREATE, kTrace_CurrentTask(), task, priority);
+        kTrace_PutName(task, name);
+    }
+}
+
+/**************************************************************************//**
+* @fn		uint8_t kTrace_QueueCreated(uint8_t type)
+* @brief	Numbers a new queue and records its creation
+* @param[in]	type - queueQUEUE_TYPE_* of the queue
+* @param[out]	N/A
+* @return		Queue number, kept by the kernel as uxQueueNumber
+* @note         Called by traceQUEUE_CREATE, task context
+*****************************************************************************/
+uint8_t kTrace_QueueCreated(uint8_t type)
+{
+    uint8_t number;
+
+    taskENTER_CRITICAL();
+    number = ++queueCount;
+    taskEXIT_CRITICAL();
+
+    if ((kTraceMask & KTRACE_CLASS_QUEUE) != 0) {
+        kTrace_Record(KTRACE_QUEUE_CREATE, kTrace_CurrentTask(), number, type);
+    }
+    return number;
+}
+
+/**************************************************************************//**
+* @fn		uint8_t kTrace_CurrentTask(void)
+* @brief	Number of the running task, or of the task an interrupt
+*			interrupted
+* @return		Task number, 0 before the first task is created
+*****************************************************************************/
+uint8_t kTrace_CurrentTask(void)
+{
+    return (uint8_t)uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle());
+}
+#endif
+
+/**************************************************************************//**
+* @fn		int32_t kTrace_Start(uint8_t mask)
+* @brief	Starts a new trace of the classes of mask, or stops tracing
+* @details 	The new trace begins with a START record, the counter
+*			frequency, and the names of the tasks that already exist, tasks
+*			created later are named by their TASK_CREATE record. Records of
+*			the previous trace still in the ring are sent first, the viewer
+*			starts over at START.
+* @param[in]	mask - KTRACE_CLASS_SCHED, KTRACE_CLASS_QUEUE... 0 stops
+* @param[out]	N/A
+* @return		0, -1 if configUSE_TRACE_RECORDER is off or there are more
+*				than KTRACE_MAX_TASKS tasks
+* @note         Task context only
+*****************************************************************************/
+int32_t kTrace_Start(uint8_t mask)
+{
+#if (configUSE_TRACE_RECORDER == 1)
+    UBaseType_t count, i;
+
+    kTraceMask = 0;
+    if (mask == 0) {
+        return 0;
+    }
+
+    kTrace_Put(KTOP_COUNTER_HZ, KTRACE_START, kTrace_CurrentTask(), 0, mask);
+    count = uxTaskGetSystemState(taskStatus, KTRACE_MAX_TASKS, NULL);
+    for (i = 0; i < count; i++) {
+        kTrace_PutName((uint8_t)taskStatus[i].xTaskNumber, taskStatus[i].pcTaskName);
+    }
+    kTraceMask = mask;
+
+    if (count == 0) {
+        dUART_WriteString((char *)"More tasks than KTRACE_MAX_TASKS, they are traced without names\r\n");
+        return -1;
+    }
+    return 0;
+#else
+    (void)mask;
+    dUART_WriteString((char *)"Set configUSE_TRACE_RECORDER to 1 for the trace recorder\r\n");
+    return -1;
+#endif
+}
+
+/**************************************************************************//**
+* @fn		void kTrace_Flush(void)
+* @brief	Moves pending records to the UART
+* @details 	Records stay queued while the TX buffer has no room for a whole
+*			frame.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Single consumer, called from the idle hook. Never blocks.
+*****************************************************************************/
+void kTrace_Flush(void)
+{
+#if (configUSE_TRACE_RECORDER == 1)
+    uint8_t frame[KTRACE_FRAME_SIZE];
+
+    frame[0] = KTRACE_FRAME_SYNC;
+    while ((ringTail != ringHead) && (dUART_GetTxSpace() >= KTRACE_FRAME_SIZE)) {
+        // The producers never overwrite an unsent record, no lock needed to copy it
+        memcpy(&frame[1], &ring[ringTail & (KTRACE_RECORDS - 1)], sizeof(kTrace_Record_t));
+        ringTail = ringTail + 1;
+        dUART_WriteBuffer(frame, KTRACE_FRAME_SIZE);
+    }
+#endif
+}
@@ -0,0 +1,165 @@
+/**************************************************************************//**
+* @file      kTrace.h
+* @brief     Kernel trace recorder
+* @details   Included at the end of FreeRTOSConfig.h when
+*            configUSE_TRACE_RECORDER is 1, so the trace hook macros below
+*            replace the empty defaults of FreeRTOS.h. It must therefore
+*            not include anything that includes FreeRTOS.h.
+* @author    Adi
+* @date      2024-1-12
+
+******************************************************************************/
+#ifndef KTRACE_H_
+#define KTRACE_H_
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdint.h>
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define KTRACE_RECORDS			256		///< Records buffered until the idle task streams them, a power of 2
+#define KTRACE_MAX_TASKS		12		///< Tasks named when a trace starts, further ones stay numbers
+#define KTRACE_FRAME_SYNC		0xA6	///< First byte of a record frame, never part of ASCII console text, unlike DLOG_FRAME_SYNC
+
+/// Event classes, the argument of the "trace" command is a mask of them
+#define KTRACE_CLASS_SCHED		0x01	///< Context switches, task creation, deletion, delays, suspend and resume
+#define KTRACE_CLASS_QUEUE		0x02	///< Queue, semaphore and mutex operations
+#define KTRACE_CLASS_NOTIFY		0x04	///< Direct to task notifications
+#define KTRACE_CLASS_TICK		0x08	///< Tick interrupts, 1000 records per second on their own
+
+/// Event table: X(id)
+/// Every record has a time, the current task and an object and value whose
+/// meaning depends on the event:
+/// SWITCH_IN         - task is the task switched in
+/// READY, TASK_*     - object is the task readied, created... created also
+///                     gives its priority as value
+/// TICK              - value is the low byte of the tick count
+/// QUEUE_*           - object is the queue number, value the number of
+///                     messages waiting before the operation. Created
+///                     gives the queue type (queueQUEUE_TYPE_*) as value
+/// NOTIFY*           - object is the task notified
+/// START, TASK_NAME and LOST carry data instead of a time: the counter
+/// frequency in Hz, 4 characters of the name of task object (value is the
+/// chunk, 0 or 1), and the number of records dropped on a full buffer.
+/// New events are only appended, the position in this list is the event
+/// number sent in frames and read by tools/ktrace_json.py.
+#define KTRACE_EVENTS(X) \
+	X(KTRACE_START) \
+	X(KTRACE_TASK_NAME) \
+	X(KTRACE_LOST) \
+	X(KTRACE_SWITCH_IN) \
+	X(KTRACE_READY) \
+	X(KTRACE_TASK_CREATE) \
+	X(KTRACE_TASK_DELETE) \
+	X(KTRACE_DELAY) \
+	X(KTRACE_DELAY_UNTIL) \
+	X(KTRACE_SUSPEND) \
+	X(KTRACE_RESUME) \
+	X(KTRACE_RESUME_FROM_ISR) \
+	X(KTRACE_TICK) \
+	X(KTRACE_QUEUE_CREATE) \
+	X(KTRACE_QUEUE_SEND) \
+	X(KTRACE_QUEUE_SEND_FAILED) \
+	X(KTRACE_QUEUE_SEND_FROM_ISR) \
+	X(KTRACE_QUEUE_SEND_FROM_ISR_FAILED) \
+	X(KTRACE_QUEUE_RECEIVE) \
+	X(KTRACE_QUEUE_RECEIVE_FAILED) \
+	X(KTRACE_QUEUE_RECEIVE_FROM_ISR) \
+	X(KTRACE_QUEUE_RECEIVE_FROM_ISR_FAILED) \
+	X(KTRACE_QUEUE_PEEK) \
+	X(KTRACE_QUEUE_BLOCK_SEND) \
+	X(KTRACE_QUEUE_BLOCK_RECEIVE) \
+	X(KTRACE_NOTIFY) \
+	X(KTRACE_NOTIFY_FROM_ISR) \
+	X(KTRACE_NOTIFY_GIVE_FROM_ISR) \
+	X(KTRACE_NOTIFY_TAKE) \
+	X(KTRACE_NOTIFY_TAKE_BLOCK) \
+	X(KTRACE_NOTIFY_WAIT) \
+	X(KTRACE_NOTIFY_WAIT_BLOCK)
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+#define KTRACE_ENUM(id)		id,
+typedef enum {
+	KTRACE_EVENTS(KTRACE_ENUM)
+	KTRACE_EVENT_COUNT
+} kTrace_Event;
+#undef KTRACE_ENUM
+
+/// One record, sent as is (little-endian) after KTRACE_FRAME_SYNC
+typedef struct {
+	uint32_t time;  ///< Run time counter, see kTop_GetCounter
+	uint8_t event;  ///< kTrace_Event
+	uint8_t task;  ///< Task number of the current task, 0 before the first task exists
+	uint8_t object;
+	uint8_t value;
+} kTrace_Record_t;
+
+extern volatile uint8_t kTraceMask;  ///< Event classes recorded, 0 while stopped
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+void kTrace_Record(uint8_t event, uint8_t task, uint8_t object, uint8_t value);
+void kTrace_TaskCreated(uint8_t task, uint8_t priority, const char *name);
+uint8_t kTrace_QueueCreated(uint8_t type);
+uint8_t kTrace_CurrentTask(void);
+int32_t kTrace_Start(uint8_t mask);
+void kTrace_Flush(void);
+
+/******************************************************************************
+* Kernel Trace Hooks
+******************************************************************************/
+#if (configUSE_TRACE_RECORDER == 1)
+/// Records an event if its class is enabled, a load and a branch otherwise
+#define KTRACE(class, event, task, object, value) \
+	do { \
+		if ((kTraceMask & (class)) != 0) { \
+			kTrace_Record((uint8_t)(event), (uint8_t)(task), (uint8_t)(object), (uint8_t)(value)); \
+		} \
+	} while (0)
+
+// tasks.c, where pxCurrentTCB is visible. uxTaskNumber is the number kept
+// for trace tools, it is set to the TCB number when the task is created.
+#define traceTASK_CREATE(pxNewTCB) \
+	do { \
+		(pxNewTCB)->uxTaskNumber = (pxNewTCB)->uxTCBNumber; \
+		kTrace_TaskCreated((uint8_t)(pxNewTCB)->uxTaskNumber, (uint8_t)(pxNewTCB)->uxPriority, (pxNewTCB)->pcTaskName); \
+	} while (0)
+#define traceTASK_SWITCHED_IN()						KTRACE(KTRACE_CLASS_SCHED, KTRACE_SWITCH_IN, pxCurrentTCB->uxTaskNumber, 0, 0)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)		KTRACE(KTRACE_CLASS_SCHED, KTRACE_READY, kTrace_CurrentTask(), (pxTCB)->uxTaskNumber, 0)
+#define traceTASK_DELETE(pxTCB)						KTRACE(KTRACE_CLASS_SCHED, KTRACE_TASK_DELETE, pxCurrentTCB->uxTaskNumber, (pxTCB)->uxTaskNumber, 0)
+#define traceTASK_DELAY()							KTRACE(KTRACE_CLASS_SCHED, KTRACE_DELAY, pxCurrentTCB->uxTaskNumber, 0, 0)
+#define traceTASK_DELAY_UNTIL(xTimeToWake)			KTRACE(KTRACE_CLASS_SCHED, KTRACE_DELAY_UNTIL, pxCurrentTCB->uxTaskNumber, 0, 0)
+#define traceTASK_SUSPEND(pxTCB)					KTRACE(KTRACE_CLASS_SCHED, KTRACE_SUSPEND, pxCurrentTCB->uxTaskNumber, (pxTCB)->uxTaskNumber, 0)
+#define traceTASK_RESUME(pxTCB)						KTRACE(KTRACE_CLASS_SCHED, KTRACE_RESUME, pxCurrentTCB->uxTaskNumber, (pxTCB)->uxTaskNumber, 0)
+#define traceTASK_RESUME_FROM_ISR(pxTCB)			KTRACE(KTRACE_CLASS_SCHED, KTRACE_RESUME_FROM_ISR, pxCurrentTCB->uxTaskNumber, (pxTCB)->uxTaskNumber, 0)
+#define traceTASK_INCREMENT_TICK(xTickCount)		KTRACE(KTRACE_CLASS_TICK, KTRACE_TICK, pxCurrentTCB->uxTaskNumber, 0, (xTickCount) + 1)
+#define traceTASK_NOTIFY()							KTRACE(KTRACE_CLASS_NOTIFY, KTRACE_NOTIFY, pxCurrentTCB->uxTaskNumber, pxTCB->uxTaskNumber, 0)
+#define traceTASK_NOTIFY_FROM_ISR()					KTRACE(KTRACE_CLASS_NOTIFY, KTRACE_NOTIFY_FROM_ISR, pxCurrentTCB->uxTaskNumber, pxTCB->uxTaskNumber, 0)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR()			KTRACE(KTRACE_CLASS_NOTIFY, KTRACE_NOTIFY_GIVE_FROM_ISR, pxCurrentTCB->uxTaskNumber, pxTCB->uxTaskNumber, 0)
+#define traceTASK_NOTIFY_TAKE()						KTRACE(KTRACE_CLASS_NOTIFY, KTRACE_NOTIFY_TAKE, pxCurrentTCB->uxTaskNumber, pxCurrentTCB->uxTaskNumber, 0)
+#define traceTASK_NOTIFY_TAKE_BLOCK()				KTRACE(KTRACE_CLASS_NOTIFY, KTRACE_NOTIFY_TAKE_BLOCK, pxCurrentTCB->uxTaskNumber, pxCurrentTCB->uxTaskNumber, 0)
+#define traceTASK_NOTIFY_WAIT()						KTRACE(KTRACE_CLASS_NOTIFY, KTRACE_NOTIFY_WAIT, pxCurrentTCB->uxTaskNumber, pxCurrentTCB->uxTaskNumber, 0)
+#define traceTASK_NOTIFY_WAIT_BLOCK()				KTRACE(KTRACE_CLASS_NOTIFY, KTRACE_NOTIFY_WAIT_BLOCK, pxCurrentTCB->uxTaskNumber, pxCurrentTCB->uxTaskNumber, 0)
+
+// queue.c, which only sees the current task through its handle
+#define traceQUEUE_CREATE(pxNewQueue)				((pxNewQueue)->uxQueueNumber = kTrace_QueueCreated((pxNewQueue)->ucQueueType))
+#define KTRACE_QUEUE_EVENT(event, pxQueue)			KTRACE(KTRACE_CLASS_QUEUE, (event), kTrace_CurrentTask(), (pxQueue)->uxQueueNumber, (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_SEND(pxQueue)					KTRACE_QUEUE_EVENT(KTRACE_QUEUE_SEND, pxQueue)
+#define traceQUEUE_SEND_FAILED(pxQueue)				KTRACE_QUEUE_EVENT(KTRACE_QUEUE_SEND_FAILED, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)			KTRACE_QUEUE_EVENT(KTRACE_QUEUE_SEND_FROM_ISR, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue)	KTRACE_QUEUE_EVENT(KTRACE_QUEUE_SEND_FROM_ISR_FAILED, pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)					KTRACE_QUEUE_EVENT(KTRACE_QUEUE_RECEIVE, pxQueue)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)			KTRACE_QUEUE_EVENT(KTRACE_QUEUE_RECEIVE_FAILED, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)		KTRACE_QUEUE_EVENT(KTRACE_QUEUE_RECEIVE_FROM_ISR, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue)	KTRACE_QUEUE_EVENT(KTRACE_QUEUE_RECEIVE_FROM_ISR_FAILED, pxQueue)
+#define traceQUEUE_PEEK(pxQueue)					KTRACE_QUEUE_EVENT(KTRACE_QUEUE_PEEK, pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)		KTRACE_QUEUE_EVENT(KTRACE_QUEUE_BLOCK_SEND, pxQueue)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)		KTRACE_QUEUE_EVENT(KTRACE_QUEUE_BLOCK_RECEIVE, pxQueue)
+#endif
+
+#endif /* KTRACE_H_ */
@@ -11,6 +11,10 @@
 ******************************************************************************/
 #include <asf.h>
 #include "CLI.h"
+#include "dLog.h"
+#include "Benchmark/kLatency.h"
+#include "Benchmark/kTop.h"
+#include "Benchmark/kTrace.h"
 /******************************************************************************
 * Defines
 ******************************************************************************/
@@ -18,10 +22,34 @@
 /******************************************************************************
 * Variables
 ******************************************************************************/
+/// Entry of the compile-time command table
+typedef struct {
+	const char *name;
+	const char *spec;
+	CLI_Handler handler;
+	const char *usage;
+} CLI_Command;
+
+#define CLI_ENTRY(name, spec, handler, usage)	{ name, spec, handler, usage },
+static const CLI_Command commands[] = { CLI_COMMANDS(CLI_ENTRY) };
+#undef CLI_ENTRY
+
+#define CLI_COMMAND_COUNT	(sizeof(commands) / sizeof(commands[0]))
+
+// Every argument spec must fit in CLI_Args.value, checked at compile time
+#define CLI_SPEC_CHECK(name, spec, handler, usage)	typedef char handler##_spec_check[((sizeof(spec) - 1) <= CLI_MAX_ARGS) ? 1 : -1];
+CLI_COMMANDS(CLI_SPEC_CHECK)
+#undef CLI_SPEC_CHECK
 
 /******************************************************************************
 * Forward Declarations
 ******************************************************************************/
+static char * CLI_NextToken(char **cursor, const char *end);
+static bool CLI_ParseInt(const char *token, int32_t *value);
+static const CLI_Command * CLI_FindCommand(const char *name);
+#ifdef DEBUG
+static void CLI_CheckTable(void);
+#endif
 
 /******************************************************************************
 * Callback Functions
@@ -30,6 +58,140 @@
 /******************************************************************************
 * Static Functions
 ******************************************************************************/
+/**************************************************************************//**
+* @fn		static char * CLI_NextToken(char **cursor, const char *end)
+* @brief	Splits the next space separated word off the input, in place
+* @details 	Reentrant replacement for strtok: the position is kept by the
+*			caller and the delimiter after the word is overwritten with '\0'.
+* @param[in]	cursor - Current position, advanced past the word
+*				end - End of the input, nothing at or after it is touched
+* @param[out]	N/A
+* @return		Start of the word, NULL if there are no more words
+* @note         
+*****************************************************************************/
+static char * CLI_NextToken(char **cursor, const char *end)
+{
+	char *p = *cursor;
+	char *token;
+
+	while((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'))) {
+		p++;
+	}
+	if((p >= end) || (*p == '\0')) {
+		*cursor = p;
+		return NULL;
+	}
+
+	token = p;
+	while((p < end) && (*p != '\0') && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n')) {
+		p++;
+	}
+	if(p < end) {
+		if(*p != '\0') {
+			*p++ = '\0';
+		}
+	} else {
+		// Word runs up to the end of the input, it must still be terminated
+		token = NULL;
+	}
+
+	*cursor = p;
+	return token;
+}
+
+/**************************************************************************//**
+* @fn		static bool CLI_ParseInt(const char *token, int32_t *value)
+* @brief	Strict decimal integer parser, replaces atoi
+* @param[in]	token - Optional sign followed by decimal digits only
+* @param[out]	value - Parsed value, only written on success
+* @return		false on an empty string, a stray character or an overflow
+* @note         
+*****************************************************************************/
+static bool CLI_ParseInt(const char *token, int32_t *value)
+{
+	bool negative = false;
+	uint32_t result = 0;
+	uint32_t limit = INT32_MAX;
+
+	if((*token == '-') || (*token == '+')) {
+		negative = (*token == '-');
+		token++;
+	}
+	if(negative) {
+		limit = (uint32_t)INT32_MAX + 1u;
+	}
+	if(*token == '\0') {
+		return false;
+	}
+
+	for(; *token != '\0'; token++) {
+		uint32_t digit = (uint32_t)(*token - '0');
+		if((digit > 9) || (result > ((limit - digit) / 10))) {
+			return false;
+		}
+		result = (result * 10) + digit;
+	}
+
+	*value = negative ? (int32_t)(0u - result) : (int32_t)result;
+	return true;
+}
+
+#ifdef DEBUG
+/**************************************************************************//**
+* @fn		static void CLI_CheckTable(void)
+* @brief	Asserts that CLI_COMMANDS is sorted, once
+* @details 	CLI_FindCommand would silently miss commands of an unsorted
+*			table. Debug builds only, the order cannot be checked by the
+*			preprocessor.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         
+*****************************************************************************/
+static void CLI_CheckTable(void)
+{
+	static bool checked = false;
+
+	if(!checked) {
+		for(size_t i = 1; i < CLI_COMMAND_COUNT; i++) {
+			configASSERT(strcmp(commands[i - 1].name, commands[i].name) < 0);
+		}
+		checked = true;
+	}
+}
+#endif
+
+/**************************************************************************//**
+* @fn		static const CLI_Command * CLI_FindCommand(const char *name)
+* @brief	Binary search of the sorted command table
+* @param[in]	name - Command word
+* @param[out]	N/A
+* @return		Table entry, NULL for an unknown command
+* @note         
+*****************************************************************************/
+static const CLI_Command * CLI_FindCommand(const char *name)
+{
+	size_t low = 0;
+	size_t high = CLI_COMMAND_COUNT;
+
+#ifdef DEBUG
+	CLI_CheckTable();
+#endif
+
+	while(low < high) {
+		size_t mid = (low + high) / 2;
+		int order = strcmp(name, commands[mid].name);
+
+		if(order == 0) {
+			return &commands[mid];
+		} else if(order < 0) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	return NULL;
+}
 
 /******************************************************************************
 * Global Functions
@@ -37,31 +199,145 @@
 
 /**************************************************************************//**
 * @fn		int32_t CLI_ExtractCmd(char * cmd, int32_t length)
-* @brief	Extract command from command line input			
-* @param[in]	cmd - Command line input
-*				length - length of command
+* @brief	Extract command from command line input and run it
+* @details 	The line is tokenized in place, the command is looked up in
+*			the CLI_COMMANDS table and each argument is checked against the
+*			command's spec before the handler is called. Nothing is
+*			allocated and no state is kept between calls.
+* @param[in]	cmd - Command line input, NUL terminated within length
+*				length - Size of the cmd buffer
 * @param[out]	N/A
-* @return		Status
+* @return		Handler result, -1 on an invalid command or argument
 * @note         
 *****************************************************************************/
 int32_t CLI_ExtractCmd(char * cmd, int32_t length) {
-	char* token = strtok(cmd, " ");
-	char str[20];
-	if(strncmp(token, COMMAND_LED, length) == 0) {
-		token = strtok(NULL, " ");
-		int delay = atoi(token);
-		dUART_WriteString((char *)"Valid command\r\n");
-		snprintf(str, 20, "Delay - %d\r\n", delay);
-		dUART_WriteString(str);
-		/*
-		if(xQueueSend(LEDQueue, (const void* )&delay, pdFALSE) != pdTRUE) {
-			dUART_WriteString("LED Queue Full!!\r\n");
-		}
-		*/
-		//dUART_WriteString((char *)"\r\n");
-		return delay;
-	} else {
+	char *cursor = cmd;
+	const char *end = cmd + length;
+	const CLI_Command *command;
+	CLI_Args args;
+	char *token;
+
+	if((cmd == NULL) || (length <= 0)) {
+		return -1;
+	}
+
+	token = CLI_NextToken(&cursor, end);
+	if(token == NULL) {
+		return -1;
+	}
+
+	command = CLI_FindCommand(token);
+	if(command == NULL) {
 		dUART_WriteString((char *)"Invalid command\r\n");
+		return -1;
+	}
+
+	for(args.count = 0; command->spec[args.count] != '\0'; args.count++) {
+		token = CLI_NextToken(&cursor, end);
+		if(token == NULL) {
+			break;
+		}
+		if(command->spec[args.count] == CLI_ARG_INT) {
+			if(!CLI_ParseInt(token, &args.value[args.count].i)) {
+				break;
+			}
+		} else {
+			args.value[args.count].s = token;
+		}
+	}
+
+	if((command->spec[args.count] != '\0') || (CLI_NextToken(&cursor, end) != NULL)) {
+		dUART_WriteString((char *)"Usage: ");
+		dUART_WriteString(command->usage);
+		dUART_WriteString((char *)"\r\n");
+		return -1;
+	}
+
+	dUART_WriteString((char *)"Valid command\r\n");
+	return command->handler(&args);
+}
+
+/**************************************************************************//**
+* @fn		int32_t CLI_Crit(const CLI_Args *args)
+* @brief	Prints the critical section statistics and starts over
+* @param[in]	args - None
+* @param[out]	N/A
+* @return		0, -1 if the statistics are not built in
+* @note         
+*****************************************************************************/
+int32_t CLI_Crit(const CLI_Args *args) {
+	return kLatency_Dump();
+}
+
+/**************************************************************************//**
+* @fn		int32_t CLI_Help(const CLI_Args *args)
+* @brief	Lists all commands with their usage
+* @param[in]	args - None
+* @param[out]	N/A
+* @return		0
+* @note         
+*****************************************************************************/
+int32_t CLI_Help(const CLI_Args *args) {
+	for(size_t i = 0; i < CLI_COMMAND_COUNT; i++) {
+		dUART_WriteString(commands[i].usage);
+		dUART_WriteString((char *)"\r\n");
+	}
+	return 0;
+}
+
+/**************************************************************************//**
+* @fn		int32_t CLI_Led(const CLI_Args *args)
+* @brief	Changes the LED blink delay
+* @param[in]	args - Blink delay in ms
+* @param[out]	N/A
+* @return		0 on success, -1 if the delay is out of range or LED_Task is busy
+* @note         
+*****************************************************************************/
+int32_t CLI_Led(const CLI_Args *args) {
+	int delay = (int)args->value[0].i;
+
+	if(delay <= 0) {
+		dUART_WriteString((char *)"Delay must be positive\r\n");
+		return -1;
+	}
+
+	dLog_Write(DLOG_CLI_DELAY, delay, 0);
+	if((LEDQueue == NULL) || (xQueueSend(LEDQueue, (const void* )&delay, 0) != pdTRUE)) {
+		dUART_WriteString("LED Queue Full!!\r\n");
+		return -1;
+	}
+	return 0;
+}
+
+/**************************************************************************//**
+* @fn		int32_t CLI_Top(const CLI_Args *args)
+* @brief	Streams per task CPU %, stack high water mark and state
+* @param[in]	args - Time between two tables in ms, 0 stops them
+* @param[out]	N/A
+* @return		0 on success, -1 on an invalid period
+* @note         
+*****************************************************************************/
+int32_t CLI_Top(const CLI_Args *args) {
+	if(args->value[0].i < 0) {
+		dUART_WriteString((char *)"Period must not be negative\r\n");
+		return -1;
+	}
+	return kTop_SetPeriod((uint32_t)args->value[0].i);
+}
+
+/**************************************************************************//**
+* @fn		int32_t CLI_Trace(const CLI_Args *args)
+* @brief	Starts or stops the kernel trace stream
+* @param[in]	args - Event classes: 1 scheduling, 2 queues, 4 notifications,
+*				8 ticks, 0 stops tracing
+* @param[out]	N/A
+* @return		0 on success, -1 on an invalid mask
+* @note         
+*****************************************************************************/
+int32_t CLI_Trace(const CLI_Args *args) {
+	if((args->value[0].i < 0) || (args->value[0].i > (KTRACE_CLASS_SCHED | KTRACE_CLASS_QUEUE | KTRACE_CLASS_NOTIFY | KTRACE_CLASS_TICK))) {
+		dUART_WriteString((char *)"Mask must be between 0 and 15\r\n");
+		return -1;
 	}
-	return -1;
-}
\ No newline at end of file
+	return kTrace_Start((uint8_t)args->value[0].i);
+}
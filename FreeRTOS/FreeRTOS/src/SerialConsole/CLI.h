@@ -15,17 +15,45 @@
 /******************************************************************************
 * Defines
 ******************************************************************************/
-#define COMMAND_LED		"led"
+#define CLI_MAX_ARGS		4	///< Maximum number of arguments a command can take
+
+/// Argument spec characters, one per expected argument, e.g. "is"
+#define CLI_ARG_INT			'i'	///< Signed decimal integer
+#define CLI_ARG_STRING		's'	///< Single word
+
+/// Command table: X(name, argument spec, handler, usage)
+/// Must be kept sorted by name, commands are found by binary search (checked
+/// in debug builds). A spec has at most CLI_MAX_ARGS characters (checked at
+/// compile time).
+#define CLI_COMMANDS(X) \
+	X("crit",	"",		CLI_Crit,	"crit") \
+	X("help",	"",		CLI_Help,	"help") \
+	X("led",	"i",	CLI_Led,	"led <blink delay ms>") \
+	X("top",	"i",	CLI_Top,	"top <period ms, 0 stops>") \
+	X("trace",	"i",	CLI_Trace,	"trace <event class mask, 0 stops>")
+
 /******************************************************************************
 * Variables
 ******************************************************************************/
+/// Parsed arguments handed to a command handler
+typedef struct {
+	uint8_t count;
+	union {
+		int32_t i;
+		const char *s;
+	} value[CLI_MAX_ARGS];
+} CLI_Args;
+
+/// Command handler, returns 0 on success or -1 on error
+typedef int32_t (*CLI_Handler)(const CLI_Args *args);
 
 /******************************************************************************
 * Function Prototypes
 ******************************************************************************/
 int32_t CLI_ExtractCmd(char * cmd, int32_t length);
 
+#define CLI_PROTOTYPE(name, spec, handler, usage)	int32_t handler(const CLI_Args *args);
+CLI_COMMANDS(CLI_PROTOTYPE)
+#undef CLI_PROTOTYPE
 
-
-
-#endif /* CLI_H_ */
\ No newline at end of file
+#endif /* CLI_H_ */
@@ -19,22 +19,80 @@
  #include <stdint.h>
  #include <stddef.h>
  #include <stdbool.h>
+ #include <string.h>
  #include <assert.h>
 
  #include "circular_buffer.h"
 
 
+ #if CIRCULAR_BUF_POW2
+ // Free-running counter to array index, a mask instead of a division
+ #define CBUF_INDEX(cbuf, i)	((i) & (cbuf)->mask)
+ #define CBUF_MAX(cbuf)			((cbuf)->mask + 1)
+ #else
+ #define CBUF_INDEX(cbuf, i)	(i)
+ #define CBUF_MAX(cbuf)			((cbuf)->max)
+ #endif
+
+ #if CIRCULAR_BUF_SPSC
+ #if !CIRCULAR_BUF_POW2
+ #error CIRCULAR_BUF_SPSC requires CIRCULAR_BUF_POW2
+ #endif
+
+ // The producer only stores head, the consumer only stores tail. Data is
+ // written before head is released and read before tail is released, so
+ // each side always sees a consistent view of the other's index. On the
+ // single-core M0+ these compile to plain ldr/str plus a dmb.
+ #define CBUF_LOAD_ACQUIRE(x)		__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+ #define CBUF_STORE_RELEASE(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+ #else
+ #define CBUF_LOAD_ACQUIRE(x)		(x)
+ #define CBUF_STORE_RELEASE(x, v)	((x) = (v))
+ #endif
+
  // The definition of our circular buffer structure is hidden from the user
  struct circular_buf_t {
 	 uint8_t * buffer;
 	 size_t head;
 	 size_t tail;
+ #if CIRCULAR_BUF_POW2
+	 // head and tail are never wrapped, occupancy is (head - tail)
+	 size_t mask; //size of the buffer - 1
+ #else
 	 size_t max; //of the buffer
 	 bool full;
+ #endif
  };
 
+ // circular_buf_static_t must be able to hold a circular_buf_t
+ typedef char circular_buf_static_size_check[(sizeof(circular_buf_static_t) == sizeof(circular_buf_t)) ? 1 : -1];
+
  #pragma mark - Private Functions -
 
+ #if CIRCULAR_BUF_POW2
+ static void advance_pointer(cbuf_handle_t cbuf)
+ {
+	 //assert(cbuf);
+
+	 CBUF_STORE_RELEASE(cbuf->head, cbuf->head + 1);
+
+ #if !CIRCULAR_BUF_SPSC
+
+	 // Overwrite mode: drop the oldest element once the buffer is over-full
+	 if((cbuf->head - cbuf->tail) > CBUF_MAX(cbuf))
+	 {
+		 cbuf->tail++;
+	 }
+ #endif
+ }
+
+ static void retreat_pointer(cbuf_handle_t cbuf)
+ {
+	 //assert(cbuf);
+
+	 CBUF_STORE_RELEASE(cbuf->tail, cbuf->tail + 1);
+ }
+ #else
  static void advance_pointer(cbuf_handle_t cbuf)
  {
 	 //assert(cbuf);
@@ -57,6 +115,7 @@
 	 cbuf->full = false;
 	 cbuf->tail = (cbuf->tail + 1) % cbuf->max;
  }
+ #endif
 
  #pragma mark - APIs -
 
@@ -65,10 +124,42 @@
 	// assert(buffer && size);
 
 	 cbuf_handle_t cbuf = malloc(sizeof(circular_buf_t));
-	 //assert(cbuf);
+
+	 if(cbuf && !circular_buf_init_static(buffer, size, (circular_buf_static_t *)cbuf))
+	 {
+		 free(cbuf);
+		 cbuf = NULL;
+	 }
+
+	 return cbuf;
+ }
+
+ cbuf_handle_t circular_buf_init_static(uint8_t* buffer, size_t size, circular_buf_static_t * storage)
+ {
+	// assert(buffer && size && storage);
+ #if CIRCULAR_BUF_POW2
+	 if((size == 0) || ((size & (size - 1)) != 0))
+	 {
+		 return NULL;
+	 }
+ #else
+	 if(size == 0)
+	 {
+		 return NULL;
+	 }
+ #endif
+
+	 cbuf_handle_t cbuf = (cbuf_handle_t)storage;
 
 	 cbuf->buffer = buffer;
+ #if CIRCULAR_BUF_POW2
+	 cbuf->mask = size - 1;
+ #else
 	 cbuf->max = size;
+ #endif
+ #if CIRCULAR_BUF_SPSC
+	 cbuf->head = 0;
+ #endif
 	 circular_buf_reset(cbuf);
 
 	// assert(circular_buf_empty(cbuf));
@@ -86,15 +177,25 @@
  {
 	// assert(cbuf);
 
+ #if CIRCULAR_BUF_SPSC
+	 // Consumer-side flush, head belongs to the producer
+	 CBUF_STORE_RELEASE(cbuf->tail, CBUF_LOAD_ACQUIRE(cbuf->head));
+ #else
 	 cbuf->head = 0;
 	 cbuf->tail = 0;
+ #endif
+ #if !CIRCULAR_BUF_POW2
 	 cbuf->full = false;
+ #endif
  }
 
  size_t circular_buf_size(cbuf_handle_t cbuf)
  {
 	// assert(cbuf);
 
+ #if CIRCULAR_BUF_POW2
+	 return (CBUF_LOAD_ACQUIRE(cbuf->head) - CBUF_LOAD_ACQUIRE(cbuf->tail));
+ #else
 	 size_t size = cbuf->max;
 
 	 if(!cbuf->full)
@@ -111,22 +212,28 @@
 	 }
 
 	 return size;
+ #endif
  }
 
  size_t circular_buf_capacity(cbuf_handle_t cbuf)
  {
 	 //assert(cbuf);
 
-	 return cbuf->max;
+	 return CBUF_MAX(cbuf);
  }
 
  void circular_buf_put(cbuf_handle_t cbuf, uint8_t data)
  {
 	 //assert(cbuf && cbuf->buffer);
 
-	 cbuf->buffer[cbuf->head] = data;
+ #if CIRCULAR_BUF_SPSC
+	 // Overwriting would mean moving tail from the producer side
+	 (void)circular_buf_put2(cbuf, data);
+ #else
+	 cbuf->buffer[CBUF_INDEX(cbuf, cbuf->head)] = data;
 
 	 advance_pointer(cbuf);
+ #endif
  }
 
  int circular_buf_put2(cbuf_handle_t cbuf, uint8_t data)
@@ -137,7 +244,7 @@
 
 	 if(!circular_buf_full(cbuf))
 	 {
-		 cbuf->buffer[cbuf->head] = data;
+		 cbuf->buffer[CBUF_INDEX(cbuf, cbuf->head)] = data;
 		 advance_pointer(cbuf);
 		 r = 0;
 	 }
@@ -153,7 +260,7 @@
 
 	 if(!circular_buf_empty(cbuf))
 	 {
-		 *data = cbuf->buffer[cbuf->tail];
+		 *data = cbuf->buffer[CBUF_INDEX(cbuf, cbuf->tail)];
 		 retreat_pointer(cbuf);
 
 		 r = 0;
@@ -166,12 +273,203 @@
  {
 	 //assert(cbuf);
 
+ #if CIRCULAR_BUF_POW2
+	 return (CBUF_LOAD_ACQUIRE(cbuf->head) == CBUF_LOAD_ACQUIRE(cbuf->tail));
+ #else
 	 return (!cbuf->full && (cbuf->head == cbuf->tail));
+ #endif
  }
 
  bool circular_buf_full(cbuf_handle_t cbuf)
  {
 	// assert(cbuf);
 
+ #if CIRCULAR_BUF_POW2
+	 return (circular_buf_size(cbuf) == CBUF_MAX(cbuf));
+ #else
 	 return cbuf->full;
- }
\ No newline at end of file
+ #endif
+ }
+
+ size_t circular_buf_space(cbuf_handle_t cbuf)
+ {
+	// assert(cbuf);
+
+	 return CBUF_MAX(cbuf) - circular_buf_size(cbuf);
+ }
+
+ int circular_buf_put_range(cbuf_handle_t cbuf, const uint8_t * data, size_t len)
+ {
+	 //assert(cbuf && data && cbuf->buffer);
+
+	 if(len > circular_buf_space(cbuf))
+	 {
+		 return -1;
+	 }
+
+	 // At most two copies: up to the end of the array, then from the start
+	 while(len > 0)
+	 {
+		 uint8_t * span;
+		 size_t chunk = circular_buf_reserve(cbuf, &span);
+
+		 if(chunk > len)
+		 {
+			 chunk = len;
+		 }
+
+		 memcpy(span, data, chunk);
+		 circular_buf_commit(cbuf, chunk);
+		 data += chunk;
+		 len -= chunk;
+	 }
+
+	 return 0;
+ }
+
+ size_t circular_buf_get_range(cbuf_handle_t cbuf, uint8_t * data, size_t len)
+ {
+	 //assert(cbuf && data && cbuf->buffer);
+
+	 size_t copied = 0;
+
+	 while(copied < len)
+	 {
+		 uint8_t * span;
+		 size_t chunk = circular_buf_peek(cbuf, &span);
+
+		 if(chunk == 0)
+		 {
+			 break;
+		 }
+
+		 if(chunk > (len - copied))
+		 {
+			 chunk = len - copied;
+		 }
+
+		 memcpy(&data[copied], span, chunk);
+		 circular_buf_consume(cbuf, chunk);
+		 copied += chunk;
+	 }
+
+	 return copied;
+ }
+
+ size_t circular_buf_reserve(cbuf_handle_t cbuf, uint8_t ** span)
+ {
+	 //assert(cbuf && span && cbuf->buffer);
+
+	 size_t len;
+
+ #if CIRCULAR_BUF_POW2
+	 size_t index = CBUF_INDEX(cbuf, cbuf->head);
+
+	 len = circular_buf_space(cbuf);
+	 if(len > (CBUF_MAX(cbuf) - index))
+	 {
+		 len = CBUF_MAX(cbuf) - index;
+	 }
+
+	 *span = &cbuf->buffer[index];
+ #else
+	 if(cbuf->full)
+	 {
+		 len = 0;
+	 }
+	 else if(cbuf->head >= cbuf->tail)
+	 {
+		 // Free space runs to the end of the array (and wraps, but not contiguously)
+		 len = cbuf->max - cbuf->head;
+	 }
+	 else
+	 {
+		 len = cbuf->tail - cbuf->head;
+	 }
+
+	 *span = &cbuf->buffer[cbuf->head];
+ #endif
+
+	 return len;
+ }
+
+ void circular_buf_commit(cbuf_handle_t cbuf, size_t len)
+ {
+	 //assert(cbuf && len <= circular_buf_space(cbuf));
+
+	 if(len == 0)
+	 {
+		 return;
+	 }
+
+ #if CIRCULAR_BUF_POW2
+	 CBUF_STORE_RELEASE(cbuf->head, cbuf->head + len);
+ #else
+	 cbuf->head += len;
+	 if(cbuf->head >= cbuf->max)
+	 {
+		 cbuf->head -= cbuf->max;
+	 }
+
+	 cbuf->full = (cbuf->head == cbuf->tail);
+ #endif
+ }
+
+ size_t circular_buf_peek(cbuf_handle_t cbuf, uint8_t ** span)
+ {
+	 //assert(cbuf && span && cbuf->buffer);
+
+	 size_t len;
+
+ #if CIRCULAR_BUF_POW2
+	 size_t index = CBUF_INDEX(cbuf, cbuf->tail);
+
+	 len = circular_buf_size(cbuf);
+	 if(len > (CBUF_MAX(cbuf) - index))
+	 {
+		 len = CBUF_MAX(cbuf) - index;
+	 }
+
+	 *span = &cbuf->buffer[index];
+ #else
+	 if(circular_buf_empty(cbuf))
+	 {
+		 len = 0;
+	 }
+	 else if(cbuf->head > cbuf->tail)
+	 {
+		 len = cbuf->head - cbuf->tail;
+	 }
+	 else
+	 {
+		 // Stored data wraps (or the buffer is full): stop at the end of the array
+		 len = cbuf->max - cbuf->tail;
+	 }
+
+	 *span = &cbuf->buffer[cbuf->tail];
+ #endif
+
+	 return len;
+ }
+
+ void circular_buf_consume(cbuf_handle_t cbuf, size_t len)
+ {
+	 //assert(cbuf && len <= circular_buf_size(cbuf));
+
+	 if(len == 0)
+	 {
+		 return;
+	 }
+
+ #if CIRCULAR_BUF_POW2
+	 CBUF_STORE_RELEASE(cbuf->tail, cbuf->tail + len);
+ #else
+	 cbuf->tail += len;
+	 if(cbuf->tail >= cbuf->max)
+	 {
+		 cbuf->tail -= cbuf->max;
+	 }
+
+	 cbuf->full = false;
+ #endif
+ }
@@ -17,28 +17,68 @@
 #ifndef CIRCULAR_BUFFER_H_
 #define CIRCULAR_BUFFER_H_
 
+/// Set to 1 to require power-of-two buffer sizes, checked at init.
+/// Head and tail are then free-running counters wrapped with a per-buffer
+/// mask, the occupancy is their difference and there is no full flag, so no
+/// per-byte division is needed (the Cortex-M0+ has no hardware divider).
+/// Define as 0 to build the generic variant that accepts any size at init.
+#ifndef CIRCULAR_BUF_POW2
+#define CIRCULAR_BUF_POW2	1
+#endif
+
+/// Set to 1 to make every buffer lock-free for exactly one producer and one
+/// consumer, e.g. a SERCOM callback and a task. Only the producer side
+/// (put, put2, put_range, reserve, commit) writes head and only the consumer
+/// side (get, get_range, peek, consume, reset) writes tail, so neither side
+/// needs a critical section. Requires CIRCULAR_BUF_POW2.
+#ifndef CIRCULAR_BUF_SPSC
+#define CIRCULAR_BUF_SPSC	1
+#endif
+
 /// Opaque circular buffer structure
 typedef struct circular_buf_t circular_buf_t;
 
 /// Handle type, the way users interact with the API
 typedef circular_buf_t* cbuf_handle_t;
 
+/// Caller-provided storage for a control block, see circular_buf_init_static
+/// Same size as the hidden circular_buf_t, its members must not be accessed
+typedef struct
+{
+	void * dummy1;
+	size_t dummy2[3];
+#if !CIRCULAR_BUF_POW2
+	bool dummy3;
+#endif
+} circular_buf_static_t;
+
 /// Pass in a storage buffer and size, returns a circular buffer handle
-/// Requires: buffer is not NULL, size > 0
+/// Requires: buffer is not NULL, size > 0 (a power of two with CIRCULAR_BUF_POW2)
 /// Ensures: cbuf has been created and is returned in an empty state
+/// Returns NULL if size is not valid or malloc fails
 cbuf_handle_t circular_buf_init(uint8_t* buffer, size_t size);
 
+/// Same as circular_buf_init, but the control block is placed in storage
+/// instead of being allocated with malloc
+/// Requires: buffer and storage are not NULL and outlive the handle, size > 0
+/// (a power of two with CIRCULAR_BUF_POW2)
+/// Ensures: cbuf has been created and is returned in an empty state
+/// Returns NULL if size is not valid
+cbuf_handle_t circular_buf_init_static(uint8_t* buffer, size_t size, circular_buf_static_t * storage);
+
 /// Free a circular buffer structure
-/// Requires: cbuf is valid and created by circular_buf_init
+/// Requires: cbuf is valid and created by circular_buf_init (not _static)
 /// Does not free data buffer; owner is responsible for that
 void circular_buf_free(cbuf_handle_t cbuf);
 
 /// Reset the circular buffer to empty, head == tail. Data not cleared
+/// With CIRCULAR_BUF_SPSC this discards pending data from the consumer side
 /// Requires: cbuf is valid and created by circular_buf_init
 void circular_buf_reset(cbuf_handle_t cbuf);
 
 /// Put version 1 continues to add data if the buffer is full
 /// Old data is overwritten
+/// With CIRCULAR_BUF_SPSC the new data is dropped instead, like put2
 /// Requires: cbuf is valid and created by circular_buf_init
 void circular_buf_put(cbuf_handle_t cbuf, uint8_t data);
 
@@ -72,7 +112,40 @@ size_t circular_buf_capacity(cbuf_handle_t cbuf);
 /// Returns the current number of elements in the buffer
 size_t circular_buf_size(cbuf_handle_t cbuf);
 
-//TODO: int circular_buf_get_range(circular_buf_t cbuf, uint8_t *data, size_t len);
-//TODO: int circular_buf_put_range(circular_buf_t cbuf, uint8_t * data, size_t len);
+/// Check the number of free elements left in the buffer
+/// Requires: cbuf is valid and created by circular_buf_init
+/// Returns the number of elements that can be added without overwriting
+size_t circular_buf_space(cbuf_handle_t cbuf);
+
+/// Copy a block of data into the buffer, rejecting it if it does not fit
+/// Requires: cbuf is valid and created by circular_buf_init, data is not NULL
+/// Returns 0 on success, -1 if there is not enough free space for all len bytes
+int circular_buf_put_range(cbuf_handle_t cbuf, const uint8_t * data, size_t len);
+
+/// Copy up to len bytes out of the buffer
+/// Requires: cbuf is valid and created by circular_buf_init, data is not NULL
+/// Returns the number of bytes copied, 0 if the buffer is empty
+size_t circular_buf_get_range(cbuf_handle_t cbuf, uint8_t * data, size_t len);
+
+/// Reserve the largest contiguous free span starting at head
+/// The producer may write (memcpy/DMA) up to the returned length into *span,
+/// then publishes it with circular_buf_commit
+/// Requires: cbuf is valid and created by circular_buf_init, span is not NULL
+/// Returns the length of the span, 0 if the buffer is full
+size_t circular_buf_reserve(cbuf_handle_t cbuf, uint8_t ** span);
+
+/// Publish len bytes previously written into a reserved span
+/// Requires: len <= the length returned by the last circular_buf_reserve
+void circular_buf_commit(cbuf_handle_t cbuf, size_t len);
+
+/// Peek at the largest contiguous span of stored data starting at tail
+/// The data stays in the buffer until circular_buf_consume is called
+/// Requires: cbuf is valid and created by circular_buf_init, span is not NULL
+/// Returns the length of the span, 0 if the buffer is empty
+size_t circular_buf_peek(cbuf_handle_t cbuf, uint8_t ** span);
+
+/// Drop len bytes from the tail, typically after processing a peeked span
+/// Requires: len <= circular_buf_size(cbuf)
+void circular_buf_consume(cbuf_handle_t cbuf, size_t len);
 
 #endif //CIRCULAR_BUFFER_H_
\ No newline at end of file
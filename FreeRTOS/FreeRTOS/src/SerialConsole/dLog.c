@@ -0,0 +1,273 @@
+/**************************************************************************//**
+* @file      dLog.c
+* @brief     Deferred-formatting binary logger
+* @author    Adi
+* @date      2024-1-6
+
+******************************************************************************/
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <asf.h>
+#include "dLog.h"
+/******************************************************************************
+* Defines
+******************************************************************************/
+#define LOG_BUFFER_SIZE			512  // Size of the record ring, in bytes
+#define LOG_TEXT_SIZE			64   // Longest message once expanded to text
+#define LOG_RECORD_SIZE			(1 + (DLOG_MAX_ARGS * sizeof(int32_t)))  // Format-ID plus arguments
+
+#if CIRCULAR_BUF_POW2 && ((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) != 0)
+#error LOG_BUFFER_SIZE must be a power of two
+#endif
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+static uint8_t logBuffer[LOG_BUFFER_SIZE];  ///< Storage of pending records
+static circular_buf_static_t cbufLogStorage;  ///< Control block of cbufLog
+static cbuf_handle_t cbufLog;  ///< Records written by tasks and ISRs, read by dLog_Flush
+static volatile uint32_t logDroppedCount;  ///< Records discarded because cbufLog was full
+
+#define DLOG_ARGC(id, argc, format)		argc,
+static const uint8_t logArgCount[DLOG_MESSAGE_COUNT] = { DLOG_MESSAGES(DLOG_ARGC) };  ///< Arguments stored per format-ID
+#undef DLOG_ARGC
+
+#if (DLOG_BINARY_OUTPUT == 0)
+#define DLOG_FORMAT(id, argc, format)	format,
+static const char * const logFormat[DLOG_MESSAGE_COUNT] = { DLOG_MESSAGES(DLOG_FORMAT) };  ///< Format string per format-ID
+#undef DLOG_FORMAT
+
+static char logText[LOG_TEXT_SIZE];  ///< Expanded text of the record being flushed
+#endif
+
+/******************************************************************************
+* Forward Declarations
+******************************************************************************/
+static void dLog_Record(dLog_Id id, int32_t arg0, int32_t arg1);
+#if (DLOG_BINARY_OUTPUT == 0)
+static size_t dLog_Format(char *out, size_t size, const char *format, const int32_t *args);
+#endif
+
+/******************************************************************************
+* Static Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		static void dLog_Record(dLog_Id id, int32_t arg0, int32_t arg1)
+* @brief	Stores a record in cbufLog
+* @details 	A record is the format-ID followed by only as many raw
+*			arguments as the message uses. It is stored in full or dropped
+*			and counted, never split.
+* @param[in]	id - Message format-ID
+*				arg0, arg1 - Raw arguments
+* @param[out]	N/A
+* @return		N/A
+* @note         Must be called with interrupts masked
+*****************************************************************************/
+static void dLog_Record(dLog_Id id, int32_t arg0, int32_t arg1)
+{
+    uint8_t record[LOG_RECORD_SIZE];
+    size_t length = 1 + (logArgCount[id] * sizeof(int32_t));
+
+    record[0] = (uint8_t)id;
+    memcpy(&record[1], &arg0, sizeof(int32_t));
+    memcpy(&record[1 + sizeof(int32_t)], &arg1, sizeof(int32_t));
+
+    if (circular_buf_put_range(cbufLog, record, length) != 0) {
+        logDroppedCount++;
+    }
+}
+
+#if (DLOG_BINARY_OUTPUT == 0)
+/**************************************************************************//**
+* @fn		static size_t dLog_Format(char *out, size_t size, const char *format, const int32_t *args)
+* @brief	Minimal integer-only formatter, replaces newlib's vfprintf
+* @param[in]	size - Size of out, including the terminator
+*				format - Format string, supports %d, %u, %x, %c and %%
+*				args - Raw arguments of the record
+* @param[out]	out - Expanded, NUL terminated text
+* @return		Length of the text
+* @note
+*****************************************************************************/
+static size_t dLog_Format(char *out, size_t size, const char *format, const int32_t *args)
+{
+    size_t length = 0;
+    uint8_t arg = 0;
+
+    while ((*format != '\0') && (length < (size - 1))) {
+        if (*format != '%') {
+            out[length++] = *format++;
+            continue;
+        }
+
+        format++;
+        if ((*format != '%') && (*format != '\0') && (arg >= DLOG_MAX_ARGS)) {
+            break;
+        }
+
+        switch (*format) {
+            case '%':
+                out[length++] = '%';
+                break;
+
+            case 'c':
+                out[length++] = (char)args[arg++];
+                break;
+
+            case 'd':
+            case 'u':
+            case 'x': {
+                char digits[10];
+                uint8_t count = 0;
+                uint32_t base = (*format == 'x') ? 16 : 10;
+                uint32_t value = (uint32_t)args[arg];
+
+                if ((*format == 'd') && (args[arg] < 0)) {
+                    out[length++] = '-';
+                    value = 0u - value;
+                }
+                arg++;
+
+                do {
+                    digits[count++] = "0123456789abcdef"[value % base];
+                    value /= base;
+                } while (value != 0);
+
+                while ((count > 0) && (length < (size - 1))) {
+                    out[length++] = digits[--count];
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (*format != '\0') {
+            format++;
+        }
+    }
+
+    out[length] = '\0';
+    return length;
+}
+#endif
+
+/******************************************************************************
+* Global Functions
+******************************************************************************/
+/**************************************************************************//**
+* @fn		void dLog_Initialize(void)
+* @brief	Initializes the record buffer
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Call once before the first dLog_Write
+*****************************************************************************/
+void dLog_Initialize(void)
+{
+    cbufLog = circular_buf_init_static(logBuffer, LOG_BUFFER_SIZE, &cbufLogStorage);
+}
+
+/**************************************************************************//**
+* @fn		void dLog_Write(dLog_Id id, int32_t arg0, int32_t arg1)
+* @brief	Logs a message without formatting it
+* @details 	Only the format-ID and the raw arguments are copied, which
+*			costs a few dozen cycles instead of a snprintf call. The text
+*			is produced later by dLog_Flush, or on the PC.
+* @param[in]	id - Message from DLOG_MESSAGES
+*				arg0, arg1 - Arguments, unused ones are ignored
+* @param[out]	N/A
+* @return		N/A
+* @note         Task context only, use dLog_WriteFromISR in interrupts
+*****************************************************************************/
+void dLog_Write(dLog_Id id, int32_t arg0, int32_t arg1)
+{
+    taskENTER_CRITICAL();
+    dLog_Record(id, arg0, arg1);
+    taskEXIT_CRITICAL();
+}
+
+/**************************************************************************//**
+* @fn		void dLog_WriteFromISR(dLog_Id id, int32_t arg0, int32_t arg1)
+* @brief	Interrupt-safe version of dLog_Write
+* @param[in]	id - Message from DLOG_MESSAGES
+*				arg0, arg1 - Arguments, unused ones are ignored
+* @param[out]	N/A
+* @return		N/A
+* @note
+*****************************************************************************/
+void dLog_WriteFromISR(dLog_Id id, int32_t arg0, int32_t arg1)
+{
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    dLog_Record(id, arg0, arg1);
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**************************************************************************//**
+* @fn		void dLog_Flush(void)
+* @brief	Moves pending records to the UART
+* @details 	Each record is sent as a binary frame (DLOG_FRAME_SYNC,
+*			format-ID, little-endian arguments) or expanded to text,
+*			depending on DLOG_BINARY_OUTPUT. Records stay queued while the
+*			TX buffer has no room for them.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Single consumer, called from the idle hook. Never blocks.
+*****************************************************************************/
+void dLog_Flush(void)
+{
+    uint8_t *span;
+    uint8_t frame[1 + LOG_RECORD_SIZE];
+
+    while (circular_buf_peek(cbufLog, &span) > 0) {
+        dLog_Id id = (dLog_Id)span[0];
+        size_t length;
+
+        if (id >= DLOG_MESSAGE_COUNT) {
+            // Cannot happen unless the ring got corrupted, resynchronize
+            circular_buf_reset(cbufLog);
+            break;
+        }
+        length = 1 + (logArgCount[id] * sizeof(int32_t));
+
+#if DLOG_BINARY_OUTPUT
+        // Leave the record queued until the whole frame fits in the TX buffer
+        if (dUART_GetTxSpace() < (length + 1)) {
+            break;
+        }
+
+        frame[0] = DLOG_FRAME_SYNC;
+        circular_buf_get_range(cbufLog, &frame[1], length);
+        dUART_WriteBuffer(frame, length + 1);
+#else
+        int32_t args[DLOG_MAX_ARGS] = {0};
+
+        // Leave the record queued until the longest possible text fits in the TX buffer
+        if (dUART_GetTxSpace() < LOG_TEXT_SIZE) {
+            break;
+        }
+
+        // The arguments may wrap around the end of the ring, copy the record out first
+        circular_buf_get_range(cbufLog, frame, length);
+        memcpy(args, &frame[1], length - 1);
+        dLog_Format(logText, LOG_TEXT_SIZE, logFormat[id], args);
+        dUART_WriteString(logText);
+#endif
+    }
+}
+
+/**************************************************************************//**
+* @fn		uint32_t dLog_GetDroppedCount(void)
+* @brief	Number of records dropped because the record buffer was full
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		Dropped record count since initialization
+* @note
+*****************************************************************************/
+uint32_t dLog_GetDroppedCount(void)
+{
+    return logDroppedCount;
+}
@@ -0,0 +1,52 @@
+/**************************************************************************//**
+* @file      dLog.h
+* @brief     Deferred-formatting binary logger
+* @author    Adi
+* @date      2024-1-6
+
+******************************************************************************/
+#ifndef DLOG_H_
+#define DLOG_H_
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include "dUART.h"
+/******************************************************************************
+* Defines
+******************************************************************************/
+/// 1: records leave the board as binary frames, to be turned back into text
+///    on the PC with tools/dlog_decode.py
+/// 0: records are expanded to text on the board, from the idle task
+#define DLOG_BINARY_OUTPUT		0
+
+#define DLOG_MAX_ARGS			2		///< Maximum number of arguments per message
+#define DLOG_FRAME_SYNC			0xA5	///< First byte of a binary frame, never part of ASCII console text
+
+/// Log message table: X(id, number of arguments, format)
+/// Formats support %d, %u, %x, %c and %%. New messages are only appended,
+/// the position in this list is the format-ID sent in binary frames.
+#define DLOG_MESSAGES(X) \
+	X(DLOG_LED_BLINK,		1,	"LED Blink at - %d ms\r\n") \
+	X(DLOG_CLI_DELAY,		1,	"Delay - %d\r\n")
+
+/******************************************************************************
+* Variables
+******************************************************************************/
+#define DLOG_ENUM(id, argc, format)		id,
+typedef enum {
+	DLOG_MESSAGES(DLOG_ENUM)
+	DLOG_MESSAGE_COUNT
+} dLog_Id;
+#undef DLOG_ENUM
+
+/******************************************************************************
+* Function Prototypes
+******************************************************************************/
+void dLog_Initialize(void);
+void dLog_Write(dLog_Id id, int32_t arg0, int32_t arg1);
+void dLog_WriteFromISR(dLog_Id id, int32_t arg0, int32_t arg1);
+void dLog_Flush(void);
+uint32_t dLog_GetDroppedCount(void);
+
+#endif /* DLOG_H_ */
@@ -18,6 +18,12 @@
 #define RX_BUFFER_SIZE			512  // Size of character buffer for RX, in bytes
 #define TX_BUFFER_SIZE			512  // Size of character buffers for TX, in bytes
 #define MAX_INPUT_LENGTH_CLI    20	 //   Max CLI input size
+#define RX_CHUNK_SIZE			64	 // Max bytes per USART read job, delivered to the task as one chunk
+#define RX_IDLE_TIMEOUT_MS		5	 // A partial chunk is delivered after this long without a new character
+
+#if CIRCULAR_BUF_POW2 && (((RX_BUFFER_SIZE & (RX_BUFFER_SIZE - 1)) != 0) || ((TX_BUFFER_SIZE & (TX_BUFFER_SIZE - 1)) != 0))
+#error RX/TX buffer sizes must be powers of two
+#endif
 
 /******************************************************************************
 * Variables
@@ -28,16 +34,26 @@ char txCharacterBuffer[TX_BUFFER_SIZE];                 ///< Buffer to store cha
 
 cbuf_handle_t cbufRx;  ///< Circular buffer handler for receiving characters from the Serial Interface
 cbuf_handle_t cbufTx;  ///< Circular buffer handler for transmitting characters from the Serial Interface
+static circular_buf_static_t cbufRxStorage;  ///< Control block of cbufRx, no heap allocation
+static circular_buf_static_t cbufTxStorage;  ///< Control block of cbufTx, no heap allocation
 
-char latestRx;  ///< Holds the latest character that was received
-char latestTx;  ///< Holds the latest character to be transmitted.
+static volatile uint16_t rxJobLength;  ///< Size of the read job landing in cbufRx, 0 when RX is not armed
+static uint16_t rxIdleCount;  ///< Bytes of the current read job seen at the previous idle check
+static TimerHandle_t rxIdleTimer;  ///< One-shot inter-character timeout, runs only while a read job holds partial data
+static volatile uint16_t txJobLength;  ///< Bytes of cbufTx currently handed to the SERCOM, 0 when TX is idle
+static volatile uint32_t txDroppedCount;  ///< Messages discarded because cbufTx had no room for them
 
-QueueHandle_t MsgQueue;
+static TaskHandle_t consoleTask;  ///< dUART_Task, notified whenever a chunk has been received
 /******************************************************************************
 * Forward Declarations
 ******************************************************************************/
 static void dUART_Configure(void);
 static void dUART_ConfigureCallbacks(void);
+static void dUART_StartTransmit(void);
+static void dUART_QueueBuffer(const uint8_t *data, size_t length);
+static void dUART_StartReceive(void);
+static void dUART_DeliverReceived(uint16_t length, BaseType_t *pxHigherPriorityTaskWoken);
+static void dUART_RxIdleCallback(TimerHandle_t xTimer);
 
 /******************************************************************************
 * Callback Functions
@@ -46,6 +62,8 @@ static void dUART_ConfigureCallbacks(void);
 void dUART_WriteCallback(struct usart_module *const usart_module);
 // Callback for when we finis reading characters from UART
 void dUART_ReadCallback(struct usart_module *const usart_module);
+// Callback for the first character of a UART read job
+void dUART_RxStartCallback(struct usart_module *const usart_module);
 
 /******************************************************************************
 * Static Functions
@@ -72,6 +90,7 @@ static void dUART_Configure(void)
     config_usart.pinmux_pad1 = EDBG_CDC_SERCOM_PINMUX_PAD1;
     config_usart.pinmux_pad2 = EDBG_CDC_SERCOM_PINMUX_PAD2;
     config_usart.pinmux_pad3 = EDBG_CDC_SERCOM_PINMUX_PAD3;
+    config_usart.start_frame_detection_enable = true;  // Reports the first character of each read job
     while (usart_init(&usart_instance, EDBG_CDC_MODULE, &config_usart) != STATUS_OK) {
     }
 
@@ -90,8 +109,160 @@ static void dUART_ConfigureCallbacks(void)
 {
     usart_register_callback(&usart_instance, dUART_WriteCallback, USART_CALLBACK_BUFFER_TRANSMITTED);
     usart_register_callback(&usart_instance, dUART_ReadCallback, USART_CALLBACK_BUFFER_RECEIVED);
+    usart_register_callback(&usart_instance, dUART_RxStartCallback, USART_CALLBACK_START_RECEIVED);
     usart_enable_callback(&usart_instance, USART_CALLBACK_BUFFER_TRANSMITTED);
     usart_enable_callback(&usart_instance, USART_CALLBACK_BUFFER_RECEIVED);
+    usart_enable_callback(&usart_instance, USART_CALLBACK_START_RECEIVED);
+}
+
+/**************************************************************************//**
+* @fn		static void dUART_StartTransmit(void)
+* @brief	Hands the next contiguous span of cbufTx to the SERCOM
+* @details 	The span is transmitted in place straight from txCharacterBuffer
+*			and only consumed from the ring once the job completes, so a
+*			whole log line costs one write job and one callback instead
+*			of one per character.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Must be called with interrupts masked, or from the TX callback
+*****************************************************************************/
+static void dUART_StartTransmit(void)
+{
+    uint8_t *span;
+    size_t length = circular_buf_peek(cbufTx, &span);
+
+    if (length > UINT16_MAX) {
+        length = UINT16_MAX;
+    }
+
+    if (length > 0) {
+        txJobLength = (uint16_t)length;
+        usart_write_buffer_job(&usart_instance, span, (uint16_t)length);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void dUART_QueueBuffer(const uint8_t *data, size_t length)
+* @brief	Copies a whole message into cbufTx and starts TX if it is idle
+* @details 	The message is either stored in full or dropped and counted in
+*			txDroppedCount, so a full buffer never corrupts queued text
+*			and two callers' messages never interleave.
+* @param[in]	data - Message to be written
+*				length - Size of the message in bytes
+* @param[out]	N/A
+* @return		N/A
+* @note         Must be called with interrupts masked
+*****************************************************************************/
+static void dUART_QueueBuffer(const uint8_t *data, size_t length)
+{
+    if (circular_buf_put_range(cbufTx, data, length) != 0) {
+        txDroppedCount++;
+    } else if (txJobLength == 0) {
+        // Kick off a transfer only if the SERCOM TX is idle, otherwise the callback chains it
+        dUART_StartTransmit();
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void dUART_StartReceive(void)
+* @brief	Arms a read job straight into the free space of cbufRx
+* @details 	The job covers up to RX_CHUNK_SIZE bytes of the contiguous span
+*			at the head of the ring, so received characters land in place
+*			and are published with circular_buf_commit once the chunk is
+*			complete or the line goes idle. If the ring is full, RX stays
+*			unarmed until dUART_Task has drained it.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note         Must be called with interrupts masked, or from the RX callback
+*****************************************************************************/
+static void dUART_StartReceive(void)
+{
+    uint8_t *span;
+    size_t length = circular_buf_reserve(cbufRx, &span);
+
+    if (length > RX_CHUNK_SIZE) {
+        length = RX_CHUNK_SIZE;
+    }
+
+    rxJobLength = (uint16_t)length;
+    rxIdleCount = 0;
+    if (length > 0) {
+        usart_read_buffer_job(&usart_instance, span, (uint16_t)length);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void dUART_DeliverReceived(uint16_t length, BaseType_t *pxHigherPriorityTaskWoken)
+* @brief	Publishes received bytes to cbufRx and wakes the console task
+* @details	The data itself travels through cbufRx, the task only needs a
+*			direct-to-task notification to wake up. Notifications are
+*			counted, so unlike the former MsgQueue they cannot overflow.
+* @param[in]	length - Number of bytes of the read job that have arrived
+* @param[out]	pxHigherPriorityTaskWoken - Set if the task should run next
+* @return		N/A
+* @note         Must be called with interrupts masked, or from the RX callback
+*****************************************************************************/
+static void dUART_DeliverReceived(uint16_t length, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    circular_buf_commit(cbufRx, length);
+
+    // Before the scheduler runs the task has no handle yet, it drains the ring when it starts
+    if (consoleTask != NULL) {
+        vTaskNotifyGiveFromISR(consoleTask, pxHigherPriorityTaskWoken);
+    }
+}
+
+/**************************************************************************//**
+* @fn		static void dUART_RxIdleCallback(TimerHandle_t xTimer)
+* @brief	Inter-character timeout for the receive path
+* @details 	The SERCOM has no idle-line detection, so once the first
+*			character of a read job has arrived the number of bytes in the
+*			job is compared every RX_IDLE_TIMEOUT_MS with the previous
+*			check. If none have arrived since, the job is cut short and
+*			the partial chunk is delivered, so typed characters are echoed
+*			without waiting for a full chunk. Otherwise the one-shot timer
+*			is armed again, so it does not run while the line is idle.
+* @param[in]	xTimer - rxIdleTimer
+* @param[out]	N/A
+* @return		N/A
+* @note         Runs in the timer service task. The job is checked, cut and
+*				restarted in one critical section, the task is notified and
+*				the timer armed after it, as both post to kernel queues.
+*****************************************************************************/
+static void dUART_RxIdleCallback(TimerHandle_t xTimer)
+{
+    bool delivered = false;
+    bool rearm = false;
+
+    taskENTER_CRITICAL();
+    // With RX stalled on a full ring dUART_Task restarts it, nothing to check
+    if (rxJobLength != 0) {
+        uint16_t received = rxJobLength - usart_instance.remaining_rx_buffer_length;
+
+        if (received == rxIdleCount) {
+            // Also restarts a job whose start condition brought no character,
+            // the new job reports its first character again
+            usart_abort_job(&usart_instance, USART_TRANSCEIVER_RX);
+            if (received > 0) {
+                circular_buf_commit(cbufRx, received);
+                delivered = true;
+            }
+            dUART_StartReceive();
+        } else {
+            rxIdleCount = received;
+            rearm = true;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (delivered && (consoleTask != NULL)) {
+        xTaskNotifyGive(consoleTask);
+    }
+    if (rearm) {
+        xTimerReset(xTimer, 0);
+    }
 }
 
 /******************************************************************************
@@ -99,30 +270,40 @@ static void dUART_ConfigureCallbacks(void)
 ******************************************************************************/
 char Command[MAX_INPUT_LENGTH_CLI];
 void dUART_Task(void * parameter) {
-	int value, delay;
-	char str[MAX_INPUT_LENGTH_CLI];
+	uint8_t rxChar;
+	size_t cmdLength = 0;
+	char str[2];
+
+	consoleTask = xTaskGetCurrentTaskHandle();
 	while(1) {
 		
-		if(xQueueReceive(MsgQueue, (void*)&value, 0) == pdTRUE) {
-			if((uint8_t)latestRx == '\r') {
+		// Each chunk holds any number of characters, possibly several lines of pasted input
+		while(circular_buf_get(cbufRx, &rxChar) == 0) {
+			if(rxChar == '\r') {
 				dUART_WriteString((char *)"\r\n");
-				snprintf(Command, MAX_INPUT_LENGTH_CLI - 1, rxCharacterBuffer);
-				delay = CLI_ExtractCmd(Command, MAX_INPUT_LENGTH_CLI);
-				vTaskDelay(1000 / portTICK_PERIOD_MS);
-				circular_buf_reset(cbufRx);
-				memset(Command, 0x00, MAX_INPUT_LENGTH_CLI);
-				if(xQueueSend(LEDQueue, (const void* )&delay, pdFALSE) != pdTRUE) {
-					dUART_WriteString("LED Queue Full!!\r\n");
-				}
+				Command[cmdLength] = '\0';
+				cmdLength = 0;
+				CLI_ExtractCmd(Command, MAX_INPUT_LENGTH_CLI);
 			} else {
-				// char str[2];
-				snprintf(str, sizeof(str), "%c", latestRx);
+				if(cmdLength < (MAX_INPUT_LENGTH_CLI - 1)) {
+					Command[cmdLength++] = (char)rxChar;
+				}
+				str[0] = (char)rxChar;
+				str[1] = '\0';
 				dUART_WriteString(str);
 			}
-		} else {
-			
 		}
-		
+
+		// A full ring left RX unarmed, restart it now that there is room
+		taskENTER_CRITICAL();
+		if (rxJobLength == 0) {
+			dUART_StartReceive();
+		}
+		taskEXIT_CRITICAL();
+
+		// Sleep until the receive path delivers the next chunk. A chunk that
+		// arrives while draining leaves the notification pending, so none is missed.
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 	}
 }
 
@@ -132,25 +313,92 @@ void dUART_Task(void * parameter) {
 *				string to a ring buffer that is used to hold the
 *				text send to the uart
 * @details		Uses the ringbuffer 'cbufTx', which in turn uses the array
-*				'txCharacterBuffer'. Modified to be thread safe.
+*				'txCharacterBuffer'. Thread safe and non-blocking: the
+*				whole string is reserved atomically, so messages from
+*				different tasks never interleave, and a string that does
+*				not fit is dropped and counted (see dUART_GetDroppedCount).
 * @param[in]	Pointer to string to be written
 * @return		N/A
-* @note			N/A
+* @note			Task context only, use dUART_WriteStringFromISR in interrupts
 *****************************************************************************/
 void dUART_WriteString(const char *string)
 {
     if (string != NULL) {
-        for (size_t iter = 0; iter < strlen(string); iter++) {
-            circular_buf_put(cbufTx, string[iter]);
-        }
+        taskENTER_CRITICAL();
+        dUART_QueueBuffer((const uint8_t *)string, strlen(string));
+        taskEXIT_CRITICAL();
+    }
+}
 
-        if (usart_get_job_status(&usart_instance, USART_TRANSCEIVER_TX) == STATUS_OK) {
-            circular_buf_get(cbufTx, (uint8_t *)&latestTx);  // Perform only if the SERCOM TX is free (not busy)
-            usart_write_buffer_job(&usart_instance, (uint8_t *)&latestTx, 1);
-        }
+/**************************************************************************//**
+* @fn		void dUART_WriteStringFromISR(const char * string)
+* @brief		Interrupt-safe version of dUART_WriteString
+* @param[in]	Pointer to string to be written
+* @return		N/A
+* @note			N/A
+*****************************************************************************/
+void dUART_WriteStringFromISR(const char *string)
+{
+    if (string != NULL) {
+        UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+        dUART_QueueBuffer((const uint8_t *)string, strlen(string));
+        taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+    }
+}
+
+/**************************************************************************//**
+* @fn		void dUART_WriteBuffer(const uint8_t *data, size_t length)
+* @brief		Same as dUART_WriteString for binary data that may contain 0x00
+* @param[in]	data - Bytes to be written
+*				length - Number of bytes
+* @return		N/A
+* @note			Task context only
+*****************************************************************************/
+void dUART_WriteBuffer(const uint8_t *data, size_t length)
+{
+    if ((data != NULL) && (length > 0)) {
+        taskENTER_CRITICAL();
+        dUART_QueueBuffer(data, length);
+        taskEXIT_CRITICAL();
     }
 }
 
+/**************************************************************************//**
+* @fn		size_t dUART_GetTxSpace(void)
+* @brief		Free space left in the TX buffer
+* @param[in]	N/A
+* @return		Number of bytes a message may have to be accepted right now
+* @note			Other writers may use the space before the caller does
+*****************************************************************************/
+size_t dUART_GetTxSpace(void)
+{
+    return circular_buf_space(cbufTx);
+}
+
+/**************************************************************************//**
+* @fn		bool dUART_IsTxEmpty(void)
+* @brief		Checks whether everything written so far has been sent
+* @param[in]	N/A
+* @return		true once the TX buffer is empty and no transfer is running
+* @note			Spans are only released when their write job completes
+*****************************************************************************/
+bool dUART_IsTxEmpty(void)
+{
+    return circular_buf_empty(cbufTx);
+}
+
+/**************************************************************************//**
+* @fn		uint32_t dUART_GetDroppedCount(void)
+* @brief		Number of messages dropped because the TX buffer was full
+* @param[in]	N/A
+* @return		Dropped message count since initialization
+* @note			N/A
+*****************************************************************************/
+uint32_t dUART_GetDroppedCount(void)
+{
+    return txDroppedCount;
+}
+
 /**************************************************************************//**
 * @fn		int dUART_ReadCharacter(uint8_t *rxChar)
 * @brief		Reads a character from the RX ring buffer and stores it on
@@ -184,17 +432,17 @@ int dUART_ReadCharacter(uint8_t *rxChar)
 void dUART_Initialize(void)
 {
     // Initialize circular buffers for RX and TX
-    cbufRx = circular_buf_init((uint8_t *)rxCharacterBuffer, RX_BUFFER_SIZE);
-    cbufTx = circular_buf_init((uint8_t *)txCharacterBuffer, RX_BUFFER_SIZE);
-	
-	// Initialize Queue
-	MsgQueue = xQueueCreate(QUEUE_LENGTH, sizeof(char));
+    cbufRx = circular_buf_init_static((uint8_t *)rxCharacterBuffer, RX_BUFFER_SIZE, &cbufRxStorage);
+    cbufTx = circular_buf_init_static((uint8_t *)txCharacterBuffer, TX_BUFFER_SIZE, &cbufTxStorage);
 
     // Configure USART and Callbacks
     dUART_Configure();
     dUART_ConfigureCallbacks();
 
-    usart_read_buffer_job(&usart_instance, (uint8_t *)&latestRx, 1);  // Kicks off constant reading of characters
+    // Delivers partial chunks once the line goes idle, armed by dUART_RxStartCallback
+    rxIdleTimer = xTimerCreate("UART Rx", pdMS_TO_TICKS(RX_IDLE_TIMEOUT_MS), pdFALSE, NULL, dUART_RxIdleCallback);
+
+    dUART_StartReceive();  // Kicks off constant reading of characters
 }
 
 /**************************************************************************//**
@@ -214,6 +462,8 @@ void dUART_Deinitialize(void)
 * @fn		void dUART_ReadCallback(struct usart_module *const usart_module)
 * @brief	Callback called when the system finishes receives all the bytes 
 *			requested from a UART read job
+* @details	The whole chunk already sits in cbufRx, it only has to be
+*			committed. Partial chunks are handled by dUART_RxIdleCallback.
 * @param[in]	N/A
 * @param[out]	N/A
 * @return		N/A
@@ -221,15 +471,34 @@ void dUART_Deinitialize(void)
 *****************************************************************************/
 void dUART_ReadCallback(struct usart_module *const usart_module)
 {
-    // Add the latest read character into the RX circular Buffer
-	circular_buf_put(cbufRx, (uint8_t)latestRx);
-	
-	if(xQueueSendFromISR(MsgQueue, (const void* )&latestRx, pdFALSE) != pdTRUE) {
-		dUART_WriteString("Queue Full!!\r\n");
-	}
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	dUART_DeliverReceived(rxJobLength, &xHigherPriorityTaskWoken);
 
 	// Order the MCU to keep reading
-	usart_read_buffer_job(&usart_instance, (uint8_t *)&latestRx, 1);  
+	dUART_StartReceive();
+
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**************************************************************************//**
+* @fn		void dUART_RxStartCallback(struct usart_module *const usart_module)
+* @brief	Callback called when the first character of a UART read job
+*			starts arriving
+* @details	The SERCOM reports one start condition per read job, so the
+*			inter-character timeout is armed only once the job holds data.
+* @param[in]	N/A
+* @param[out]	N/A
+* @return		N/A
+* @note
+*****************************************************************************/
+void dUART_RxStartCallback(struct usart_module *const usart_module)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	xTimerResetFromISR(rxIdleTimer, &xHigherPriorityTaskWoken);
+
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 /**************************************************************************//**
@@ -243,9 +512,8 @@ void dUART_ReadCallback(struct usart_module *const usart_module)
 *****************************************************************************/
 void dUART_WriteCallback(struct usart_module *const usart_module)
 {
-    // Only continue if there are more characters to send
-	if (circular_buf_get(cbufTx, (uint8_t *)&latestTx) != -1)  
-    {
-        usart_write_buffer_job(&usart_instance, (uint8_t *)&latestTx, 1);
-    }
+    // Release the span that was just sent, then chain the next one if there is more to send
+    circular_buf_consume(cbufTx, txJobLength);
+    txJobLength = 0;
+    dUART_StartTransmit();
 }
\ No newline at end of file
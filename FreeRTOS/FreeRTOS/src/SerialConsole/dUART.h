@@ -27,6 +27,11 @@
 ******************************************************************************/
 void dUART_Task(void * parameter);
 void dUART_WriteString(const char *string);
+void dUART_WriteStringFromISR(const char *string);
+void dUART_WriteBuffer(const uint8_t *data, size_t length);
+size_t dUART_GetTxSpace(void);
+bool dUART_IsTxEmpty(void);
+uint32_t dUART_GetDroppedCount(void);
 int dUART_ReadCharacter(uint8_t *rxChar);
 void dUART_Initialize(void);
 void dUART_Deinitialize(void);
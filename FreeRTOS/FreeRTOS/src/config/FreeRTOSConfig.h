@@ -42,15 +42,21 @@
 #include <gclk.h>
 #include <stdint.h>
 void assert_triggered(const char *file, uint32_t line);
+void kLatency_Record(const void *caller, uint32_t duration);
+void kTop_ConfigureTimer(void);
+uint32_t kTop_GetCounter(void);
 #endif
 
 #define configUSE_PREEMPTION 1
-#define configUSE_IDLE_HOOK 0
+#define configUSE_IDLE_HOOK 1
 #define configUSE_TICK_HOOK 0
+#define configUSE_TICKLESS_IDLE 0  // RTC tickless idle, see vPortSuppressTicksAndSleep. Not yet verified on the board
+#define configUSE_DELAYED_TASK_WHEEL 0  // Delayed tasks hashed on their wake time, see tasks.c
 #define configPRIO_BITS 2
 #define configCPU_CLOCK_HZ (system_gclk_gen_get_hz(GCLK_GENERATOR_0))
 #define configTICK_RATE_HZ ((portTickType)1000)
 #define configMAX_PRIORITIES (5)
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1  // Ready priorities kept in a bit map, see portmacro.h
 #define configMINIMAL_STACK_SIZE ((unsigned short)100)
 /* configTOTAL_HEAP_SIZE is not used when heap_3.c is used. */
 #define configTOTAL_HEAP_SIZE ((size_t)(12000))
@@ -65,7 +71,11 @@ void assert_triggered(const char *file, uint32_t line);
 #define configUSE_MALLOC_FAILED_HOOK 1
 #define configUSE_COUNTING_SEMAPHORES 1
 #define configUSE_QUEUE_SETS 1
-#define configGENERATE_RUN_TIME_STATS 0
+#define configUSE_QUEUE_LOANS 0  // Zero-copy send and receive of large queue items, see queue.h. Off, slower than copying on the host
+#define configUSE_CONCURRENT_STREAM_BUFFERS 1  // Stream and message buffers with several writers and readers, see stream_buffer.h
+#define configGENERATE_RUN_TIME_STATS 1  // Per task CPU time for the top command, see kTop.c
+#define configUSE_CRITICAL_SECTION_STATS 0  // Time every critical section per call site, see kLatency.c
+#define configUSE_TRACE_RECORDER 0  // Stream kernel events to the PC, see kTrace.c
 #define configENABLE_BACKWARD_COMPATIBILITY 1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK 1  // Ported from FreeRToS 9.0.0
 
@@ -110,6 +120,16 @@ standard names - or at least those used in the unmodified vector table. */
 #define vPortSVCHandler SVC_Handler
 #define xPortPendSVHandler PendSV_Handler
 #define xPortSysTickHandler SysTick_Handler
+#define xPortRtcTickHandler RTC_Handler
+
+#define configRECORD_CRITICAL_SECTION(caller, duration) kLatency_Record(caller, duration)
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() kTop_ConfigureTimer()
+#define portGET_RUN_TIME_COUNTER_VALUE() kTop_GetCounter()
 
 #define configCOMMAND_INT_MAX_OUTPUT_SIZE 32
+
+/* Trace hook macros of the recorder, they need the definitions above. */
+#if (configUSE_TRACE_RECORDER == 1)
+#include "Benchmark/kTrace.h"
+#endif
 #endif /* FREERTOS_CONFIG_H */
@@ -13,6 +13,9 @@
 #include "main.h"
 #include "FreeRTOS.h"
 #include "SerialConsole/dUART.h"
+#include "SerialConsole/dLog.h"
+#include "Benchmark/kBench.h"
+#include "Benchmark/kTrace.h"
 
 /******************************************************************************
 * Forward Declarations
@@ -53,9 +56,7 @@ void LED_Task(void * parameter) {
 	while(1) {
 		if(xQueueReceive(LEDQueue, (void*)&delay, 0) == pdTRUE) {
 			
-			char str[25];
-			snprintf(str, sizeof(str) - 1, "LED Blink at - %d ms\r\n", delay);
-			dUART_WriteString(str);
+			dLog_Write(DLOG_LED_BLINK, delay, 0);
 		} else {
 			
 		}
@@ -99,6 +100,15 @@ BaseType_t CreateTasks(void) {
 						1,
 						NULL);
 
+#endif
+
+#if (CURRENT_TASK == BENCHMARK_TASK)
+	xReturn = xTaskCreate(kBench_Task,
+						"Bench",
+						200,
+						NULL,
+						1,
+						NULL);
 #endif
 	return xReturn;
 }
@@ -109,6 +119,7 @@ int main (void)
 	
 	/* Initialize the UART console. */
 	dUART_Initialize();
+	dLog_Initialize();
 	
 	dUART_WriteString("Hello World\r\n");
 
@@ -117,6 +128,13 @@ int main (void)
 	vTaskStartScheduler();
 }
 
+void vApplicationIdleHook(void)
+{
+	/* Format and send deferred log records while there is nothing else to do. */
+	dLog_Flush();
+	kTrace_Flush();
+}
+
 void vApplicationDaemonTaskStartupHook(void)
 {
 }
@@ -17,8 +17,11 @@
 ******************************************************************************/
 #define LEDBLINK_TASK	0
 #define QUEUE_TASK		1
+#define BENCHMARK_TASK	2
 
+#ifndef CURRENT_TASK
 #define CURRENT_TASK	QUEUE_TASK
+#endif
 #define QUEUE_LENGTH	20
 /******************************************************************************
 * Variables
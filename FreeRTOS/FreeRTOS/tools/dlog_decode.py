@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Decode the binary log stream written by dLog with DLOG_BINARY_OUTPUT 1.
+
+Console text passes through unchanged. Frames starting with DLOG_FRAME_SYNC
+(format-ID, then the little-endian int32 arguments) are expanded with the
+format strings of DLOG_MESSAGES in src/SerialConsole/dLog.h.
+
+Usage:
+    dlog_decode.py [capture]          read a capture file, or stdin
+    stty -F /dev/ttyACM0 115200 raw && dlog_decode.py /dev/ttyACM0
+"""
+
+import os
+import re
+import struct
+import sys
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      "..", "src", "SerialConsole", "dLog.h")
+
+
+def load_messages(path):
+    """Return the (argc, format) list of DLOG_MESSAGES, indexed by format-ID."""
+    with open(path) as header:
+        text = header.read()
+    sync = int(re.search(r"#define\s+DLOG_FRAME_SYNC\s+(0x[0-9A-Fa-f]+)", text).group(1), 16)
+    table = text[text.index("#define DLOG_MESSAGES(X)"):]
+    table = table[:table.index("\n\n")]
+    messages = []
+    for argc, fmt in re.findall(r'X\(\s*\w+\s*,\s*(\d+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', table):
+        messages.append((int(argc), fmt.encode().decode("unicode_escape")))
+    return sync, messages
+
+
+def decode(stream, out, sync, messages):
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            return
+        if byte[0] != sync:
+            out.write(byte.decode("ascii", "replace"))
+            continue
+        msg_id = stream.read(1)
+        if not msg_id or msg_id[0] >= len(messages):
+            out.write("<bad frame>\n")
+            continue
+        argc, fmt = messages[msg_id[0]]
+        raw = stream.read(4 * argc)
+        if len(raw) < 4 * argc:
+            return
+        args = struct.unpack("<%di" % argc, raw)
+        out.write(fmt % args)
+        out.flush()
+
+
+def main():
+    sync, messages = load_messages(HEADER)
+    if len(sys.argv) > 1:
+        with open(sys.argv[1], "rb", buffering=0) as stream:
+            decode(stream, sys.stdout, sync, messages)
+    else:
+        decode(sys.stdin.buffer, sys.stdout, sync, messages)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""Compare two captures of the kernel microbenchmarks (src/Benchmark/kBench.c).
+
+Only the "bench,..." lines are read, anything else the console printed is
+ignored. Prints per_op of both runs and the relative change for every
+benchmark found in either capture.
+
+Usage:
+    make -C sim bench > before.csv; <change the kernel>; make -C sim bench > after.csv
+    kbench_compare.py before.csv after.csv
+"""
+
+import sys
+
+
+def load(path):
+    """Return {(primitive, pattern): (per_op, unit)} of a capture."""
+    results = {}
+    with open(path, errors="replace") as capture:
+        for line in capture:
+            fields = line.strip().split(",")
+            if len(fields) == 7 and fields[0] == "bench":
+                results[(fields[1], fields[2])] = (int(fields[5]), fields[6])
+    return results
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    before = load(sys.argv[1])
+    after = load(sys.argv[2])
+    print("%-10s %-10s %12s %12s %8s" % ("primitive", "pattern", "before", "after", "change"))
+    # Order of the first capture, then benchmarks that only the second one has
+    for key in list(before) + [key for key in after if key not in before]:
+        old = before.get(key, (None, ""))
+        new = after.get(key, (None, ""))
+        unit = old[1] or new[1]
+        change = ""
+        if old[0] and new[0] is not None:
+            change = "%+.1f%%" % (100.0 * (new[0] - old[0]) / old[0])
+        print("%-10s %-10s %12s %12s %8s %s" % (key[0], key[1],
+              "-" if old[0] is None else old[0], "-" if new[0] is None else new[0], change, unit))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+"""Convert the kernel trace stream written by kTrace into Chrome trace JSON.
+
+Console text passes through to stderr. Frames starting with KTRACE_FRAME_SYNC
+(an 8 byte record, see src/Benchmark/kTrace.h) become trace events: one track
+per task with a slice for every period it ran, queue and notification events
+as instants on the track of the task (or of "ISR" for the FromISR calls),
+queue depths as counters, and ticks on the "kernel" track. The output loads in
+chrome://tracing and https://ui.perfetto.dev.
+
+A live capture is converted when it ends, or on Ctrl-C.
+
+Usage:
+    ktrace_json.py [capture] > trace.json      read a capture file, or stdin
+    (printf 'trace 7\\r'; sleep 5) | ./build/FreeRTOS_sim | ktrace_json.py > trace.json
+    stty -F /dev/ttyACM0 115200 raw && ktrace_json.py /dev/ttyACM0 > trace.json
+"""
+
+import json
+import os
+import re
+import struct
+import sys
+from collections import defaultdict, deque
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      "..", "src", "Benchmark", "kTrace.h")
+
+RECORD = struct.Struct("<IBBBB")
+PID = 1
+KERNEL_TID = 0      # Ticks and lost records
+ISR_TID = 256       # Events from interrupts, above any 8-bit task number
+
+SEND_EVENTS = ("QUEUE_SEND", "QUEUE_SEND_FROM_ISR")
+RECEIVE_EVENTS = ("QUEUE_RECEIVE", "QUEUE_RECEIVE_FROM_ISR")
+# queueQUEUE_TYPE_* of queue.h, the value of QUEUE_CREATE records
+QUEUE_TYPES = ("queue", "mutex", "counting semaphore", "binary semaphore", "recursive mutex")
+
+
+def load_events(path):
+    """Return the sync byte and the event names of KTRACE_EVENTS, by number."""
+    with open(path) as header:
+        text = header.read()
+    sync = int(re.search(r"#define\s+KTRACE_FRAME_SYNC\s+(0x[0-9A-Fa-f]+)", text).group(1), 16)
+    table = text[text.index("#define KTRACE_EVENTS(X)"):]
+    table = table[:table.index("\n\n")]
+    return sync, re.findall(r"X\(\s*KTRACE_(\w+)\s*\)", table)
+
+
+class Converter:
+    def __init__(self, events):
+        self.events = events
+        self.trace = []
+        self.hz = 1000000
+        self.names = {}
+        self.wrap = 0
+        self.last_time = None
+        self.running = None         # (task, start us, ready latency us)
+        self.ready = {}
+        self.sent = defaultdict(deque)
+        self.queue_types = {}
+
+    def time_us(self, raw):
+        if self.last_time is not None and raw < self.last_time:
+            self.wrap += 1 << 32
+        self.last_time = raw
+        return (self.wrap + raw) * 1e6 / self.hz
+
+    def add(self, **event):
+        event.setdefault("pid", PID)
+        self.trace.append(event)
+
+    def end_slice(self, now):
+        if self.running is None:
+            return
+        task, start, latency = self.running
+        args = {} if latency is None else {"ready_latency_us": round(latency, 3)}
+        self.add(name=self.names.get(task, "task %d" % task), ph="X", tid=task,
+                 ts=start, dur=max(now - start, 0), args=args)
+        self.running = None
+
+    def record(self, raw, event, task, obj, value):
+        if event >= len(self.events):
+            sys.stderr.write("<bad frame>\n")
+            return
+        name = self.events[event]
+
+        # Records that carry data instead of a time
+        if name == "START":
+            self.end_slice(self.last_us() if self.last_time is not None else 0)
+            self.hz = raw
+            self.wrap = 0
+            self.last_time = None
+            self.ready.clear()
+            self.sent.clear()
+            return
+        if name == "TASK_NAME":
+            text = struct.pack("<I", raw).rstrip(b"\0").decode("ascii", "replace")
+            self.names[obj] = (self.names.get(obj, "") if value else "") + text
+            return
+        if name == "LOST":
+            now = self.last_us() if self.last_time is not None else 0
+            self.end_slice(now)
+            self.add(name="lost %d records" % raw, ph="i", s="g", tid=KERNEL_TID, ts=now)
+            self.ready.clear()
+            self.sent.clear()
+            return
+
+        now = self.time_us(raw)
+        if name == "SWITCH_IN":
+            self.end_slice(now)
+            ready = self.ready.pop(task, None)
+            self.running = (task, now, None if ready is None else now - ready)
+        elif name == "READY":
+            self.ready.setdefault(obj, now)
+        elif name == "TICK":
+            self.add(name="tick", ph="i", s="t", tid=KERNEL_TID, ts=now, args={"tick": value})
+        elif name.startswith("QUEUE_"):
+            self.queue_event(name, now, task, obj, value)
+        else:
+            # Task creation, deletion, delays and notifications
+            tid = ISR_TID if name.endswith("FROM_ISR") else task
+            args = {"task": self.names.get(obj, "task %d" % obj)} if obj else {}
+            if name == "TASK_CREATE":
+                args["priority"] = value
+            self.add(name=name.lower(), ph="i", s="t", tid=tid, ts=now, args=args)
+
+    def queue_event(self, name, now, task, queue, waiting):
+        tid = ISR_TID if "FROM_ISR" in name else task
+        args = {"queue": queue, "waiting": waiting}
+        if name == "QUEUE_CREATE":
+            self.queue_types[queue] = QUEUE_TYPES[waiting] if waiting < len(QUEUE_TYPES) else "queue"
+            args = {"queue": queue, "type": self.queue_types[queue]}
+        elif name in SEND_EVENTS:
+            self.sent[queue].append(now)
+            waiting += 1
+        elif name in RECEIVE_EVENTS:
+            if self.sent[queue]:
+                args["latency_us"] = round(now - self.sent[queue].popleft(), 3)
+            waiting = max(waiting - 1, 0)
+        self.add(name=name.lower(), ph="i", s="t", tid=tid, ts=now, args=args)
+        if name in SEND_EVENTS or name in RECEIVE_EVENTS:
+            self.add(name="%s %d" % (self.queue_types.get(queue, "queue"), queue), ph="C", tid=tid, ts=now, args={"waiting": waiting})
+
+    def last_us(self):
+        return (self.wrap + self.last_time) * 1e6 / self.hz
+
+    def finish(self):
+        if self.last_time is not None:
+            self.end_slice(self.last_us())
+        self.add(name="process_name", ph="M", tid=0, args={"name": "FreeRTOS"})
+        self.add(name="thread_name", ph="M", tid=KERNEL_TID, args={"name": "kernel"})
+        self.add(name="thread_name", ph="M", tid=ISR_TID, args={"name": "ISR"})
+        for task, name in self.names.items():
+            self.add(name="thread_name", ph="M", tid=task, args={"name": "%s (%d)" % (name, task)})
+        return {"traceEvents": self.trace, "displayTimeUnit": "ns"}
+
+
+def convert(stream, converter, sync):
+    try:
+        while True:
+            byte = stream.read(1)
+            if not byte:
+                return
+            if byte[0] != sync:
+                sys.stderr.write(byte.decode("ascii", "replace"))
+                continue
+            raw = stream.read(RECORD.size)
+            while 0 < len(raw) < RECORD.size:
+                more = stream.read(RECORD.size - len(raw))
+                if not more:
+                    break
+                raw += more
+            if len(raw) < RECORD.size:
+                return
+            converter.record(*RECORD.unpack(raw))
+    except KeyboardInterrupt:
+        pass
+
+
+def main():
+    sync, events = load_events(HEADER)
+    converter = Converter(events)
+    if len(sys.argv) > 1:
+        with open(sys.argv[1], "rb", buffering=0) as stream:
+            convert(stream, converter, sync)
+    else:
+        convert(sys.stdin.buffer, converter, sync)
+    json.dump(converter.finish(), sys.stdout)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()